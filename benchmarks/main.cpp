@@ -5,12 +5,19 @@
 #include <chrono>
 
 #include "rl_types.h"
+#include "rl_util.h"
 #include "rl_dawg.h"
+#include "rl_dawgeditor.h"
 #include "rl_bag.h"
 #include "rl_rack.h"
 #include "rl_board.h"
 #include "rl_move.h"
 #include "rl_search.h"
+#include "rl_pattern.h"
+#include "rl_anagram.h"
+#include "rl_node.h"
+#include "rl_nodearray.h"
+#include "rl_edgemap.h"
 
 struct TimeSample {
 	std::chrono::high_resolution_clock::time_point start_;
@@ -40,6 +47,247 @@ int32 num_searches_to_play = 10;
 
 bool print_board = false;
 
+bool load_mapped = false;
+int32 num_build_threads = 0;
+const char* save_dawg_path = nullptr;
+bool unsorted = false;
+const char* patch_path = nullptr;
+int32 sort_budget_mb = 0;
+bool gaddag = false;
+bool microbench_lookup = false;
+bool microbench_word_ids = false;
+bool microbench_batch = false;
+bool microbench_anagrams = false;
+bool microbench_racks = false;
+bool parallel_search = false;
+bool cached_search = false;
+int32 topk = 0;
+bool best_score = false;
+const char* reorder_mode = nullptr;
+bool pack = false;
+const char* pattern_string = nullptr;
+const char* pattern_rack_letters = nullptr;
+
+// Number of distinct words sampled from the DAWG for --microbench-lookup, and the number of times each is looked up
+static const int32 LOOKUP_NUM_WORDS = 100000;
+static const int32 LOOKUP_NUM_ROUNDS = 20;
+
+// Number of random words sampled for --microbench-word-ids
+static const int32 WORD_ID_NUM_SAMPLES = 1000000;
+
+// Number of times each --pattern query is repeated
+static const int32 PATTERN_NUM_ROUNDS = 10;
+
+// Thread counts compared by --parallel-search, and the number of times each search is repeated
+static const int32 PARALLEL_THREAD_COUNTS[] = { 1, 2, 4, 8, 16 };
+static const int32 PARALLEL_NUM_ROUNDS = 5;
+
+// Number of moves played by --cached-search, each followed by a cached and an uncached search with the same rack
+static const int32 CACHED_NUM_MOVES = 10;
+
+// Rack sizes compared by --microbench-anagrams, the number of racks of each size, and the number of words whose exact
+// anagrams are looked up
+static const int32 ANAGRAM_RACK_SIZES[] = { 7, 15, 50 };
+static const int32 ANAGRAM_NUM_RACKS = 20;
+static const int32 ANAGRAM_NUM_LOOKUPS = 100000;
+
+// Rack sizes compared by --microbench-racks, and the number of racks of each size searched on the final board
+static const int32 SEARCH_RACK_SIZES[] = { 7, 50 };
+static const int32 SEARCH_RACK_NUM_RACKS = 10;
+
+static void record_node_visits(const rl_dawg& dawg, uint32* node_visits)
+{
+	// Play a short sample game on a board of its own, with its own tiles, counting how often each DAWG node is expanded
+	rl_bag bag;
+	rl_bag_init(bag);
+	rl_rack rack;
+	rl_rack_init(rack);
+	for (int32 i = 0; i < num_tiles_to_draw; i++)
+	{
+		rl_rack_push(rack, rl_bag_draw(bag));
+	}
+
+	rl_board board;
+	rl_board_init(board, board_size_x, board_size_y);
+	rl_board_write(dawg, board, rl_board_index(board, first_move_x, first_move_y), true, reinterpret_cast<const uint8*>(first_move_word), static_cast<int32>(strlen(first_move_word)));
+
+	rl_search_stats stats;
+	rl_search_stats_init(stats);
+	stats.node_visits = node_visits;
+	rl_move move;
+	for (int32 i = 0; i < num_searches_to_play; i++)
+	{
+		if (rl_search_board(dawg, board, rack, move, &stats) == 0)
+		{
+			break;
+		}
+		rl_board_write(dawg, board, move.index, move.offset == 1, move.word, move.word_len);
+		rl_rack_subtract(rack, move.letters_used);
+		for (int32 j = 0; j < move.word_len; j++)
+		{
+			rl_rack_push(rack, rl_bag_draw(bag));
+		}
+	}
+	rl_board_free(board);
+}
+
+static void collect_words(const rl_dawg& dawg, int32 node_index, uint8* prefix, int32 prefix_len, uint8* out_words, int32* out_lens, int32& num_words)
+{
+	// Depth-first walk of the DAWG, recording every word reached until we have enough of them
+	const rl_edge* edges_end = rl_dawg_edges_end(dawg, node_index);
+	for (const rl_edge* edge = rl_dawg_edges_begin(dawg, node_index); edge != edges_end && num_words < LOOKUP_NUM_WORDS; edge++)
+	{
+		prefix[prefix_len] = rl_edge_letter(*edge);
+		if (rl_edge_is_word(*edge))
+		{
+			memcpy(out_words + num_words * RL_MAX_WORD_LEN, prefix, prefix_len + 1);
+			out_lens[num_words] = prefix_len + 1;
+			num_words++;
+		}
+		collect_words(dawg, rl_edge_node_index(*edge), prefix, prefix_len + 1, out_words, out_lens, num_words);
+	}
+}
+
+static int32 sample_lookup_queries(const rl_dawg& dawg, uint8*& words, int32*& lens, int32*& order)
+{
+	// Sample words from the DAWG, then derive a near-miss from each by changing its last letter
+	words = reinterpret_cast<uint8*>(malloc(2 * LOOKUP_NUM_WORDS * RL_MAX_WORD_LEN));
+	lens = reinterpret_cast<int32*>(malloc(2 * LOOKUP_NUM_WORDS * sizeof(int32)));
+	uint8 prefix[RL_MAX_WORD_LEN];
+	int32 num_sampled = 0;
+	collect_words(dawg, 0, prefix, 0, words, lens, num_sampled);
+	for (int32 i = 0; i < num_sampled; i++)
+	{
+		uint8* miss = words + (num_sampled + i) * RL_MAX_WORD_LEN;
+		memcpy(miss, words + i * RL_MAX_WORD_LEN, lens[i]);
+		miss[lens[i] - 1] = 'a' + (miss[lens[i] - 1] - 'a' + 7) % 26;
+		lens[num_sampled + i] = lens[i];
+	}
+	const int32 num_queries = num_sampled * 2;
+
+	// Shuffle the queries so that consecutive lookups don't share a path through the DAWG
+	order = reinterpret_cast<int32*>(malloc(num_queries * sizeof(int32)));
+	for (int32 i = 0; i < num_queries; i++)
+	{
+		order[i] = i;
+	}
+	for (int32 i = num_queries - 1; i > 0; i--)
+	{
+		const int32 j = rand() % (i + 1);
+		const int32 temp = order[i];
+		order[i] = order[j];
+		order[j] = temp;
+	}
+	return num_queries;
+}
+
+static bool count_pattern_match(const uint8*, int32, void*)
+{
+	// rl_pattern_match already counts the words it reports, so there's nothing more to do with them
+	return true;
+}
+
+static int32 count_subanagrams_dawg(const rl_dawg& dawg, int32 node_index, rl_rack& rack)
+{
+	// Find every word that can be formed from the rack without an index, by walking the DAWG and taking a letter from
+	// the rack for each edge
+	int32 num_words = 0;
+	const uint32 node_mask = rl_dawg_node_mask(dawg, node_index);
+	uint32 remaining = node_mask;
+	while (remaining != 0)
+	{
+		const uint32 ordinal = static_cast<uint32>(rl_ctz(remaining));
+		remaining &= remaining - 1;
+		const rl_edge edge = rl_dawg_node_edge(dawg, node_index, node_mask, ordinal);
+		const uint8 letter = rl_edge_letter(edge);
+		if (rl_rack_pop(rack, letter))
+		{
+			num_words += rl_edge_is_word(edge) ? 1 : 0;
+			num_words += count_subanagrams_dawg(dawg, rl_edge_node_index(edge), rack);
+			rl_rack_push(rack, letter);
+		}
+	}
+	return num_words;
+}
+
+static bool count_anagram(int32, int32, void*)
+{
+	// The queries already count the words they report, so there's nothing more to do with them
+	return true;
+}
+
+// Best score among every legal move visited by score_move, as a baseline for rl_search_board_best_score
+struct ScoreSample {
+	const rl_board* board;
+	int32 best_score;
+};
+
+static bool score_move(const rl_move_candidate& candidate, void* user_data)
+{
+	ScoreSample& sample = *reinterpret_cast<ScoreSample*>(user_data);
+	sample.best_score = MAX(sample.best_score, rl_board_score_move(*sample.board, candidate.index, candidate.offset, candidate.word, candidate.word_len));
+	return true;
+}
+
+static bool lookup_edgemap(const rl_nodearray& nodearray, const uint8* word, int32 word_len)
+{
+	// Binary search over each node's rl_edgemap_items, as when the DAWG is still being built or edited
+	int32 node_index = 0;
+	for (int32 i = 0; i < word_len; i++)
+	{
+		node_index = rl_edgemap_find(nodearray.items[node_index].next_by_letter, word[i]);
+		if (node_index < 0)
+		{
+			return false;
+		}
+	}
+	return nodearray.items[node_index].is_word;
+}
+
+static bool lookup_scan(const rl_dawg& dawg, const uint8* word, int32 word_len)
+{
+	// Linear scan over each node's sorted edges in the frozen DAWG, stopping at the first letter that's not smaller
+	rl_edge found = RL_EDGE_NONE;
+	int32 node_index = 0;
+	for (int32 i = 0; i < word_len; i++)
+	{
+		const uint32 ordinal = static_cast<uint32>(word[i] - 'a');
+		const rl_edge* edges_end = rl_dawg_edges_end(dawg, node_index);
+		found = RL_EDGE_NONE;
+		for (const rl_edge* edge = rl_dawg_edges_begin(dawg, node_index); edge != edges_end; edge++)
+		{
+			if ((*edge & RL_EDGE_LETTER_MASK) >= ordinal)
+			{
+				found = (*edge & RL_EDGE_LETTER_MASK) == ordinal ? *edge : RL_EDGE_NONE;
+				break;
+			}
+		}
+		if (found == RL_EDGE_NONE)
+		{
+			return false;
+		}
+		node_index = rl_edge_node_index(found);
+	}
+	return rl_edge_is_word(found);
+}
+
+static bool lookup_mask(const rl_dawg& dawg, const uint8* word, int32 word_len)
+{
+	// Child mask test plus popcount rank in the frozen (or packed) DAWG
+	rl_edge found = RL_EDGE_NONE;
+	int32 node_index = 0;
+	for (int32 i = 0; i < word_len; i++)
+	{
+		found = rl_dawg_find_edge(dawg, node_index, word[i]);
+		if (found == RL_EDGE_NONE)
+		{
+			return false;
+		}
+		node_index = rl_edge_node_index(found);
+	}
+	return rl_edge_is_word(found);
+}
+
 int main(int argc, char* argv[])
 {
 	if (argc < 2)
@@ -91,6 +339,86 @@ int main(int argc, char* argv[])
 		{
 			print_board = true;
 		}
+		else if (strstr(argv[i], "--load-mapped"))
+		{
+			load_mapped = true;
+		}
+		else if (strstr(argv[i], "--build-threads="))
+		{
+			num_build_threads = atoi(argv[i]+16);
+		}
+		else if (strstr(argv[i], "--save-dawg="))
+		{
+			save_dawg_path = argv[i]+12;
+		}
+		else if (strstr(argv[i], "--patch="))
+		{
+			patch_path = argv[i]+8;
+		}
+		else if (strstr(argv[i], "--unsorted"))
+		{
+			unsorted = true;
+		}
+		else if (strstr(argv[i], "--sort-budget-mb="))
+		{
+			sort_budget_mb = atoi(argv[i]+17);
+		}
+		else if (strstr(argv[i], "--gaddag"))
+		{
+			gaddag = true;
+		}
+		else if (strstr(argv[i], "--microbench-lookup"))
+		{
+			microbench_lookup = true;
+		}
+		else if (strstr(argv[i], "--microbench-word-ids"))
+		{
+			microbench_word_ids = true;
+		}
+		else if (strstr(argv[i], "--microbench-batch"))
+		{
+			microbench_batch = true;
+		}
+		else if (strstr(argv[i], "--microbench-anagrams"))
+		{
+			microbench_anagrams = true;
+		}
+		else if (strstr(argv[i], "--microbench-racks"))
+		{
+			microbench_racks = true;
+		}
+		else if (strstr(argv[i], "--parallel-search"))
+		{
+			parallel_search = true;
+		}
+		else if (strstr(argv[i], "--cached-search"))
+		{
+			cached_search = true;
+		}
+		else if (strstr(argv[i], "--topk="))
+		{
+			topk = atoi(argv[i]+7);
+		}
+		else if (strstr(argv[i], "--best-score"))
+		{
+			best_score = true;
+		}
+		else if (strstr(argv[i], "--reorder="))
+		{
+			reorder_mode = argv[i]+10;
+		}
+		else if (strstr(argv[i], "--pack"))
+		{
+			pack = true;
+		}
+		else if (strstr(argv[i], "--pattern-rack="))
+		{
+			pattern_rack_letters = argv[i]+15;
+		}
+		else if (strstr(argv[i], "--pattern="))
+		{
+			pattern_string = argv[i]+10;
+		}
 	}
 	printf("seed: %d\n", seed);
 	printf("board-size-x: %d\n", board_size_x);
@@ -101,6 +429,13 @@ int main(int argc, char* argv[])
 	printf("first-move-x: %d\n", first_move_x);
 	printf("first-move-y: %d\n", first_move_y);
 	printf("first-move-word: %s\n", first_move_word);
+	printf("load-mapped: %d\n", load_mapped ? 1 : 0);
+	printf("build-threads: %d\n", num_build_threads);
+	printf("unsorted: %d\n", unsorted ? 1 : 0);
+	printf("sort-budget-mb: %d\n", sort_budget_mb);
+	printf("gaddag: %d\n", gaddag ? 1 : 0);
+	printf("reorder: %s\n", reorder_mode ? reorder_mode : "none");
+	printf("pack: %d\n", pack ? 1 : 0);
 
 	TimeSample ts;
 	srand(seed);
@@ -108,11 +443,446 @@ int main(int argc, char* argv[])
 	ts.start();
 	rl_dawg dawg;
 	memset(&dawg, 0, sizeof(dawg));
-	const int32 num_words = rl_dawg_build(dawg, wordlist_path);
+	int32 num_words = 0;
+	if (load_mapped)
+	{
+		num_words = rl_dawg_load_mapped(dawg, wordlist_path);
+	}
+	else if (gaddag)
+	{
+		num_words = rl_dawg_build_gaddag(dawg, wordlist_path);
+	}
+	else if (num_build_threads > 0)
+	{
+		num_words = rl_dawg_build_parallel(dawg, wordlist_path, num_build_threads);
+	}
+	else if (unsorted)
+	{
+		const size_t sort_budget = static_cast<size_t>(sort_budget_mb) << 20;
+		if (strcmp(wordlist_path, "-") == 0)
+		{
+			num_words = rl_dawg_build_unsorted_fd(dawg, 0, sort_budget);
+		}
+		else
+		{
+			num_words = rl_dawg_build_unsorted(dawg, wordlist_path, sort_budget);
+		}
+	}
+	else if (strcmp(wordlist_path, "-") == 0)
+	{
+		num_words = rl_dawg_build_fd(dawg, 0);
+	}
+	else
+	{
+		num_words = rl_dawg_build(dawg, wordlist_path);
+	}
 	const long long elapsed_load = ts.stop();
 	printf("num-words: %d\n", num_words);
+	printf("num-nodes: %d\n", dawg.num_nodes);
+	printf("num-bytes: %zu\n", rl_dawg_num_bytes(dawg));
+	printf("bytes-per-word: %.2f\n", static_cast<double>(rl_dawg_num_bytes(dawg)) / MAX(num_words, 1));
 	printf("elapsed(load): %lld ns\n", elapsed_load);
 
+	// Optionally apply a patch to the DAWG: each line of the patch file is a word prefixed with '+' to add it or '-' to
+	// remove it
+	if (patch_path)
+	{
+		FILE* fp = fopen(patch_path, "r");
+		if (!fp)
+		{
+			fprintf(stderr, "ERROR: Could not open patch file '%s'.\n", patch_path);
+			return 1;
+		}
+
+		ts.start();
+		rl_dawgeditor editor;
+		rl_dawgeditor_init(editor, dawg);
+		const long long elapsed_patch_init = ts.stop();
+
+		ts.start();
+		int32 num_added = 0;
+		int32 num_removed = 0;
+		char line[512];
+		while (fgets(line, sizeof(line), fp))
+		{
+			int32 line_len = static_cast<int32>(strcspn(line, "\r\n"));
+			const uint8* word = reinterpret_cast<const uint8*>(line + 1);
+			if (line[0] == '+' && rl_dawgeditor_add(editor, word, line_len - 1))
+			{
+				num_added++;
+			}
+			else if (line[0] == '-' && rl_dawgeditor_remove(editor, word, line_len - 1))
+			{
+				num_removed++;
+			}
+		}
+		fclose(fp);
+		const long long elapsed_patch_edits = ts.stop();
+
+		ts.start();
+		num_words = rl_dawgeditor_commit(editor, dawg);
+		rl_dawgeditor_free(editor);
+		const long long elapsed_patch_commit = ts.stop();
+
+		printf("num-words-added: %d\n", num_added);
+		printf("num-words-removed: %d\n", num_removed);
+		printf("num-words-patched: %d\n", num_words);
+		printf("num-nodes-patched: %d\n", dawg.num_nodes);
+		printf("elapsed(patch-init): %lld ns\n", elapsed_patch_init);
+		printf("elapsed(patch-edits): %lld ns\n", elapsed_patch_edits);
+		printf("elapsed(patch-commit): %lld ns\n", elapsed_patch_commit);
+	}
+
+	// Optionally renumber the DAWG's nodes for locality: either breadth-first, or by how often each node was visited
+	// while profiling a sample game, played with a different seed than the game we're about to time
+	if (reorder_mode)
+	{
+		uint32* node_visits = nullptr;
+		ts.start();
+		if (strcmp(reorder_mode, "visits") == 0)
+		{
+			node_visits = reinterpret_cast<uint32*>(calloc(dawg.num_nodes, sizeof(uint32)));
+			srand(seed + 1);
+			record_node_visits(dawg, node_visits);
+			srand(seed);
+		}
+		else if (strcmp(reorder_mode, "bfs") != 0)
+		{
+			fprintf(stderr, "ERROR: Unknown reorder mode '%s'; expected 'bfs' or 'visits'.\n", reorder_mode);
+			return 1;
+		}
+		rl_dawg_reorder(dawg, node_visits);
+		const long long elapsed_reorder = ts.stop();
+		free(node_visits);
+		printf("elapsed(reorder): %lld ns\n", elapsed_reorder);
+	}
+
+	// Optionally write the DAWG back out as a binary image, for use with --load-mapped
+	if (save_dawg_path && !rl_dawg_save(dawg, save_dawg_path))
+	{
+		fprintf(stderr, "ERROR: Failed to save DAWG to '%s'.\n", save_dawg_path);
+		return 1;
+	}
+
+	// Optionally compare the cost of looking up words letter-by-letter through each representation of the DAWG's edges
+	if (microbench_lookup && !dawg.is_gaddag)
+	{
+		uint8* words;
+		int32* lens;
+		int32* order;
+		const int32 num_queries = sample_lookup_queries(dawg, words, lens, order);
+
+		// The editor holds a copy of the DAWG as an rl_nodearray, with a sorted rl_edgemap per node
+		rl_dawgeditor editor;
+		rl_dawgeditor_init(editor, dawg);
+		rl_dawg packed;
+		rl_dawg_init(packed);
+		rl_dawg_pack(dawg, packed);
+
+		int32 num_found[4] = { 0, 0, 0, 0 };
+		long long elapsed_lookup[4];
+		for (int32 method = 0; method < 4; method++)
+		{
+			ts.start();
+			for (int32 round = 0; round < LOOKUP_NUM_ROUNDS; round++)
+			{
+				for (int32 i = 0; i < num_queries; i++)
+				{
+					const int32 query = order[i];
+					const uint8* word = words + query * RL_MAX_WORD_LEN;
+					bool found;
+					if (method == 0)
+					{
+						found = lookup_edgemap(editor.nodearray, word, lens[query]);
+					}
+					else if (method == 1)
+					{
+						found = lookup_scan(dawg, word, lens[query]);
+					}
+					else
+					{
+						found = lookup_mask(method == 2 ? dawg : packed, word, lens[query]);
+					}
+					num_found[method] += found ? 1 : 0;
+				}
+			}
+			elapsed_lookup[method] = ts.stop();
+		}
+		rl_dawg_free(packed);
+		rl_dawgeditor_free(editor);
+		free(order);
+		free(lens);
+		free(words);
+
+		printf("num-lookups: %d\n", num_queries * LOOKUP_NUM_ROUNDS);
+		printf("num-lookups-found: %d %d %d %d\n", num_found[0], num_found[1], num_found[2], num_found[3]);
+		printf("elapsed(lookup-edgemap): %lld ns\n", elapsed_lookup[0]);
+		printf("elapsed(lookup-scan): %lld ns\n", elapsed_lookup[1]);
+		printf("elapsed(lookup-mask): %lld ns\n", elapsed_lookup[2]);
+		printf("elapsed(lookup-packed): %lld ns\n", elapsed_lookup[3]);
+	}
+
+	// Optionally compare the throughput of looking up a shuffled mix of words and near-misses one at a time against
+	// looking them all up in a single batch
+	if (microbench_batch && !dawg.is_gaddag)
+	{
+		uint8* words;
+		int32* lens;
+		int32* order;
+		const int32 num_queries = sample_lookup_queries(dawg, words, lens, order);
+		const uint8** query_words = reinterpret_cast<const uint8**>(malloc(num_queries * sizeof(const uint8*)));
+		int32* query_lens = reinterpret_cast<int32*>(malloc(num_queries * sizeof(int32)));
+		uint8* found_bits = reinterpret_cast<uint8*>(malloc((num_queries + 7) / 8));
+		for (int32 i = 0; i < num_queries; i++)
+		{
+			query_words[i] = words + order[i] * RL_MAX_WORD_LEN;
+			query_lens[i] = lens[order[i]];
+		}
+
+		int32 num_found_single = 0;
+		ts.start();
+		for (int32 round = 0; round < LOOKUP_NUM_ROUNDS; round++)
+		{
+			for (int32 i = 0; i < num_queries; i++)
+			{
+				num_found_single += rl_dawg_contains(dawg, query_words[i], query_lens[i]) ? 1 : 0;
+			}
+		}
+		const long long elapsed_single = ts.stop();
+
+		int32 num_found_batch = 0;
+		ts.start();
+		for (int32 round = 0; round < LOOKUP_NUM_ROUNDS; round++)
+		{
+			rl_dawg_contains_batch(dawg, query_words, query_lens, num_queries, found_bits);
+			for (int32 i = 0; i < (num_queries + 7) / 8; i++)
+			{
+				num_found_batch += rl_popcount(found_bits[i]);
+			}
+		}
+		const long long elapsed_batch = ts.stop();
+		free(found_bits);
+		free(query_lens);
+		free(query_words);
+		free(order);
+		free(lens);
+		free(words);
+
+		const double num_lookups = static_cast<double>(num_queries) * LOOKUP_NUM_ROUNDS;
+		printf("num-batch-lookups: %d\n", num_queries * LOOKUP_NUM_ROUNDS);
+		printf("num-batch-lookups-found: %d %d\n", num_found_single, num_found_batch);
+		printf("elapsed(contains-single): %lld ns\n", elapsed_single);
+		printf("elapsed(contains-batch): %lld ns\n", elapsed_batch);
+		printf("qps(contains-single): %.0f\n", num_lookups * 1e9 / MAX(elapsed_single, 1LL));
+		printf("qps(contains-batch): %.0f\n", num_lookups * 1e9 / MAX(elapsed_batch, 1LL));
+	}
+
+	// Optionally time sampling words uniformly at random by ID, and mapping those words back to their IDs
+	if (microbench_word_ids && !dawg.is_gaddag && dawg.num_words > 0)
+	{
+		// Use a local generator, so that the flag doesn't change the tiles drawn later on
+		int32* sampled_ids = reinterpret_cast<int32*>(malloc(WORD_ID_NUM_SAMPLES * sizeof(int32)));
+		uint8* sampled_words = reinterpret_cast<uint8*>(malloc(WORD_ID_NUM_SAMPLES * RL_MAX_WORD_LEN));
+		int32* sampled_lens = reinterpret_cast<int32*>(malloc(WORD_ID_NUM_SAMPLES * sizeof(int32)));
+		uint32 state = seed;
+		ts.start();
+		for (int32 i = 0; i < WORD_ID_NUM_SAMPLES; i++)
+		{
+			state = state * 1664525u + 1013904223u;
+			sampled_lens[i] = rl_dawg_random_word(dawg, state, sampled_words + i * RL_MAX_WORD_LEN);
+		}
+		const long long elapsed_word_at = ts.stop();
+
+		ts.start();
+		for (int32 i = 0; i < WORD_ID_NUM_SAMPLES; i++)
+		{
+			sampled_ids[i] = rl_dawg_word_id(dawg, sampled_words + i * RL_MAX_WORD_LEN, sampled_lens[i]);
+		}
+		const long long elapsed_word_id = ts.stop();
+
+		// Every ID should be valid, and sampling the same random values again should yield the same IDs
+		int32 num_mismatches = 0;
+		state = seed;
+		for (int32 i = 0; i < WORD_ID_NUM_SAMPLES; i++)
+		{
+			state = state * 1664525u + 1013904223u;
+			const int32 expected_id = static_cast<int32>((static_cast<uint64>(state) * static_cast<uint64>(dawg.num_words)) >> 32);
+			num_mismatches += sampled_ids[i] == expected_id ? 0 : 1;
+		}
+		free(sampled_lens);
+		free(sampled_words);
+		free(sampled_ids);
+
+		printf("num-word-id-samples: %d\n", WORD_ID_NUM_SAMPLES);
+		printf("num-word-id-mismatches: %d\n", num_mismatches);
+		printf("elapsed(random-word): %lld ns\n", elapsed_word_at);
+		printf("elapsed(word-id): %lld ns\n", elapsed_word_id);
+	}
+
+	// Optionally build an anagram index, and compare finding every word that can be formed from a rack by walking the
+	// DAWG against looking it up in the index, for racks of several sizes
+	if (microbench_anagrams && !dawg.is_gaddag && dawg.num_words > 0)
+	{
+		rl_anagram_index anagram_index;
+		rl_anagram_init(anagram_index);
+		ts.start();
+		rl_anagram_build(anagram_index, dawg);
+		const long long elapsed_anagram_build = ts.stop();
+		printf("num-anagram-signatures: %d\n", anagram_index.num_signatures);
+		printf("num-anagram-nodes: %d\n", anagram_index.num_nodes);
+		printf("num-anagram-bytes: %zu\n", rl_anagram_num_bytes(anagram_index));
+		printf("elapsed(anagram-build): %lld ns\n", elapsed_anagram_build);
+
+		// Draw the racks from a bag of their own, then restore the seed so that the tiles drawn later are unchanged
+		srand(seed + 2);
+		rl_bag anagram_bag;
+		rl_bag_init(anagram_bag);
+		for (int32 size_index = 0; size_index < COUNT_OF(ANAGRAM_RACK_SIZES); size_index++)
+		{
+			const int32 rack_size = ANAGRAM_RACK_SIZES[size_index];
+			rl_rack racks[ANAGRAM_NUM_RACKS];
+			for (int32 rack_index = 0; rack_index < ANAGRAM_NUM_RACKS; rack_index++)
+			{
+				rl_rack_init(racks[rack_index]);
+				for (int32 i = 0; i < rack_size; i++)
+				{
+					rl_rack_push(racks[rack_index], rl_bag_draw(anagram_bag));
+				}
+			}
+
+			int32 num_found_dawg = 0;
+			ts.start();
+			for (int32 rack_index = 0; rack_index < ANAGRAM_NUM_RACKS; rack_index++)
+			{
+				num_found_dawg += count_subanagrams_dawg(dawg, 0, racks[rack_index]);
+			}
+			const long long elapsed_dawg = ts.stop();
+
+			int32 num_found_index = 0;
+			ts.start();
+			for (int32 rack_index = 0; rack_index < ANAGRAM_NUM_RACKS; rack_index++)
+			{
+				num_found_index += rl_anagram_find_sub(anagram_index, racks[rack_index], count_anagram, nullptr);
+			}
+			const long long elapsed_index = ts.stop();
+
+			printf("num-subanagrams(%d): %d %d\n", rack_size, num_found_dawg, num_found_index);
+			printf("elapsed(subanagrams-dawg,%d): %lld ns\n", rack_size, elapsed_dawg / ANAGRAM_NUM_RACKS);
+			printf("elapsed(subanagrams-index,%d): %lld ns\n", rack_size, elapsed_index / ANAGRAM_NUM_RACKS);
+		}
+		srand(seed);
+
+		// Look up the exact anagrams of words sampled at random from the DAWG
+		uint8* sampled_words = reinterpret_cast<uint8*>(malloc(ANAGRAM_NUM_LOOKUPS * RL_MAX_WORD_LEN));
+		int32* sampled_lens = reinterpret_cast<int32*>(malloc(ANAGRAM_NUM_LOOKUPS * sizeof(int32)));
+		uint32 state = seed;
+		for (int32 i = 0; i < ANAGRAM_NUM_LOOKUPS; i++)
+		{
+			state = state * 1664525u + 1013904223u;
+			sampled_lens[i] = rl_dawg_random_word(dawg, state, sampled_words + i * RL_MAX_WORD_LEN);
+		}
+		int32 num_anagrams = 0;
+		ts.start();
+		for (int32 i = 0; i < ANAGRAM_NUM_LOOKUPS; i++)
+		{
+			num_anagrams += rl_anagram_find(anagram_index, sampled_words + i * RL_MAX_WORD_LEN, sampled_lens[i], count_anagram, nullptr);
+		}
+		const long long elapsed_lookups = ts.stop();
+		free(sampled_lens);
+		free(sampled_words);
+		printf("num-anagram-lookups: %d\n", ANAGRAM_NUM_LOOKUPS);
+		printf("num-anagrams-found: %d\n", num_anagrams);
+		printf("elapsed(anagram-lookups): %lld ns\n", elapsed_lookups);
+		rl_anagram_free(anagram_index);
+	}
+
+	// Optionally swap in a packed copy of the DAWG for the searches that follow
+	if (pack)
+	{
+		rl_dawg packed;
+		rl_dawg_init(packed);
+		ts.start();
+		rl_dawg_pack(dawg, packed);
+		const long long elapsed_pack = ts.stop();
+		rl_dawg_free(dawg);
+		dawg = packed;
+		printf("num-bytes-packed: %zu\n", rl_dawg_num_bytes(dawg));
+		printf("bytes-per-word-packed: %.2f\n", static_cast<double>(rl_dawg_num_bytes(dawg)) / MAX(dawg.num_words, 1));
+		printf("elapsed(pack): %lld ns\n", elapsed_pack);
+	}
+
+	// Optionally query the DAWG for every word matching a wildcard pattern (and playable from a rack, if given), and
+	// compare against testing every word in the raw word list
+	if (pattern_string)
+	{
+		rl_pattern pattern;
+		if (!rl_pattern_compile(pattern, pattern_string))
+		{
+			printf("invalid pattern: %s\n", pattern_string);
+			return 1;
+		}
+		rl_rack pattern_rack;
+		rl_rack_init(pattern_rack);
+		for (const char* c = pattern_rack_letters; c && *c; c++)
+		{
+			rl_rack_push(pattern_rack, static_cast<uint8>(*c));
+		}
+		const rl_rack* rack_constraint = pattern_rack_letters ? &pattern_rack : nullptr;
+
+		int32 num_matches = 0;
+		rl_search_stats pattern_stats;
+		rl_search_stats_init(pattern_stats);
+		ts.start();
+		for (int32 round = 0; round < PATTERN_NUM_ROUNDS; round++)
+		{
+			num_matches = rl_pattern_match(dawg, pattern, rack_constraint, count_pattern_match, nullptr, &pattern_stats);
+		}
+		const long long elapsed_pattern = ts.stop();
+		printf("num-pattern-matches: %d\n", num_matches);
+		printf("elapsed(pattern): %lld ns\n", elapsed_pattern / PATTERN_NUM_ROUNDS);
+		printf("nodes-visited(pattern): %.1f per query\n", static_cast<double>(pattern_stats.num_nodes_visited) / PATTERN_NUM_ROUNDS);
+		printf("nodes-pruned(pattern): %.1f per query\n", static_cast<double>(pattern_stats.num_nodes_pruned) / PATTERN_NUM_ROUNDS);
+
+		// Scanning the word list doesn't apply the rack, so it's only a fair comparison without one
+		FILE* fp = !load_mapped && !rack_constraint && strcmp(wordlist_path, "-") != 0 ? fopen(wordlist_path, "rb") : nullptr;
+		if (fp)
+		{
+			fseek(fp, 0, SEEK_END);
+			const long text_size = ftell(fp);
+			fseek(fp, 0, SEEK_SET);
+			char* text = reinterpret_cast<char*>(malloc(text_size + 1));
+			const size_t text_len = fread(text, 1, text_size, fp);
+			text[text_len] = '\0';
+			fclose(fp);
+
+			int32 num_scan_matches = 0;
+			ts.start();
+			for (int32 round = 0; round < PATTERN_NUM_ROUNDS; round++)
+			{
+				num_scan_matches = 0;
+				const char* word = text;
+				while (*word != '\0')
+				{
+					const char* end = word;
+					while (*end != '\0' && *end != '\n' && *end != '\r')
+					{
+						end++;
+					}
+					const int32 word_len = static_cast<int32>(end - word);
+					if (word_len > 0 && rl_pattern_test(pattern, reinterpret_cast<const uint8*>(word), word_len))
+					{
+						num_scan_matches++;
+					}
+					word = *end != '\0' ? end + 1 : end;
+				}
+			}
+			const long long elapsed_scan = ts.stop();
+			free(text);
+			printf("num-pattern-scan-matches: %d\n", num_scan_matches);
+			printf("elapsed(pattern-scan): %lld ns\n", elapsed_scan / PATTERN_NUM_ROUNDS);
+		}
+	}
+
 	// Draw the desired number of tiles, using the default letter distribution
 	rl_bag bag;
 	rl_bag_init(bag);
@@ -124,9 +894,13 @@ int main(int argc, char* argv[])
 		rl_rack_push(rack, rl_bag_draw(bag));
 	}
 
-	// Prepare a board with the desired dimensions
+	// Prepare a board with the desired dimensions, with premium squares if we're going to be scoring moves
 	rl_board board;
 	rl_board_init(board, board_size_x, board_size_y);
+	if (best_score)
+	{
+		rl_board_set_standard_premiums(board);
+	}
 
 	// Hardcode an initial move to populate the board
 	rl_move move;
@@ -142,8 +916,11 @@ int main(int argc, char* argv[])
 
 	// Play the desired number of moves, zigzagging across the board and searching in
 	// arbitrary segments to chain the moves together
+	rl_search_stats move_stats;
+	rl_search_stats_init(move_stats);
 	ts.start();
 	int32 num_moves_played = 0;
+	int32 num_segment_searches = 0;
 	while (true)
 	{
 		// Play the current move
@@ -171,7 +948,8 @@ int main(int argc, char* argv[])
 		const int32 retreat_to_start_of_next_move = rl_board_offset(board, across) * prefix_len;
 		const int32 next_move_start_index = index_of_intersect_with_prev_move - retreat_to_start_of_next_move;
 		const int32 next_move_length = (rand() % 3) + 5;
-		const int32 num_moves_found = rl_search_segment(dawg, board, rack, next_move_start_index, nullptr, next_move_length, across, move);
+		num_segment_searches++;
+		const int32 num_moves_found = rl_search_segment(dawg, board, rack, next_move_start_index, nullptr, next_move_length, across, move, &move_stats);
 		printf("move(%d)found: %d\n", num_moves_played, num_moves_found);
 		if (num_moves_found == 0)
 		{
@@ -184,11 +962,15 @@ int main(int argc, char* argv[])
 	printf("elapsed(moves): %lld ns\n", elapsed_moves);
 
 	//
+	rl_search_stats search_stats;
+	rl_search_stats_init(search_stats);
 	ts.start();
 	int32 num_searches_played = 0;
+	int32 num_board_searches = 0;
 	for (int32 i = 0; i < num_searches_to_play; i++)
 	{
-		const int32 num_moves_found = rl_search_board(dawg, board, rack, move);
+		num_board_searches++;
+		const int32 num_moves_found = rl_search_board(dawg, board, rack, move, &search_stats);
 		printf("search(%d)found: %d\n", i, num_moves_found);
 		if (num_moves_found == 0)
 		{
@@ -208,6 +990,189 @@ int main(int argc, char* argv[])
 	printf("num-searches-played: %d\n", num_searches_played);
 	printf("elapsed(searches): %lld ns\n", elapsed_searches);
 
+	// Report how many DAWG nodes each search visited on average, and how many it skipped thanks to their summaries
+	printf("nodes-visited(moves): %.1f per search\n", static_cast<double>(move_stats.num_nodes_visited) / MAX(num_segment_searches, 1));
+	printf("nodes-pruned(moves): %.1f per search\n", static_cast<double>(move_stats.num_nodes_pruned) / MAX(num_segment_searches, 1));
+	printf("nodes-visited(searches): %.1f per search\n", static_cast<double>(search_stats.num_nodes_visited) / MAX(num_board_searches, 1));
+	printf("nodes-pruned(searches): %.1f per search\n", static_cast<double>(search_stats.num_nodes_pruned) / MAX(num_board_searches, 1));
+
+	// Optionally measure the throughput of searching the final board with small and large racks, in DAWG nodes visited
+	// per microsecond, drawing the racks from a bag of their own so that the tiles drawn later are unchanged
+	if (microbench_racks)
+	{
+		srand(seed + 3);
+		rl_bag rack_bag;
+		rl_bag_init(rack_bag);
+		for (int32 size_index = 0; size_index < COUNT_OF(SEARCH_RACK_SIZES); size_index++)
+		{
+			const int32 rack_size = SEARCH_RACK_SIZES[size_index];
+			rl_rack racks[SEARCH_RACK_NUM_RACKS];
+			for (int32 rack_index = 0; rack_index < SEARCH_RACK_NUM_RACKS; rack_index++)
+			{
+				rl_rack_init(racks[rack_index]);
+				for (int32 i = 0; i < rack_size; i++)
+				{
+					rl_rack_push(racks[rack_index], rl_bag_draw(rack_bag));
+				}
+			}
+
+			rl_search_stats rack_stats;
+			rl_search_stats_init(rack_stats);
+			int32 num_rack_moves = 0;
+			ts.start();
+			for (int32 rack_index = 0; rack_index < SEARCH_RACK_NUM_RACKS; rack_index++)
+			{
+				rl_move rack_move;
+				num_rack_moves += rl_search_board(dawg, board, racks[rack_index], rack_move, &rack_stats);
+			}
+			const long long elapsed_racks = ts.stop();
+
+			printf("num-rack-moves(%d): %d\n", rack_size, num_rack_moves);
+			printf("elapsed(search-rack,%d): %lld ns\n", rack_size, elapsed_racks / SEARCH_RACK_NUM_RACKS);
+			printf("nodes-per-us(search-rack,%d): %.1f\n", rack_size, rack_stats.num_nodes_visited * 1000.0 / MAX(elapsed_racks, 1LL));
+		}
+		srand(seed);
+	}
+
+	// Optionally compare finding the best move on the final board against finding the top K moves, and against copying
+	// out every legal move (which is what ranking them used to take)
+	if (topk > 0)
+	{
+		rl_move best_move;
+		ts.start();
+		const int32 num_legal_moves = rl_search_board(dawg, board, rack, best_move);
+		const long long elapsed_best = ts.stop();
+
+		rl_move* topk_moves = reinterpret_cast<rl_move*>(malloc(topk * sizeof(rl_move)));
+		ts.start();
+		const int32 num_topk_moves = rl_search_board_topk(dawg, board, rack, topk, nullptr, topk_moves);
+		const long long elapsed_topk = ts.stop();
+		const bool same = num_topk_moves == 0 || (topk_moves[0].word_len == best_move.word_len && topk_moves[0].index == best_move.index && topk_moves[0].offset == best_move.offset);
+		free(topk_moves);
+
+		rl_move* all_moves = reinterpret_cast<rl_move*>(malloc(MAX(num_legal_moves, 1) * sizeof(rl_move)));
+		ts.start();
+		rl_search_board_moves(dawg, board, rack, all_moves, num_legal_moves);
+		const long long elapsed_all = ts.stop();
+		free(all_moves);
+
+		printf("num-topk-moves: %d of %d\n", num_topk_moves, num_legal_moves);
+		printf("topk-matches-best: %d\n", same ? 1 : 0);
+		printf("elapsed(search-best): %lld ns\n", elapsed_best);
+		printf("elapsed(search-topk,%d): %lld ns\n", topk, elapsed_topk);
+		printf("elapsed(search-all-moves): %lld ns\n", elapsed_all);
+	}
+
+	// Optionally compare finding the highest-scoring move on the final board by scoring every legal move, against a
+	// best-score search that abandons branches that can't beat the best move found so far
+	if (best_score)
+	{
+		ScoreSample sample = { &board, -1 };
+		rl_search_stats exhaustive_stats;
+		rl_search_stats_init(exhaustive_stats);
+		ts.start();
+		rl_search_board_visit(dawg, board, rack, score_move, &sample, &exhaustive_stats);
+		const long long elapsed_exhaustive = ts.stop();
+
+		rl_move best_move;
+		rl_search_stats best_stats;
+		rl_search_stats_init(best_stats);
+		ts.start();
+		const int32 score = rl_search_board_best_score(dawg, board, rack, best_move, &best_stats);
+		const long long elapsed_best_score = ts.stop();
+
+		printf("best-score: %d %d\n", sample.best_score, score);
+		printf("nodes-visited(score-all): %llu\n", static_cast<unsigned long long>(exhaustive_stats.num_nodes_visited));
+		printf("nodes-visited(best-score): %llu\n", static_cast<unsigned long long>(best_stats.num_nodes_visited));
+		printf("nodes-bounded(best-score): %llu\n", static_cast<unsigned long long>(best_stats.num_nodes_bounded));
+		printf("pruned-fraction(best-score): %.3f\n", 1.0 - static_cast<double>(best_stats.num_nodes_visited) / MAX(exhaustive_stats.num_nodes_visited, 1ULL));
+		printf("elapsed(score-all): %lld ns\n", elapsed_exhaustive);
+		printf("elapsed(best-score): %lld ns\n", elapsed_best_score);
+	}
+
+	// Optionally compare searching the final board serially against searching it across several threads: each parallel
+	// search must settle on exactly the same move
+	if (parallel_search)
+	{
+		rl_move serial_move;
+		int32 num_serial_moves = 0;
+		ts.start();
+		for (int32 round = 0; round < PARALLEL_NUM_ROUNDS; round++)
+		{
+			num_serial_moves = rl_search_board(dawg, board, rack, serial_move);
+		}
+		const long long elapsed_serial = ts.stop() / PARALLEL_NUM_ROUNDS;
+		printf("num-parallel-moves: %d\n", num_serial_moves);
+		printf("elapsed(search-serial): %lld ns\n", elapsed_serial);
+
+		for (int32 i = 0; i < COUNT_OF(PARALLEL_THREAD_COUNTS); i++)
+		{
+			const int32 num_threads = PARALLEL_THREAD_COUNTS[i];
+			rl_move parallel_move;
+			int32 num_parallel_moves = 0;
+			ts.start();
+			for (int32 round = 0; round < PARALLEL_NUM_ROUNDS; round++)
+			{
+				num_parallel_moves = rl_search_board_parallel(dawg, board, rack, parallel_move, num_threads);
+			}
+			const long long elapsed_parallel = ts.stop() / PARALLEL_NUM_ROUNDS;
+			const bool same = num_parallel_moves == num_serial_moves && parallel_move.index == serial_move.index && parallel_move.offset == serial_move.offset &&
+				parallel_move.word_len == serial_move.word_len && memcmp(parallel_move.word, serial_move.word, serial_move.word_len) == 0;
+			printf("parallel-matches-serial(%d): %d\n", num_threads, same ? 1 : 0);
+			printf("elapsed(search-parallel,%d): %lld ns\n", num_threads, elapsed_parallel);
+			printf("speedup(%d): %.2f\n", num_threads, static_cast<double>(elapsed_serial) / MAX(elapsed_parallel, 1LL));
+		}
+	}
+
+	// Optionally play more moves on the final board without changing the rack (as if they were an opponent's), and
+	// compare searching the whole board again after each move against searching only the lines the move changed: each
+	// cached search must settle on exactly the same move
+	if (cached_search)
+	{
+		rl_search_cache cache;
+		rl_search_cache_init(cache);
+		rl_move cached_move;
+		ts.start();
+		rl_search_board_cached(dawg, board, rack, cached_move, cache);
+		const long long elapsed_cold = ts.stop();
+
+		long long elapsed_uncached = 0;
+		long long elapsed_cached = 0;
+		int32 num_lines_searched = 0;
+		int32 num_cached_moves = 0;
+		bool same = true;
+		for (int32 i = 0; i < CACHED_NUM_MOVES; i++)
+		{
+			rl_move uncached_move;
+			ts.start();
+			const int32 num_uncached_moves = rl_search_board(dawg, board, rack, uncached_move);
+			elapsed_uncached += ts.stop();
+			ts.start();
+			const int32 num_moves_found = rl_search_board_cached(dawg, board, rack, cached_move, cache);
+			elapsed_cached += ts.stop();
+			num_lines_searched += cache.num_lines_searched;
+
+			same = same && num_moves_found == num_uncached_moves && cached_move.index == uncached_move.index && cached_move.offset == uncached_move.offset &&
+				cached_move.word_len == uncached_move.word_len && memcmp(cached_move.word, uncached_move.word, uncached_move.word_len) == 0;
+			if (num_moves_found == 0)
+			{
+				break;
+			}
+			rl_board_write(dawg, board, cached_move.index, cached_move.offset == 1, cached_move.word, cached_move.word_len);
+			num_cached_moves++;
+		}
+		const int32 num_searches = MAX(num_cached_moves, 1);
+		printf("num-cached-moves-played: %d\n", num_cached_moves);
+		printf("cached-matches-uncached: %d\n", same ? 1 : 0);
+		printf("num-lines(board): %d\n", board.size_x + board.size_y);
+		printf("num-lines-searched(cached): %.1f\n", static_cast<double>(num_lines_searched) / num_searches);
+		printf("elapsed(search-cached-cold): %lld ns\n", elapsed_cold);
+		printf("elapsed(search-uncached): %lld ns\n", elapsed_uncached / num_searches);
+		printf("elapsed(search-cached): %lld ns\n", elapsed_cached / num_searches);
+		printf("speedup(cached): %.2f\n", static_cast<double>(elapsed_uncached) / MAX(elapsed_cached, 1LL));
+		rl_search_cache_free(cache);
+	}
+
 	if (print_board)
 	{
 		for (int32 y = 0; y < board_size_y; y++)
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "rl_types.h"
+
+struct rl_dawg;
+struct rl_rack;
+
+/*
+	Index of the words in a DAWG by their letters, regardless of order, for finding
+	anagrams of a set of letters and every word that can be formed from a rack.
+
+	Each word is reduced to a signature: its letters sorted from the rarest to the most
+	common (according to the DAWG's letter distribution), so that all anagrams of one
+	another share a signature. The signatures are stored as a trie, with the words for
+	each signature listed at the node where it ends. Finding the anagrams of a word is
+	then a single walk down the trie, one node per letter; and since every path through
+	the trie spells a sorted multiset of letters that begins some word's signature,
+	finding every word that can be formed from a rack is a walk of only those paths that
+	the rack can spell. Putting rare letters first means a rack without them rules out
+	most of the trie at the top.
+
+	As in a frozen DAWG, each node keeps a mask of the letters (by rank) labeling its
+	children, which are stored contiguously in rank order, so that a rack's letters can
+	be intersected with a node's children in one step. Words are identified by their
+	IDs in the DAWG (see rl_dawg_word_id), and can be spelled out with rl_dawg_word_at.
+*/
+struct rl_anagram_index
+{
+	// Position of each letter (by ordinal) in signature order, from the rarest at 0, and
+	// the letter ordinal at each position
+	uint8 letter_ranks[26];
+	uint8 rank_letters[26];
+
+	// Number of nodes in the signature trie, including the root (node 0)
+	int32 num_nodes;
+
+	// Number of distinct signatures, and the total number of words indexed
+	int32 num_signatures;
+	int32 num_words;
+
+	// For each node, a mask with bit r set if the node has a child for the letter of
+	// rank r, and the index of its first child: the child for rank r is at
+	// first_child + the number of bits set in the mask below r
+	uint32* child_masks;
+	int32* first_child;
+
+	// Offset of each node's words: the words whose signature ends at node i are
+	// word_ids[word_begin[i]..word_begin[i+1]). Contains num_nodes + 1 entries.
+	int32* word_begin;
+
+	// DAWG word IDs of every indexed word, grouped by the node their signature ends at,
+	// in ascending order within each group
+	int32* word_ids;
+
+	// Single allocation holding all of the arrays above
+	void* data;
+};
+
+// Called once per word found, with the word's ID in the DAWG the index was built from
+// and its length. Return true to continue the query, or false to stop it.
+typedef bool (*rl_anagram_visit_fn)(int32 word_id, int32 word_len, void* user_data);
+
+// Initializes an empty index, with no memory allocated.
+void rl_anagram_init(rl_anagram_index& index);
+
+// Releases all memory owned by the index.
+void rl_anagram_free(rl_anagram_index& index);
+
+// Builds an index of every word in a frozen (or packed) DAWG, replacing the index's
+// current contents. Not valid for a GADDAG. Returns the number of words indexed.
+int32 rl_anagram_build(rl_anagram_index& index, const rl_dawg& dawg);
+
+// Returns the number of bytes used by the index's arrays.
+size_t rl_anagram_num_bytes(const rl_anagram_index& index);
+
+// Finds every word that uses exactly the given letters, in any order, calling visit for
+// each in order of their IDs. Returns the number of words reported, as with
+// rl_anagram_find_sub.
+int32 rl_anagram_find(const rl_anagram_index& index, const uint8* letters, int32 num_letters, rl_anagram_visit_fn visit, void* user_data);
+
+// Finds every word that can be formed from some or all of the letters in the rack,
+// calling visit for each: words are reported grouped by signature, rarest letters
+// first. Returns the number of words reported, including the word for which visit
+// returned false, if any.
+int32 rl_anagram_find_sub(const rl_anagram_index& index, const rl_rack& rack, rl_anagram_visit_fn visit, void* user_data);
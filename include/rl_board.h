@@ -22,6 +22,26 @@ struct rl_board
 	uint8* blockflags; // Flags for each cell, indicating whether the cell is blocked from reaching its neighbor in each of the four directions
 	uint32* checkbits_x; // Allowable letters when playing a word DOWN, such that the tile played in this square forms a valid across move with the adjacent tiles already on the board
 	uint32* checkbits_y; // Allowable letters when playing a word ACROSS, such that the tile played in this square forms a valid down move with the adjacent titles already on the board
+	int32* cross_sums_x; // Total value of the letters already on the board that a tile played in this square would join into an across word (when playing DOWN), or -1 if there are none
+	int32* cross_sums_y; // Total value of the letters already on the board that a tile played in this square would join into a down word (when playing ACROSS), or -1 if there are none
+	uint8* letter_multipliers; // Optional multiplier applied to the value of the tile played in each square, or nullptr if there are no such premium squares
+	uint8* word_multipliers; // Optional multiplier applied to the score of every word that covers each square with a newly-played tile, or nullptr if there are no such premium squares
+	uint8 letter_values[26]; // Score for each letter, from 'a' to 'z': initialized to the standard English tile values, and must be set before any letters are written to the board
+
+	// Index of the RL_ANCHOR squares, kept up to date as letters are written, so that a search can jump from one anchor to the next without scanning the blank squares in between
+	int32 num_anchors; // Number of anchor squares on the board
+	int32 anchor_row_words; // Number of 64-bit words in each row's anchor bitmap, i.e. enough for one bit per column
+	int32 anchor_column_words; // Number of 64-bit words in each column's anchor bitmap, i.e. enough for one bit per row
+	uint64* anchor_rows; // Anchor bitmap for each row in turn, with bit x of row y set if the square at (x, y) is an anchor
+	uint64* anchor_columns; // Anchor bitmap for each column in turn, with bit y of column x set if the square at (x, y) is an anchor
+	uint64* anchor_row_summary; // Occupancy summary of the rows, with bit y set if row y has any anchors
+	uint64* anchor_column_summary; // Occupancy summary of the columns, with bit x set if column x has any anchors
+
+	// Versions of the board's contents, so that results found for a single line can be reused until the line changes
+	uint32 generation; // Process-unique id assigned by rl_board_init, telling apart boards that reuse the same address
+	uint32 version; // Advanced by each rl_board_write or rl_board_block_next call
+	uint32* row_versions; // Board version as of the last change to the letters, anchors, checkbits or blockflags of each row
+	uint32* column_versions; // Board version as of the last change to the letters, anchors, checkbits or blockflags of each column
 };
 
 void rl_board_init(rl_board& board, int32 playable_size_x, int32 playable_size_y);
@@ -31,3 +51,16 @@ void rl_board_coord(const rl_board& board, int32 index, int32& out_playable_x, i
 int32 rl_board_offset(const rl_board& board, bool across);
 void rl_board_write(const rl_dawg& dawg, rl_board& board, int32 start_index, bool across, const uint8* s, int32 s_len);
 void rl_board_block_next(rl_board& board, int32 index, bool across);
+
+// Sets the letter and word multipliers for a single square, allocating the board's multiplier arrays (with every other
+// square set to 1) the first time a premium square is set.
+void rl_board_set_premium(rl_board& board, int32 index, uint8 letter_multiplier, uint8 word_multiplier);
+
+// Lays out the premium squares of a standard 15x15 board, repeating the layout across boards of any other size.
+void rl_board_set_standard_premiums(rl_board& board);
+
+// Returns the score for playing the given word from the square at index onward: the value of each letter in the word,
+// with letter multipliers applied to the tiles played into empty squares, times the word multipliers of those squares;
+// plus, for each tile played alongside existing letters in the perpendicular direction, the score of the cross word
+// formed, scored the same way.
+int32 rl_board_score_move(const rl_board& board, int32 index, int32 offset, const uint8* word, int32 word_len);
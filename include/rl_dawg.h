@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cassert>
+#include <cstring>
+
 #include "rl_types.h"
+#include "rl_util.h"
 #include "rl_nodearray.h"
 #include "rl_nodelookup.h"
 #include "rl_distribution.h"
@@ -43,14 +47,18 @@ struct rl_dawg_ctx
 	rl_nodelookup minimized_lookup;
 
 	// Stack of newly-appended edges that have not yet been considered for minimization
-	rl_pending_edge edge_stack[RL_MAX_WORD_LEN];
+	// (with room for the separator in a GADDAG entry)
+	rl_pending_edge edge_stack[RL_MAX_WORD_LEN + 1];
 	int32 edge_stack_size;
 
 	// The last word added to the DAWG; used to ensure that words are added in strict
 	// lexicographical order
-	uint8 prev_word[RL_MAX_WORD_LEN];
+	uint8 prev_word[RL_MAX_WORD_LEN + 1];
 	int32 prev_word_len;
 
+	// Whether words may contain RL_GADDAG_SEPARATOR, as when building a GADDAG
+	bool allow_separator;
+
 	// Sum of each letter encountered in the input word list; used for computing the
 	// distribution of each letter in the final DAWG - prefix/suffix overlaps are
 	// irrelevant; e.g. 'cat' and 'cats' represents 7 total letters, not 4
@@ -58,38 +66,316 @@ struct rl_dawg_ctx
 	uint32 letter_counts_sum;
 };
 
+/*
+	A single edge in a frozen DAWG, packed into a 32-bit word:
+
+	- bits [0..5): ordinal of the letter labeling this edge (0 for 'a', 25 for 'z')
+	- bit 5: set if the node at the end of this edge terminates a valid word
+	- bits [6..32): index of the node at the end of this edge
+
+	Carrying the terminal flag on the edge means that a traversal never has to touch
+	the destination node just to find out whether it's arrived at a word. No edge ever
+	leads back to the root, so a value of 0 (RL_EDGE_NONE) is never a valid edge.
+*/
+typedef uint32 rl_edge;
+
+static const rl_edge RL_EDGE_NONE = 0;
+static const uint32 RL_EDGE_LETTER_MASK = 0x1f;
+static const uint32 RL_EDGE_TERMINAL = 0x20;
+static const int32 RL_EDGE_NODE_SHIFT = 6;
+
+// Symbol used in a GADDAG to mark the boundary between the reversed prefix of a word and
+// its suffix. Its ordinal (26) follows 'z', so separator edges always sort last.
+static const uint8 RL_GADDAG_SEPARATOR = 'z' + 1;
+
+// Layout of the 32-bit header that begins each node's record in a packed DAWG (see
+// rl_dawg_pack): the node's letter mask in the low bits, then the number of bytes used
+// by each of its edges, minus one
+static const uint32 RL_PACKED_MASK_BITS = 0x07ffffff;
+static const int32 RL_PACKED_WIDTH_SHIFT = 27;
+
+// Memory used by rl_dawg_build_unsorted to sort words in memory before it falls back to
+// sorting runs on disk and merging them, when no budget is given
+static const size_t RL_DAWG_DEFAULT_SORT_BUDGET = static_cast<size_t>(256) << 20;
+
+/*
+	Per-node record in a frozen DAWG: the letters labeling the node's own edges, plus a
+	summary of every word that can be completed from the node. The summary allows a
+	search to abandon a branch without descending into it: if none of the words below
+	a node fit the squares left on the board, or can be spelled with the letters left
+	in the rack, none of the node's edges need to be visited.
+*/
+struct rl_node_summary
+{
+	// Letters labeling the edges leading out of the node: bit i is set if the node has
+	// an edge for letter 'a' + i (with bit 26 for RL_GADDAG_SEPARATOR)
+	uint32 mask;
+
+	// Union of the letters labeling every edge reachable from the node, including its
+	// own edges, in the same form as mask
+	uint32 letters;
+
+	// Fewest and most letters that must follow the node to complete a word; both 0 if
+	// the node has no edges
+	uint8 min_len;
+	uint8 max_len;
+};
+
 /*
 	Directed Acyclic Word Graph, or DAWG, as described by Appel & Jacobson in
 	Communications of the ACM Vol 31 No 5, May 1988:
 	https://www.cs.cmu.edu/afs/cs/academic/class/15451-s06/www/lectures/scrabble.pdf
 
 	See also: rl_node.h.
+
+	The same structure can instead hold a GADDAG, as described by Gordon in Software:
+	Practice and Experience Vol 24 No 2, February 1994. A GADDAG contains, for every way
+	of splitting each word w = x1..xn, the reversed prefix followed by the separator and
+	the suffix: x_i..x_1 RL_GADDAG_SEPARATOR x_(i+1)..x_n, with the separator omitted
+	when the suffix is empty. Any word can thus be traversed starting from any of its
+	letters, going left first and then right, which lets move generation grow words
+	outward from an anchor square rather than enumerating every possible prefix.
+
+	The DAWG is built as an rl_nodearray, where every node owns its own edgemap. Once
+	fully minimized, rl_dawg_freeze converts those nodes into a read-only, CSR-style
+	layout: all edges are packed into a single flat array, ordered by source node, and
+	each node is reduced to the offset of its first edge in that array, plus a mask
+	with one bit set for each letter that labels one of its edges. Node 0 is the root
+	of the DAWG. Valid words can be found by traversing the DAWG letter-by-letter,
+	starting at the root and following the edge labeled with the desired letter at
+	each iteration.
+
+	Since a node's edges are sorted by letter, the edge for a given letter is found by
+	testing that letter's bit in the node's mask, then counting the bits set below it
+	to find its rank among the node's edges. Search can likewise AND a node's mask with
+	the letters in the rack and the cross-check bits for a square, visiting only the
+	edges that can actually be played. Each node's mask is stored in its
+	rl_node_summary, alongside the length range and letters of the words below it,
+	all computed once when the DAWG is frozen.
 */
 struct rl_dawg
 {
-	// Final, fully-minimized array of nodes, with items[0] being the root of the DAWG.
-	// Valid words can be found by traversing the DAWG letter-by-letter, starting at
-	// the root and following the edge labeled with the desired letter at each
-	// iteration.
+	// Array of nodes transferred from an rl_dawg_ctx; consumed (and left empty) by
+	// rl_dawg_freeze.
 	rl_nodearray nodearray;
 
+	// Number of nodes in the frozen DAWG, including the root
+	int32 num_nodes;
+
+	// Total number of edges in the frozen DAWG
+	int32 num_edges;
+
+	// Offset of each node's first edge: the edges leading out of node i are
+	// edges[node_edges[i]..node_edges[i+1]), sorted by letter. Contains num_nodes + 1
+	// entries.
+	uint32* node_edges;
+
+	// Mask of the letters labeling each node's edges, along with a summary of the words
+	// that can be completed from that node; kept together since a search needs both
+	// whenever it visits a node. Contains num_nodes entries.
+	rl_node_summary* node_summaries;
+
+	// Packed edges for all nodes, indexed [0..num_edges)
+	rl_edge* edges;
+
+	// Rank of each edge among the words that can be completed from its source node: the
+	// number of those words that sort before every word reached through the edge (i.e.
+	// the words below all of the node's earlier edges). Lets a word be mapped to its
+	// position in alphabetical order, and back again, in time proportional to its
+	// length. Indexed in parallel with edges.
+	uint32* edge_ranks;
+
+	// Single block of memory backing node_edges, node_summaries, edges and edge_ranks (or
+	// packed): either a heap allocation made by rl_dawg_freeze or rl_dawg_pack, or a
+	// read-only view into a file mapped by rl_dawg_load_mapped
+	void* data;
+
+	// If the DAWG was loaded with rl_dawg_load_mapped, the base address and size of
+	// the file mapping, which must be unmapped (rather than freed) when the DAWG is
+	// freed; nullptr otherwise
+	void* mapping;
+	size_t mapping_size;
+
+	// If the DAWG was converted with rl_dawg_pack, the variable-length record of each of
+	// its nodes, with each node's index being the byte offset of its record; nullptr
+	// otherwise. A packed DAWG has no node_edges, node_summaries, edges or edge_ranks.
+	const uint8* packed;
+	size_t packed_size;
+
+	// Number of distinct words contained in the DAWG
+	int32 num_words;
+
+	// Whether this is a GADDAG (built with rl_dawg_build_gaddag) rather than a DAWG
+	bool is_gaddag;
+
+	// Process-unique id assigned each time the DAWG's contents are (re)built, reordered, packed or loaded, so that
+	// results cached against one set of contents are never mistaken for another's; 0 until then
+	uint32 generation;
+
 	// Final weights representing how common each letter is in the input word list;
 	// summing to 1.0
 	rl_distribution distribution;
 };
 
+// Returns the letter ('a' through 'z', or RL_GADDAG_SEPARATOR in a GADDAG) that labels
+// the given edge.
+inline uint8 rl_edge_letter(rl_edge edge)
+{
+	return static_cast<uint8>('a' + (edge & RL_EDGE_LETTER_MASK));
+}
+
+// Returns whether the node at the end of the given edge terminates a valid word.
+inline bool rl_edge_is_word(rl_edge edge)
+{
+	return (edge & RL_EDGE_TERMINAL) != 0;
+}
+
+// Returns the index of the node at the end of the given edge.
+inline int32 rl_edge_node_index(rl_edge edge)
+{
+	return static_cast<int32>(edge >> RL_EDGE_NODE_SHIFT);
+}
+
+// Returns a pointer to the first edge leading out of the given node.
+inline const rl_edge* rl_dawg_edges_begin(const rl_dawg& dawg, int32 node_index)
+{
+	assert(!dawg.packed);
+	return dawg.edges + dawg.node_edges[node_index];
+}
+
+// Returns a pointer one past the last edge leading out of the given node.
+inline const rl_edge* rl_dawg_edges_end(const rl_dawg& dawg, int32 node_index)
+{
+	assert(!dawg.packed);
+	return dawg.edges + dawg.node_edges[node_index + 1];
+}
+
+// Returns the mask of letters labeling the edges leading out of the given node.
+inline uint32 rl_dawg_node_mask(const rl_dawg& dawg, int32 node_index)
+{
+	if (dawg.packed)
+	{
+		uint32 header;
+		memcpy(&header, dawg.packed + node_index, sizeof(header));
+		return header & RL_PACKED_MASK_BITS;
+	}
+	return dawg.node_summaries[node_index].mask;
+}
+
+// Returns the index, within edges, of the edge leading out of the given node that's
+// labeled with the letter whose ordinal is given ('a' is 0). The letter's bit must be
+// set in mask, which must be the node's mask. Not valid for a packed DAWG.
+inline uint32 rl_dawg_node_edge_index(const rl_dawg& dawg, int32 node_index, uint32 mask, uint32 ordinal)
+{
+	assert(!dawg.packed);
+	assert(mask == dawg.node_summaries[node_index].mask);
+	assert(mask & (1u << ordinal));
+	return dawg.node_edges[node_index] + rl_popcount(mask & ((1u << ordinal) - 1));
+}
+
+// Returns the edge leading out of the given node that's labeled with the letter whose
+// ordinal is given ('a' is 0). The letter's bit must be set in mask, which must be the
+// node's mask.
+inline rl_edge rl_dawg_node_edge(const rl_dawg& dawg, int32 node_index, uint32 mask, uint32 ordinal)
+{
+	if (dawg.packed)
+	{
+		// Each edge holds the distance to the node at its end, shifted left to make room for the terminal flag, in
+		// as many bytes as the node's header specifies: read four bytes and keep the ones that belong to this edge
+		const uint8* record = dawg.packed + node_index;
+		uint32 header;
+		memcpy(&header, record, sizeof(header));
+		assert(mask == (header & RL_PACKED_MASK_BITS));
+		assert(mask & (1u << ordinal));
+		const uint32 width = (header >> RL_PACKED_WIDTH_SHIFT) + 1;
+		uint32 value;
+		memcpy(&value, record + sizeof(header) + rl_popcount(mask & ((1u << ordinal) - 1)) * width, sizeof(value));
+		value &= ~0u >> (32 - 8 * width);
+		return ordinal | ((value & 1) * RL_EDGE_TERMINAL) | ((static_cast<uint32>(node_index) + (value >> 1)) << RL_EDGE_NODE_SHIFT);
+	}
+	return dawg.edges[rl_dawg_node_edge_index(dawg, node_index, mask, ordinal)];
+}
+
+// Searches the frozen DAWG for an edge leading out of the given node, labeled with the
+// given letter. Returns RL_EDGE_NONE if there is no such edge.
+inline rl_edge rl_dawg_find_edge(const rl_dawg& dawg, int32 node_index, uint8 letter)
+{
+	const uint32 ordinal = static_cast<uint32>(letter - 'a');
+	const uint32 mask = rl_dawg_node_mask(dawg, node_index);
+	if (ordinal >= 32 || (mask & (1u << ordinal)) == 0)
+	{
+		return RL_EDGE_NONE;
+	}
+	return rl_dawg_node_edge(dawg, node_index, mask, ordinal);
+}
+
+// Returns true if the given word is in a frozen (or packed) DAWG. In a GADDAG, the word
+// must be given as a complete GADDAG entry.
+bool rl_dawg_contains(const rl_dawg& dawg, const uint8* word, int32 word_len);
+
+// Looks up n words at once, as with rl_dawg_contains, setting bit i of out_bits (i.e.
+// bit i % 8 of out_bits[i / 8]) if words[i], of length lens[i], is in the DAWG, and
+// clearing it otherwise. out_bits must have room for at least (n + 7) / 8 bytes. Rather
+// than walking each word from root to end in turn, many lookups advance together one
+// letter at a time, with each step prefetching the nodes the next step will read, so
+// that the cache misses incurred by different words overlap instead of each stalling
+// the whole lookup in turn.
+void rl_dawg_contains_batch(const rl_dawg& dawg, const uint8* const* words, const int32* lens, int32 n, uint8* out_bits);
+
+// Creates a packed, read-only copy of a frozen DAWG (or GADDAG), trading a little lookup
+// speed for a much smaller footprint. Each node becomes a variable-length record: a
+// 32-bit header holding its letter mask and the width of its edges, followed by one
+// 1- to 4-byte edge per letter, giving the distance to the node at its end along with
+// its terminal flag. Nodes are laid out so that every node comes after its parents,
+// with the root first, keeping those distances small. Nodes are identified by the byte
+// offset of their record, and are traversed using the same functions as any DAWG:
+// rl_dawg_node_mask, rl_dawg_node_edge, and rl_dawg_find_edge. A packed DAWG has no
+// node summaries or word ranks, so searches do without subtree pruning, and it can't
+// be saved, edited, reordered, or used to look up word IDs. The original DAWG is left
+// unchanged; you must call rl_dawg_free on the copy when done.
+void rl_dawg_pack(const rl_dawg& dawg, rl_dawg& packed);
+
+// Returns the number of bytes used to hold a frozen or packed DAWG's nodes and edges.
+size_t rl_dawg_num_bytes(const rl_dawg& dawg);
+
+// Returns the ID of the given word in a frozen DAWG: its index, from 0 to num_words - 1,
+// in the alphabetical list of all words in the DAWG. Returns -1 if the word is not in
+// the DAWG. IDs are dense, so per-word data can be kept in flat arrays indexed by ID.
+// Not valid for a GADDAG.
+int32 rl_dawg_word_id(const rl_dawg& dawg, const uint8* word, int32 word_len);
+
+// Writes the word with the given ID (as returned by rl_dawg_word_id) into out_word,
+// which must have room for RL_MAX_WORD_LEN letters. Returns the length of the word.
+// Not valid for a GADDAG.
+int32 rl_dawg_word_at(const rl_dawg& dawg, int32 word_id, uint8* out_word);
+
+// Picks a word uniformly at random from a frozen DAWG that contains at least one word,
+// given an input value between 0 and UINT32_MAX, and writes it into out_word as with
+// rl_dawg_word_at. Returns the length of the word.
+int32 rl_dawg_random_word(const rl_dawg& dawg, uint32 randval, uint8* out_word);
+
 // Initializes a new rl_dawg_ctx. You must call rl_daw_ctx_free when done. These
 // functions are used internally by rl_dawg_build: you generally shouldn't need to call
 // them directly.
 void rl_dawg_ctx_init(rl_dawg_ctx& ctx);
 
+// Initializes a new rl_dawg_ctx as with rl_dawg_ctx_init, but backed by an arena:
+// edgemap storage for all nodes is carved from an rl_edgepool rather than allocated
+// per node, with storage from nodes merged away during minimization being recycled,
+// and the nodearray is pre-sized from wordlist_size (the size in bytes of the input
+// word list, or 0 if unknown) so that it rarely needs to grow. You must call
+// rl_dawg_ctx_free when done.
+void rl_dawg_ctx_init_arena(rl_dawg_ctx& ctx, size_t wordlist_size);
+
 // Releases all memory currently owned by the context.
 void rl_dawg_ctx_free(rl_dawg_ctx& ctx);
 
 // Adds a new word to the DAWG. Valid words consist only of lowercase ASCII letters 'a'
-// through 'z' and must not exceed RL_MAX_WORD_LEN. Words must be added in alphabetical
-// order. Returns true if the word was accepted and added to the DAWG; false if the
-// word was rejected as invalid.
+// through 'z' and must not exceed RL_MAX_WORD_LEN. If the context allows separators,
+// a word may also contain RL_GADDAG_SEPARATOR, which counts toward neither its length
+// nor the letter distribution. Words must be added in alphabetical order. Returns true
+// if the word was accepted and added to the DAWG; false if the word was rejected as
+// invalid.
 bool rl_dawg_ctx_add(rl_dawg_ctx& ctx, const uint8* word, int32 word_len);
 
 // Finalizes the DAWG, performing a final minimization pass to ensure that all branches
@@ -107,8 +393,77 @@ void rl_dawg_init(rl_dawg& dawg);
 // Releases all memory currently owned by the DAWG.
 void rl_dawg_free(rl_dawg& dawg);
 
+// Converts the DAWG's nodearray (as transferred by rl_dawg_ctx_move_nodes) into its
+// final, frozen layout, then frees the nodearray. Once frozen, the DAWG is read-only,
+// and all of its nodes and edges live in a single heap allocation.
+void rl_dawg_freeze(rl_dawg& dawg);
+
+// Renumbers the nodes of a frozen DAWG (or GADDAG) so that nodes visited together are
+// stored close together in memory, rewriting its edges to match. With no weights, nodes
+// are ordered breadth-first from the root, so that the nodes for the first few letters
+// of every word, which nearly every traversal passes through, share a handful of cache
+// lines and pages. Alternatively, node_weights may give a weight for each node (e.g.
+// the visit counts recorded by rl_search_stats over a sample workload), and nodes are
+// then ordered from heaviest to lightest. The root always remains node 0. The words in
+// the DAWG, their IDs, and the results of any search are unaffected; a DAWG that was
+// loaded with rl_dawg_load_mapped is copied to the heap.
+void rl_dawg_reorder(rl_dawg& dawg, const uint32* node_weights);
+
+// Writes a binary image of a frozen DAWG (its nodes, edges, and distribution) to the
+// given path, tagged with a format version, the byte order of the host machine, and a
+// checksum of its contents. Returns true on success.
+bool rl_dawg_save(const rl_dawg& dawg, const char* path);
+
+// Loads a binary image previously written by rl_dawg_save, mapping the file into
+// memory: the DAWG's nodes and edges are read directly from the mapped pages, with no
+// parsing or copying, so any number of processes that load the same file will share
+// the same physical copy of the dictionary. The input dawg must already be
+// initialized. Returns the number of words in the DAWG, or 0 if the file could not be
+// mapped or is not a valid image for this version and byte order.
+int32 rl_dawg_load_mapped(rl_dawg& dawg, const char* path);
+
 // Reads a list of alphabetically-sorted words from the given ASCII text file, building
-// a DAWG from that set of words. Uses rl_dawg_ctx internally. The input dawg must
-// already be initialized. Returns the total number of words that were accepted and
-// added to the DAWG.
+// a frozen DAWG from that set of words. Uses rl_dawg_ctx internally. The input dawg
+// must already be initialized. Returns the total number of words that were accepted and
+// added to the DAWG, or 0 if the word list could not be read in full.
 int32 rl_dawg_build(rl_dawg& dawg, const char* wordlist_path);
+
+// Builds a frozen DAWG exactly as rl_dawg_build does, but reads the word list from an
+// already-open file descriptor (e.g. 0 to read from stdin) instead of a path. The
+// descriptor is read to the end but is not closed. Returns the total number of words
+// that were accepted and added to the DAWG, or 0 if a read failed.
+int32 rl_dawg_build_fd(rl_dawg& dawg, int fd);
+
+// Builds a frozen DAWG from a word list in any order, which may contain duplicates.
+// Valid words are collected in memory, sorted with a radix sort and deduplicated
+// before being added to the DAWG. If the list would take more than memory_budget bytes
+// to sort (or RL_DAWG_DEFAULT_SORT_BUDGET, if 0), it's sorted in pieces that are
+// spilled to temp files, which are then merged. Each distinct word counts once toward
+// the letter distribution. The input dawg must already be initialized. Returns the
+// number of distinct words added to the DAWG, or 0 if the word list could not be read in
+// full or a temp file could not be written.
+int32 rl_dawg_build_unsorted(rl_dawg& dawg, const char* wordlist_path, size_t memory_budget);
+
+// As rl_dawg_build_unsorted, but reads the word list from an open file descriptor.
+int32 rl_dawg_build_unsorted_fd(rl_dawg& dawg, int fd, size_t memory_budget);
+
+// Builds a frozen DAWG from the same kind of word list as rl_dawg_build, splitting the
+// work across up to num_threads threads: the list is partitioned into shards by ranges
+// of first letters, each shard is built and minimized independently, and the shards
+// are then merged under a common root, deduplicating equivalent nodes across shards.
+// The result is identical in size and content to the DAWG produced by rl_dawg_build,
+// even for a word list that isn't fully sorted: the same out-of-order words are
+// rejected. The input dawg must already be initialized. Returns the
+// total number of words that were accepted and added to the DAWG, or 0 if the word list
+// could not be read in full.
+int32 rl_dawg_build_parallel(rl_dawg& dawg, const char* wordlist_path, int32 num_threads);
+
+// Builds a frozen GADDAG (see rl_dawg) from a word list in any order, setting is_gaddag.
+// Every split of every valid word is generated as a separate entry, and the entries are
+// sorted, deduplicated and fed through an rl_dawg_ctx, so the GADDAG is minimized in
+// the same way as a DAWG. The letter distribution is computed from the distinct words
+// themselves. rl_search_board and rl_search_segment use a bidirectional search when
+// given a GADDAG, finding the same moves as they would with a DAWG built from the same
+// word list. The input dawg must already be initialized. Returns the number of
+// distinct words in the GADDAG, or 0 if the word list could not be read in full.
+int32 rl_dawg_build_gaddag(rl_dawg& dawg, const char* wordlist_path);
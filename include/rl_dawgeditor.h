@@ -0,0 +1,74 @@
+#pragma once
+
+#include "rl_types.h"
+#include "rl_nodearray.h"
+#include "rl_nodelookup.h"
+
+struct rl_dawg;
+
+/*
+	Mutable copy of a finished DAWG, allowing individual words to be added and removed
+	without rebuilding the DAWG from a word list. The DAWG is kept minimal after every
+	edit, using the incremental algorithm described by Carrasco & Forcada ("Incremental
+	Construction and Maintenance of Minimal Finite-State Automata", 2002):
+
+	- Every node other than the root is registered by its signature, and we track the
+	  number of edges leading into each node.
+	- To edit a word, we walk its path from the root. Nodes along that path are about
+	  to change, so they're removed from the register. From the first node on the path
+	  that's shared with other paths (i.e. has more than one incoming edge), the rest
+	  of the path is cloned, so that the edit can't affect any other words.
+	- After the edit, we walk back up the path toward the root, replacing each node
+	  with an equivalent registered node if one exists, or registering it otherwise.
+
+	Each edit touches only the nodes along the word's path, so its cost is proportional
+	to the length of the word rather than the size of the DAWG. Once a batch of edits
+	is done, rl_dawgeditor_commit writes the result back out as a frozen rl_dawg.
+*/
+struct rl_dawgeditor
+{
+	// Nodes of the DAWG, including any that have been deleted and not yet reused
+	rl_nodearray nodearray;
+
+	// Register of every live node other than the root, by signature
+	rl_nodelookup minimized_lookup;
+
+	// Number of edges leading into each node, indexed in parallel with nodearray
+	int32* in_degrees;
+	int32 in_degrees_capacity;
+
+	// Indices of deleted nodes, available to be reused
+	int32* free_nodes;
+	int32 num_free_nodes;
+	int32 free_nodes_capacity;
+
+	// Number of words currently in the DAWG
+	int32 num_words;
+};
+
+// Initializes an editor with a mutable copy of the given frozen DAWG, which must have
+// been built (or loaded) already, and must not be a GADDAG. The DAWG itself is not modified until
+// rl_dawgeditor_commit is called. You must call rl_dawgeditor_free when done.
+void rl_dawgeditor_init(rl_dawgeditor& editor, const rl_dawg& dawg);
+
+// Releases all memory owned by the editor.
+void rl_dawgeditor_free(rl_dawgeditor& editor);
+
+// Returns true if the given word is currently in the editor's DAWG.
+bool rl_dawgeditor_contains(const rl_dawgeditor& editor, const uint8* word, int32 word_len);
+
+// Adds a word to the DAWG. Valid words consist only of lowercase ASCII letters 'a'
+// through 'z' and must not exceed RL_MAX_WORD_LEN, but may be added in any order.
+// Returns true if the word was added; false if it was invalid or already present.
+bool rl_dawgeditor_add(rl_dawgeditor& editor, const uint8* word, int32 word_len);
+
+// Removes a word from the DAWG. Returns true if the word was removed; false if it was
+// not present.
+bool rl_dawgeditor_remove(rl_dawgeditor& editor, const uint8* word, int32 word_len);
+
+// Replaces the contents of the given DAWG (which may be the same DAWG the editor was
+// initialized from) with a frozen copy of the editor's current state, recomputing the
+// letter distribution from the words now in the DAWG. The editor remains valid, so
+// further edits can be made and committed again later. Returns the number of words in
+// the DAWG.
+int32 rl_dawgeditor_commit(const rl_dawgeditor& editor, rl_dawg& dawg);
@@ -2,6 +2,8 @@
 
 #include "rl_types.h"
 
+struct rl_edgepool;
+
 /*
 	Entry in an rl_edgemap, representing a single edge leading from one DAWG node
 	to another. Consider this example DAWG, which contains 6 nodes and 5 edges:
@@ -63,8 +65,17 @@ void rl_edgemap_init(rl_edgemap& edgemap);
 void rl_edgemap_free(rl_edgemap& edgemap);
 
 // Inserts a new item into the edgemap, reallocating the items buffer if necessary.
+// Items are kept in order by letter.
 void rl_edgemap_insert(rl_edgemap& edgemap, uint8 letter, int32 node_index);
 
+// Inserts a new item into the edgemap, as with rl_edgemap_insert, except that the items
+// buffer is obtained from (and, when outgrown, returned to) the given edgepool.
+void rl_edgemap_insert_pooled(rl_edgemap& edgemap, rl_edgepool& edgepool, uint8 letter, int32 node_index);
+
+// Returns the items buffer of an edgemap populated with rl_edgemap_insert_pooled to
+// the edgepool it came from, leaving the edgemap empty.
+void rl_edgemap_release(rl_edgemap& edgemap, rl_edgepool& edgepool);
+
 // Searches for an edge associated with the given letter. If such a node exists,
 // returns the index of the node to which that edge points. If no such node exists,
 // returns -1.
@@ -74,3 +85,8 @@ int32 rl_edgemap_find(const rl_edgemap& edgemap, uint8 letter);
 // replacing it with the given index value. If the edgemap does not contain an item
 // matching the given letter, behavior is undefined.
 void rl_edgemap_replace(rl_edgemap& edgemap, uint8 letter, int32 node_index);
+
+// Removes the edge associated with the given letter, keeping the remaining items in
+// order. If the edgemap does not contain an item matching the given letter, behavior is
+// undefined.
+void rl_edgemap_remove(rl_edgemap& edgemap, uint8 letter);
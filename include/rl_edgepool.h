@@ -0,0 +1,66 @@
+#pragma once
+
+#include "rl_types.h"
+
+struct rl_edgemap_item;
+
+// Edgemaps grow in steps of this many items, so every edgemap's capacity is a
+// multiple of it: each distinct capacity is a size class within an rl_edgepool.
+static const int32 RL_EDGEMAP_CAPACITY_STEP = 4;
+
+// Number of size classes tracked by an rl_edgepool: enough for an edgemap holding an
+// edge for every possible letter.
+static const int32 RL_EDGEPOOL_NUM_CLASSES = 8;
+
+/*
+	Header at the start of each large block of memory allocated by an rl_edgepool.
+*/
+struct rl_edgepool_slab
+{
+	// Previously-allocated slab, or nullptr if this is the first
+	rl_edgepool_slab* prev;
+};
+
+/*
+	Slab allocator for edgemap storage while a DAWG is under construction. Rather than
+	making a separate heap allocation for every node's edgemap, edgemaps are carved out
+	of a handful of large slabs with a bump pointer. Storage released by an edgemap
+	(because it grew into the next size class, or because its node was popped during
+	minimization) is kept on a free list for that size class and handed out again
+	before any new slab space is used. All storage is returned to the heap at once when
+	the pool is freed.
+*/
+struct rl_edgepool
+{
+	// Head of the free list for each size class, where class i holds blocks with room
+	// for (i + 1) * RL_EDGEMAP_CAPACITY_STEP items. Each free block stores a pointer to
+	// the next free block of the same class.
+	void* free_lists[RL_EDGEPOOL_NUM_CLASSES];
+
+	// Most recently allocated slab, linked to all earlier slabs
+	rl_edgepool_slab* slabs;
+
+	// Range of unused memory remaining in the most recent slab
+	uint8* bump;
+	uint8* bump_end;
+
+	// Size in bytes of the next slab to be allocated: each slab is twice the size of
+	// the last
+	size_t next_slab_size;
+};
+
+// Initializes an edgepool, allocating an initial slab of (at least) the given size.
+// You must call rl_edgepool_free when done.
+void rl_edgepool_init(rl_edgepool& edgepool, size_t initial_slab_size);
+
+// Releases all slabs owned by the pool, along with any edgemap storage carved from
+// them.
+void rl_edgepool_free(rl_edgepool& edgepool);
+
+// Returns storage for an array of the given number of items, which must be a nonzero
+// multiple of RL_EDGEMAP_CAPACITY_STEP.
+rl_edgemap_item* rl_edgepool_alloc(rl_edgepool& edgepool, int32 capacity);
+
+// Returns storage previously obtained from rl_edgepool_alloc, with the same capacity,
+// to the pool for reuse.
+void rl_edgepool_release(rl_edgepool& edgepool, rl_edgemap_item* items, int32 capacity);
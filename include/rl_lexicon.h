@@ -0,0 +1,59 @@
+#pragma once
+
+#include "rl_types.h"
+#include "rl_dawg.h"
+
+// Flags describing how a lexicon is loaded: lexicons loaded from the same path with
+// different flags are distinct
+static const uint32 RL_LEXICON_GADDAG = 1u << 0; // Build a GADDAG rather than a DAWG from the word list
+static const uint32 RL_LEXICON_MAPPED = 1u << 1; // Path is an image written by rl_dawg_save, to be loaded with rl_dawg_load_mapped
+static const uint32 RL_LEXICON_PACKED = 1u << 2; // Convert the DAWG with rl_dawg_pack once it's loaded
+
+/*
+	A lexicon shared by every user of the same word list within the process. Lexicons
+	are loaded on demand by rl_lexicon_acquire, which returns the same lexicon to every
+	caller that asks for the same path with the same flags, and unloaded once the last
+	reference to them is released. A DAWG is never modified once it's frozen, so the
+	same lexicon can be searched by any number of threads at once, and memory use grows
+	with the number of distinct lexicons rather than the number of games using them.
+
+	All fields are owned by the registry: callers should only read dawg.
+*/
+struct rl_lexicon
+{
+	// The lexicon's frozen (or packed) DAWG or GADDAG
+	rl_dawg dawg;
+
+	// Path and flags that the lexicon was loaded with, identifying it in the registry
+	char* path;
+	uint32 flags;
+
+	// Number of outstanding references to the lexicon, including any callers still
+	// waiting for it to finish loading
+	int32 ref_count;
+
+	// Whether the lexicon is still being loaded by the first caller to acquire it, and
+	// if not, whether it loaded successfully
+	bool loading;
+	bool loaded;
+
+	// Next lexicon in the registry
+	rl_lexicon* next;
+};
+
+// Returns a reference to the lexicon for the given path and flags, loading it if no
+// other reference to it exists: concurrent callers asking for a lexicon that's still
+// being loaded wait for it, without holding up callers asking for other lexicons.
+// Returns nullptr if the lexicon could not be loaded. Each reference must be released
+// with rl_lexicon_release when done.
+const rl_lexicon* rl_lexicon_acquire(const char* path, uint32 flags);
+
+// Adds another reference to a lexicon that the caller already holds a reference to,
+// e.g. to hand to another game; this never blocks on loading. Returns the lexicon.
+const rl_lexicon* rl_lexicon_retain(const rl_lexicon* lexicon);
+
+// Releases a reference to a lexicon, unloading it if it was the last one.
+void rl_lexicon_release(const rl_lexicon* lexicon);
+
+// Returns the number of lexicons currently in the registry, including any still loading.
+int32 rl_lexicon_num_loaded();
@@ -3,6 +3,8 @@
 #include "rl_types.h"
 #include "rl_rack.h"
 
+struct rl_board;
+
 struct rl_move
 {
 	int32 index;
@@ -13,3 +15,7 @@ struct rl_move
 };
 
 void rl_move_init(rl_move& move);
+
+// Sets the move to play the given word from the square at index onward, filling in letters_used with every letter of
+// the word that isn't already on the board.
+void rl_move_set(rl_move& move, const rl_board& board, int32 index, int32 offset, const uint8* word, int32 word_len);
@@ -59,3 +59,7 @@ void rl_node_reset(rl_node& node);
 // set of letter-to-node-index mappings in the next_by_letter edgemap, such that each
 // node in a DAWG should have a unique signature
 uint64 rl_node_signature(const rl_node& node);
+
+// Returns whether two nodes are structurally identical: i.e. they have the same
+// is_word flag and the same set of letter-to-node-index mappings.
+bool rl_node_equals(const rl_node& lhs, const rl_node& rhs);
@@ -3,11 +3,16 @@
 #include "rl_types.h"
 
 struct rl_node;
+struct rl_edgepool;
 
 /*
 	A one-dimensional array of nodes that represent the data in a DAWG. Wraps a
 	fixed-size buffer that will be reallocated if the array grows beyond its initial
 	capacity.
+
+	By default, each node's edgemap is separately heap-allocated. A nodearray
+	initialized with rl_nodearray_init_pooled instead carves all edgemap storage out of
+	an rl_edgepool that it owns, recycling storage from popped nodes.
 */
 struct rl_nodearray
 {
@@ -19,12 +24,21 @@ struct rl_nodearray
 
 	// Number of valid items stored in the array
 	int32 size;
+
+	// Pool from which all edgemap storage is allocated, or nullptr if each edgemap
+	// manages its own heap allocation
+	rl_edgepool* edgepool;
 };
 
 // Initializes a new nodearray, allocating a buffer with the desired initial capacity,
 // which must be >0. You must call rl_nodearray_free when finished with the nodearray.
 void rl_nodearray_init(rl_nodearray& nodearray, int32 capacity);
 
+// Initializes a new nodearray as with rl_nodearray_init, additionally creating an
+// rl_edgepool (whose first slab is at least edge_slab_size bytes) to provide storage
+// for the edgemaps of all nodes in the array.
+void rl_nodearray_init_pooled(rl_nodearray& nodearray, int32 capacity, size_t edge_slab_size);
+
 // Frees all memory allocated for use by this nodearray.
 void rl_nodearray_free(rl_nodearray& nodearray);
 
@@ -35,3 +49,8 @@ int32 rl_nodearray_push(rl_nodearray& nodearray, bool is_word);
 // must pass the index of the last item. If the provided index is not equal to the index
 // of the last item, behavior is undefined.
 void rl_nodearray_pop(rl_nodearray& nodearray, int32 back_index);
+
+// Adds an edge labeled with the given letter, leading from the node at node_index to
+// the node at to_index, allocating edgemap storage from the nodearray's edgepool if it
+// has one.
+void rl_nodearray_insert_edge(rl_nodearray& nodearray, int32 node_index, uint8 letter, int32 to_index);
@@ -2,54 +2,69 @@
 
 #include "rl_types.h"
 
+struct rl_node;
+struct rl_nodearray;
+
 /*
-	Item in a linked list that records the signature of a given node along with its
-	index.
+	Slot in an rl_nodelookup's table, recording the signature of a given node along
+	with its index. Slots are stored inline in a single flat array: an empty slot has
+	a node_index of -1.
 */
 struct rl_nodelookup_item
 {
-	// Pointer to the next item in the linked list, or nullptr if this item is the last
-	rl_nodelookup_item* next;
-
-	// Exact signature (i.e. hash) of the node in question
+	// Signature (i.e. hash) of the node in question
 	uint64 signature;
 
-	// Index at which that node can be found in the original nodearray
+	// Index at which that node can be found in the original nodearray, or -1 if this
+	// slot is empty
 	int32 node_index;
 };
 
 /*
-	Hash map used to facilitate fast lookups of a given node's index in the nodearray,
-	given the unique signature computed from that node. Used in the process of
+	Open-addressing hash map used to facilitate fast lookups of a given node's index in
+	the nodearray, given the signature computed from that node. Used in the process of
 	finalizing the DAWG, letting us quickly identify if a particular node is identical
 	to one we've already seen before.
+
+	Collisions are resolved by linear probing, and the table doubles in capacity
+	whenever it becomes more than 70% full, so probe sequences stay short no matter
+	how many nodes are registered. Signatures are only used to narrow the search: a
+	node is only considered a match if it's structurally identical to the node being
+	looked up, so two distinct nodes that happen to share a signature can both be
+	registered.
 */
 struct rl_nodelookup
 {
-	// Number of buckets allocated: node signatures are modulo'd by this capacity to
-	// determine the bucket in which they belong. Capacity never changes once the
-	// nodelookup is initialized.
+	// Number of slots allocated; always a power of two. Signatures are masked by
+	// (capacity - 1) to determine the slot at which probing starts.
 	int32 capacity;
 
-	// Array of buckets: buckets[i] is a pointer to the first rl_nodelookup_item in a
-	// linked list that contains all nodes which hash to that bucket.
-	rl_nodelookup_item** buckets;
+	// Number of occupied slots
+	int32 size;
+
+	// Flat array of slots, indexed [0..capacity)
+	rl_nodelookup_item* items;
 };
 
-// Initializes a new nodelookup with the given number of buckets, each of which is the
-// head of a linked list. You must call rl_nodelookup_free when done with the
-// nodelookup.
+// Initializes a new nodelookup with at least the given number of slots (rounded up to
+// a power of two), all initially empty. You must call rl_nodelookup_free when done
+// with the nodelookup.
 void rl_nodelookup_init(rl_nodelookup& nodelookup, int32 capacity);
 
-// Frees all memory allocated by the nodelookup, traversing the linked list in each
-// bucket to ensure that all items are freed.
+// Frees all memory allocated by the nodelookup.
 void rl_nodelookup_free(rl_nodelookup& nodelookup);
 
-// Inserts an item into the lookup, given its hash and the node_index value to
-// associate with that hash. In the event of a hash collision, ignores the new item,
-// silently refusing to insert it into the lookup.
+// Inserts an item into the lookup, given its signature and the node_index value to
+// associate with that signature, growing the table if necessary. Callers should only
+// insert nodes for which rl_nodelookup_find has found no equivalent.
 void rl_nodelookup_insert(rl_nodelookup& nodelookup, uint64 signature, int32 node_index);
 
-// Searches for an item that was previously inserted using the given hash. If such an
-// item exists, returns the node_index that was stored. Otherwise, returns -1.
-int32 rl_nodelookup_find(const rl_nodelookup& nodelookup, uint64 signature);
+// Searches for a previously-inserted node that's structurally identical to the given
+// node, whose signature must be passed in. Registered node indices are resolved
+// against the given nodearray. If such a node exists, returns its index. Otherwise,
+// returns -1.
+int32 rl_nodelookup_find(const rl_nodelookup& nodelookup, const rl_nodearray& nodearray, const rl_node& node, uint64 signature);
+
+// Removes the item registering the given node index, whose signature (as passed to
+// rl_nodelookup_insert) must be supplied. Returns false if no such item was found.
+bool rl_nodelookup_remove(rl_nodelookup& nodelookup, uint64 signature, int32 node_index);
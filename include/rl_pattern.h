@@ -0,0 +1,84 @@
+#pragma once
+
+#include "rl_types.h"
+
+struct rl_dawg;
+struct rl_rack;
+struct rl_search_stats;
+
+// Maximum number of elements in a compiled pattern: a pattern can't usefully describe
+// more letters than a word can hold
+static const int32 RL_PATTERN_MAX_ELEMENTS = static_cast<int32>(RL_MAX_WORD_LEN);
+
+/*
+	A wildcard pattern describing a set of words, for querying a DAWG directly rather
+	than searching for moves on a board. Patterns are written as a sequence of
+	elements, each matching either exactly one letter or a run of letters:
+
+	- 'a' through 'z' matches that letter
+	- '?' matches any one letter
+	- '[aeiou]' matches any one of the listed letters, and '[^aeiou]' any letter but
+	  those; ranges such as '[a-m]' may be used in either form
+	- '*' matches any run of zero or more letters
+
+	e.g. "c?t*" matches "cat", "cots" and "cuttlefish", and "?q?????" matches every
+	7-letter word with a 'q' in its second position.
+
+	A pattern is matched against the DAWG by walking the DAWG once, tracking every
+	element that the letters so far could have brought us to, so that each word is
+	visited (and reported) once however many ways the pattern can match it. The
+	tables below are derived from the elements by rl_pattern_compile, and let the
+	walk skip any branch of the DAWG whose node summary rules out every word below it.
+*/
+struct rl_pattern
+{
+	// Letters matched by each element, as a mask with bit i set for letter 'a' + i
+	uint32 element_letters[RL_PATTERN_MAX_ELEMENTS];
+
+	// Mask with bit i set if element i is a gap, matching a run of zero or more of its
+	// letters rather than exactly one
+	uint64 gaps;
+
+	// Number of elements in the pattern
+	int32 num_elements;
+
+	// For each letter, the elements that match exactly one instance of it, and the gap
+	// elements that can consume it and still match more
+	uint64 advance[26];
+	uint64 stay[26];
+
+	// Indexed by element: the fewest letters it takes to match the rest of the pattern
+	// from that element on, whether there's a gap anywhere from there on (so that there
+	// is no most), and the letters that any match of the rest of the pattern must use
+	uint8 min_remaining[RL_PATTERN_MAX_ELEMENTS + 1];
+	bool gap_remaining[RL_PATTERN_MAX_ELEMENTS + 1];
+	uint32 required_letters[RL_PATTERN_MAX_ELEMENTS + 1];
+
+	// Number of each letter given by single-letter elements: with a rack, these letters
+	// are taken as already being on the board, and every other letter must come from
+	// the rack
+	uint8 fixed_counts[26];
+};
+
+// Called once per matching word, with the word's letters and length; the word buffer
+// is only valid for the duration of the call. Return true to continue the query, or
+// false to stop it.
+typedef bool (*rl_pattern_visit_fn)(const uint8* word, int32 word_len, void* user_data);
+
+// Compiles a pattern from a null-terminated string in the syntax above. Returns false
+// (leaving the pattern empty) if the string is malformed, or has more elements than
+// RL_PATTERN_MAX_ELEMENTS.
+bool rl_pattern_compile(rl_pattern& pattern, const char* s);
+
+// Returns true if the given word matches the pattern.
+bool rl_pattern_test(const rl_pattern& pattern, const uint8* word, int32 word_len);
+
+// Finds every word in a frozen (or packed) DAWG or GADDAG that matches the pattern,
+// calling visit for each in alphabetical order. A pattern that starts with a gap has to
+// try nearly every path through a DAWG; a GADDAG instead matches such a pattern backward
+// (unless it also ends with a gap), reporting words in order of the reversed word. If a
+// rack is given, only words that can be played from the rack are reported, taking every
+// letter not given by a single-letter element of the pattern from the rack. Returns the
+// number of words reported, including the word for which visit returned false, if any.
+// Node visit counts are added to stats, if given.
+int32 rl_pattern_match(const rl_dawg& dawg, const rl_pattern& pattern, const rl_rack* rack, rl_pattern_visit_fn visit, void* user_data, rl_search_stats* stats = nullptr);
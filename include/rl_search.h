@@ -1,11 +1,134 @@
 #pragma once
 
 #include "rl_types.h"
+#include "rl_rack.h"
+#include "rl_move.h"
 
 struct rl_dawg;
-struct rl_rack;
 struct rl_board;
-struct rl_move;
 
-int32 rl_search_board(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move);
-int32 rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_move& move);
+// Counts of the work done by a search, independent of the machine it runs on
+struct rl_search_stats
+{
+	// Number of DAWG nodes whose edges were considered while building suffixes
+	uint64 num_nodes_visited;
+
+	// Number of DAWG nodes skipped without considering their edges, because their summary showed that no word below
+	// them could fit the board or be spelled from the rack
+	uint64 num_nodes_pruned;
+
+	// Number of DAWG nodes skipped by rl_search_board_best_score, because no move below them could score more than the
+	// best move already found
+	uint64 num_nodes_bounded;
+
+	// Optional array with one counter per DAWG node index, incremented each time a search expands that node's edges
+	// (while building prefixes as well as suffixes). The caller owns the array, which is left as nullptr by
+	// rl_search_stats_init; the counts may be passed to rl_dawg_reorder as node weights.
+	uint32* node_visits;
+};
+
+void rl_search_stats_init(rl_search_stats& stats);
+
+// Maximum number of threads used by rl_search_board_parallel
+static const int32 RL_SEARCH_MAX_THREADS = 64;
+
+// Each search accepts an optional rl_search_stats, to which the counts for that search are added.
+int32 rl_search_board(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, rl_search_stats* stats = nullptr);
+int32 rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_move& move, rl_search_stats* stats = nullptr);
+
+// Finds the highest-scoring legal move on the board, as scored by rl_board_score_move, and returns its score (or -1 if
+// there are no legal moves); of equally scoring moves, the first found is kept. The score is kept up to date as each
+// letter is placed, and any branch of the search whose best possible score (with the rest of the rack played on the
+// best premium squares within reach) can't beat the best move found so far is abandoned.
+int32 rl_search_board_best_score(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, rl_search_stats* stats = nullptr);
+
+// A legal move as it's found by a search, before anything has been copied: word points into the search's own buffer,
+// and is only valid for the duration of the call it's passed to. Use rl_move_set to keep a move for later.
+struct rl_move_candidate
+{
+	int32 index;
+	int32 offset;
+	const uint8* word;
+	int32 word_len;
+};
+
+// Called once per legal move found by a visiting search. Return true to continue the search, or false to stop it.
+typedef bool (*rl_search_visit_fn)(const rl_move_candidate& candidate, void* user_data);
+
+// Calls visit for every legal move that rl_search_board or rl_search_segment would consider, in the order the search
+// finds them (which differs between a DAWG and a GADDAG). Returns the number of moves visited, including the move for
+// which visit returned false, if any.
+int32 rl_search_board_visit(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_search_visit_fn visit, void* user_data, rl_search_stats* stats = nullptr);
+int32 rl_search_segment_visit(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_search_visit_fn visit, void* user_data, rl_search_stats* stats = nullptr);
+
+// Copies the first max_moves legal moves found into the caller's buffer, with letters_used filled in, and returns the
+// total number of legal moves, which may be more than max_moves: if so, a larger buffer will hold them all.
+int32 rl_search_board_moves(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move* moves, int32 max_moves, rl_search_stats* stats = nullptr);
+int32 rl_search_segment_moves(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_move* moves, int32 max_moves, rl_search_stats* stats = nullptr);
+
+// Ranks a candidate move for rl_search_board_topk: moves with higher scores are preferred. The rank is computed for
+// every legal move found, before the move is copied anywhere, so it should be cheap.
+typedef int32 (*rl_rank_fn)(const rl_move_candidate& candidate, void* user_data);
+
+// Ranks moves by the length of their word: the ranking used when rl_search_board_topk is given no rank_fn.
+int32 rl_rank_word_len(const rl_move_candidate& candidate, void* user_data);
+
+// Finds the k highest-ranked legal moves on the board, writing them to out_moves (which must hold k moves) from best
+// to worst; of equally ranked moves, the one the search finds first is preferred. Moves that rank no higher than the
+// k-th best found so far are turned away without being copied. Returns the number of moves written, which is less
+// than k only if there are fewer than k legal moves.
+int32 rl_search_board_topk(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 k, rl_rank_fn rank_fn, rl_move* out_moves, void* rank_data = nullptr, rl_search_stats* stats = nullptr);
+
+// Finds the same move as rl_search_board, and returns the same number of legal moves, but searches the board's anchors
+// across up to num_threads threads (including the calling thread). Each anchor is searched as a separate task; threads
+// that run out of tasks steal them from those that haven't, and the moves found by each task are merged in the order
+// rl_search_board would have found them, so the result doesn't depend on the number of threads or their timing. If
+// stats has a node_visits array, the search runs on the calling thread alone.
+int32 rl_search_board_parallel(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, int32 num_threads, rl_search_stats* stats = nullptr);
+
+// Results of rl_search_board_cached for a single row or column of the board.
+struct rl_search_cache_line
+{
+	// Version of the line (from rl_board::row_versions or column_versions) that the results were found at, or 0 if the
+	// line has yet to be searched
+	uint32 version;
+
+	// Number of legal moves in the line, and the move rl_search_board would choose from among them
+	int32 num_legal_moves;
+	rl_move move;
+};
+
+/*
+	Per-line results of board searches with a single rack, kept between calls to rl_search_board_cached. Playing a
+	move only changes the rows and columns that hold the squares it fills or the anchors it updates, and rl_board_write
+	advances the version of just those lines; so a search that follows with the same rack only needs to search the
+	lines whose versions have moved on, and can reuse every other line's results. Searching with a different rack (or
+	lexicon, or board) discards every line's results.
+*/
+struct rl_search_cache
+{
+	// Generation ids of the lexicon and board (from rl_dawg::generation and rl_board::generation), and the rack, that
+	// the cached results were found with
+	uint32 dawg_generation;
+	uint32 board_generation;
+	rl_rack rack;
+
+	// Results for each row of the board, followed by each column
+	int32 num_lines;
+	rl_search_cache_line* lines;
+
+	// Number of lines searched by the last call to rl_search_board_cached, rather than taken from the cache
+	int32 num_lines_searched;
+};
+
+// Initializes an empty cache, with no memory allocated.
+void rl_search_cache_init(rl_search_cache& cache);
+
+// Releases all memory owned by the cache, leaving it empty.
+void rl_search_cache_free(rl_search_cache& cache);
+
+// Finds the same move as rl_search_board, and returns the same number of legal moves, but reuses the results cached
+// for each line of the board that hasn't changed since the last search with the same rack. Between searches the board
+// must only be changed through rl_board_write and rl_board_block_next (or freed and initialized afresh). Node counts
+// are added to stats only for the lines actually searched.
+int32 rl_search_board_cached(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, rl_search_cache& cache, rl_search_stats* stats = nullptr);
@@ -1,5 +1,11 @@
 #pragma once
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "rl_types.h"
+
 #ifndef MIN
 #define MIN(a,b) (((a)<(b))?(a):(b))
 #endif
@@ -11,3 +17,48 @@
 #ifndef COUNT_OF
 #define COUNT_OF(x) ((sizeof(x)/sizeof(0[x])) / ((size_t)(!(sizeof(x) % sizeof(0[x])))))
 #endif
+
+// Returns the number of bits set in x.
+inline int32 rl_popcount(uint32 x)
+{
+#if defined(_MSC_VER)
+	return static_cast<int32>(__popcnt(x));
+#else
+	return __builtin_popcount(x);
+#endif
+}
+
+// Returns the index of the lowest bit set in x, which must be nonzero.
+inline int32 rl_ctz(uint32 x)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, x);
+	return static_cast<int32>(index);
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+// Returns the index of the lowest bit set in x, which must be nonzero.
+inline int32 rl_ctz64(uint64 x)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return static_cast<int32>(index);
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+// Hints that the memory at the given address will be read soon, so that it can be
+// fetched into cache while other work proceeds.
+inline void rl_prefetch(const void* address)
+{
+#if defined(_MSC_VER)
+	_mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0);
+#else
+	__builtin_prefetch(address);
+#endif
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+
+#include "rl_types.h"
+
+/*
+	Location of a single word within an rl_wordlist's buffer.
+*/
+struct rl_wordlist_entry
+{
+	// Offset of the word's first letter in the buffer
+	uint32 offset;
+
+	// Number of letters in the word
+	int32 len;
+};
+
+/*
+	In-memory list of words, packed end-to-end into a single buffer, with a separate
+	array of entries recording where each word begins. Words can be appended in any
+	order, then sorted into lexicographical order (with duplicates removed) so that
+	they can be fed to rl_dawg_ctx_add.
+*/
+struct rl_wordlist
+{
+	// Letters of every word, with no separators
+	uint8* buf;
+	size_t buf_size;
+	size_t buf_capacity;
+
+	// One entry per word, in the order the words were appended (or sorted order, after
+	// rl_wordlist_sort)
+	rl_wordlist_entry* entries;
+	int32 num_entries;
+	int32 entries_capacity;
+};
+
+// Initializes an empty wordlist, optionally reserving enough room for buf_capacity
+// bytes of letters. You must call rl_wordlist_free when done.
+void rl_wordlist_init(rl_wordlist& wordlist, size_t buf_capacity);
+
+// Releases all memory owned by the wordlist.
+void rl_wordlist_free(rl_wordlist& wordlist);
+
+// Removes all words from the wordlist, keeping its memory for reuse.
+void rl_wordlist_clear(rl_wordlist& wordlist);
+
+// Appends a copy of the given word to the end of the list.
+void rl_wordlist_append(rl_wordlist& wordlist, const uint8* word, int32 word_len);
+
+// Returns the number of bytes that sorting the wordlist in its current state will
+// require, including the scratch space used by rl_wordlist_sort.
+size_t rl_wordlist_sort_size(const rl_wordlist& wordlist);
+
+// Sorts the wordlist's entries into lexicographical order (with a word always sorting
+// before any longer word that it prefixes), then discards duplicate words. Uses an
+// MSD radix sort over the letters of each word, falling back to insertion sort for
+// small buckets. Every word must consist only of the letters 'a' through 'z', plus
+// RL_GADDAG_SEPARATOR (which sorts after 'z').
+void rl_wordlist_sort(rl_wordlist& wordlist);
+
+// Returns a pointer to the letters of the word at the given index.
+inline const uint8* rl_wordlist_word(const rl_wordlist& wordlist, int32 index)
+{
+	return wordlist.buf + wordlist.entries[index].offset;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "rl_types.h"
+
+// Number of bytes requested from the underlying file descriptor per read
+static const int32 RL_WORDREADER_BLOCK_SIZE = 1 << 20;
+
+/*
+	Streaming reader that splits a word list into whitespace-delimited words, without
+	copying them: each word is returned as a pointer into the reader's buffer, which
+	remains valid until the next call to rl_wordreader_next.
+
+	The input is read from a file descriptor in large blocks. Each block is scanned 64
+	bytes at a time (using SSE2 where available), producing a pair of bitmasks that
+	flag which bytes are whitespace and which bytes are neither whitespace nor a
+	lowercase letter 'a' through 'z'. Word boundaries are then found by scanning those
+	bitmasks, and every word is validated in bulk as a side effect.
+*/
+struct rl_wordreader
+{
+	// File descriptor from which the word list is read
+	int fd;
+
+	// Whether the reader opened fd itself, and should close it when freed
+	bool owns_fd;
+
+	// Whether the file descriptor has been read to the end
+	bool eof;
+
+	// Whether a read from the file descriptor failed, cutting the input short: set along
+	// with eof, so that the reader returns no more words
+	bool error;
+
+	// Buffer holding the bytes read so far, plus trailing padding
+	uint8* buf;
+	int32 buf_capacity;
+
+	// Number of valid bytes in the buffer
+	int32 buf_size;
+
+	// Offset in the buffer at which scanning will resume
+	int32 pos;
+
+	// Offset of the 64-byte chunk whose bitmasks are currently cached, or -1
+	int32 chunk_start;
+
+	// For each byte in the current chunk: whitespace bits, and bits for bytes that
+	// can't appear in a valid word
+	uint64 chunk_space_bits;
+	uint64 chunk_invalid_bits;
+};
+
+// Initializes a reader that pulls from an existing file descriptor (e.g. 0 for stdin).
+// The reader does not take ownership of the descriptor. You must call
+// rl_wordreader_free when done.
+void rl_wordreader_init(rl_wordreader& reader, int fd);
+
+// Opens the file at the given path and initializes a reader for it. Returns false if
+// the file could not be opened, in which case the reader needn't be freed.
+bool rl_wordreader_open(rl_wordreader& reader, const char* path);
+
+// Frees the reader's buffer, closing its file descriptor if the reader opened it.
+void rl_wordreader_free(rl_wordreader& reader);
+
+// Advances to the next word in the input. Returns false once the input is exhausted, or
+// if a read fails (in which case reader.error is set, and the input should be discarded).
+// Otherwise, out_word and out_word_len describe the word, and out_valid indicates
+// whether it consists only of the letters 'a' through 'z'.
+bool rl_wordreader_next(rl_wordreader& reader, const uint8*& out_word, int32& out_word_len, bool& out_valid);
+
+// Returns the size in bytes of the file behind the given descriptor, if it's a regular
+// file, or 0 if the size can't be determined in advance (e.g. for a pipe).
+size_t rl_wordreader_file_size(int fd);
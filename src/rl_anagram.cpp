@@ -0,0 +1,357 @@
+#include "rl_anagram.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include "rl_util.h"
+#include "rl_dawg.h"
+#include "rl_rack.h"
+
+// A word's signature during the build: its letter ranks, each plus one and in ascending order, padded with zeroes so
+// that signatures sort with every prefix of a signature ahead of it
+struct _rl_anagram_entry
+{
+	uint8 key[RL_MAX_WORD_LEN];
+	int32 word_id;
+};
+
+struct _rl_anagram_build_ctx
+{
+	const rl_dawg* dawg;
+	rl_anagram_index* index;
+	_rl_anagram_entry* entries;
+	int32 num_entries;
+	uint8 word[RL_MAX_WORD_LEN];
+	int32 next_node;
+	int32* entry_begin;
+};
+
+struct _rl_anagram_query_ctx
+{
+	const rl_anagram_index* index;
+	uint8 counts[26];
+	uint32 ranks;
+	rl_anagram_visit_fn visit;
+	void* user_data;
+	int32 num_found;
+	bool stopped;
+};
+
+static int _rl_anagram_compare_entries(const void* lhs, const void* rhs)
+{
+	const _rl_anagram_entry& a = *reinterpret_cast<const _rl_anagram_entry*>(lhs);
+	const _rl_anagram_entry& b = *reinterpret_cast<const _rl_anagram_entry*>(rhs);
+	const int cmp = memcmp(a.key, b.key, sizeof(a.key));
+	if (cmp != 0)
+	{
+		return cmp;
+	}
+	return a.word_id < b.word_id ? -1 : (a.word_id > b.word_id ? 1 : 0);
+}
+
+static int32 _rl_anagram_key_len(const _rl_anagram_entry& entry)
+{
+	int32 len = 0;
+	while (len < static_cast<int32>(RL_MAX_WORD_LEN) && entry.key[len] != 0)
+	{
+		len++;
+	}
+	return len;
+}
+
+static void _rl_anagram_rank_letters(rl_anagram_index& index, const rl_dawg& dawg)
+{
+	// Order letters from the rarest to the most common, breaking ties alphabetically: a simple insertion sort suffices
+	for (int32 ordinal = 0; ordinal < 26; ordinal++)
+	{
+		int32 rank = ordinal;
+		while (rank > 0 && dawg.distribution.weights[index.rank_letters[rank - 1]] > dawg.distribution.weights[ordinal])
+		{
+			index.rank_letters[rank] = index.rank_letters[rank - 1];
+			rank--;
+		}
+		index.rank_letters[rank] = static_cast<uint8>(ordinal);
+	}
+	for (int32 rank = 0; rank < 26; rank++)
+	{
+		index.letter_ranks[index.rank_letters[rank]] = static_cast<uint8>(rank);
+	}
+}
+
+static void _rl_anagram_collect(_rl_anagram_build_ctx& ctx, int32 node_index, int32 word_len)
+{
+	// Visit every word in the DAWG in alphabetical order, i.e. in order of their IDs, recording each one's signature
+	const rl_dawg& dawg = *ctx.dawg;
+	const uint32 node_mask = rl_dawg_node_mask(dawg, node_index);
+	uint32 remaining = node_mask;
+	while (remaining != 0)
+	{
+		const uint32 ordinal = static_cast<uint32>(rl_ctz(remaining));
+		remaining &= remaining - 1;
+		const rl_edge edge = rl_dawg_node_edge(dawg, node_index, node_mask, ordinal);
+		ctx.word[word_len] = static_cast<uint8>(ordinal);
+		if (rl_edge_is_word(edge))
+		{
+			// Counting sort of the word's letters by rank
+			uint8 counts[26];
+			memset(counts, 0, sizeof(counts));
+			for (int32 letter_index = 0; letter_index <= word_len; letter_index++)
+			{
+				counts[ctx.index->letter_ranks[ctx.word[letter_index]]]++;
+			}
+			_rl_anagram_entry& entry = ctx.entries[ctx.num_entries];
+			memset(entry.key, 0, sizeof(entry.key));
+			int32 key_len = 0;
+			for (int32 rank = 0; rank < 26; rank++)
+			{
+				for (int32 i = 0; i < counts[rank]; i++)
+				{
+					entry.key[key_len++] = static_cast<uint8>(rank + 1);
+				}
+			}
+			entry.word_id = ctx.num_entries++;
+		}
+		_rl_anagram_collect(ctx, rl_edge_node_index(edge), word_len + 1);
+	}
+}
+
+static void _rl_anagram_build_node(_rl_anagram_build_ctx& ctx, int32 node_index, int32 lo, int32 hi, int32 depth)
+{
+	// Entries [lo, hi) share their first depth letters, which are the path to this node: those that end here come
+	// first, and the rest are grouped by their next letter, one group per child
+	rl_anagram_index& index = *ctx.index;
+	int32 begin = lo;
+	while (begin < hi && (depth == static_cast<int32>(RL_MAX_WORD_LEN) || ctx.entries[begin].key[depth] == 0))
+	{
+		begin++;
+	}
+	// Note where this node's words lie among the sorted entries for now: once every node is numbered, they're moved
+	// into node order
+	ctx.entry_begin[node_index] = lo;
+	index.word_begin[node_index + 1] = begin - lo;
+	if (begin > lo)
+	{
+		index.num_signatures++;
+	}
+
+	// Allocate all of the node's children together, so that they're contiguous, before building any of them
+	uint32 mask = 0;
+	for (int32 i = begin; i < hi; i++)
+	{
+		mask |= 1u << (ctx.entries[i].key[depth] - 1);
+	}
+	index.child_masks[node_index] = mask;
+	index.first_child[node_index] = ctx.next_node;
+	int32 child_index = ctx.next_node;
+	ctx.next_node += rl_popcount(mask);
+
+	int32 group_begin = begin;
+	while (group_begin < hi)
+	{
+		int32 group_end = group_begin + 1;
+		while (group_end < hi && ctx.entries[group_end].key[depth] == ctx.entries[group_begin].key[depth])
+		{
+			group_end++;
+		}
+		_rl_anagram_build_node(ctx, child_index++, group_begin, group_end, depth + 1);
+		group_begin = group_end;
+	}
+}
+
+static void _rl_anagram_report(_rl_anagram_query_ctx& ctx, int32 node_index, int32 word_len)
+{
+	const rl_anagram_index& index = *ctx.index;
+	for (int32 i = index.word_begin[node_index]; i < index.word_begin[node_index + 1] && !ctx.stopped; i++)
+	{
+		ctx.num_found++;
+		if (!ctx.visit(index.word_ids[i], word_len, ctx.user_data))
+		{
+			ctx.stopped = true;
+		}
+	}
+}
+
+static int32 _rl_anagram_child(const rl_anagram_index& index, int32 node_index, uint32 rank)
+{
+	return index.first_child[node_index] + rl_popcount(index.child_masks[node_index] & ((1u << rank) - 1));
+}
+
+static void _rl_anagram_walk(_rl_anagram_query_ctx& ctx, int32 node_index, int32 depth)
+{
+	// Every child of this node is labeled with a letter no rarer than the one that led here, so each sub-multiset of
+	// the rack is spelled by at most one path: we only need to follow the children for letters still in the rack
+	const rl_anagram_index& index = *ctx.index;
+	_rl_anagram_report(ctx, node_index, depth);
+	uint32 playable = index.child_masks[node_index] & ctx.ranks;
+	while (playable != 0 && !ctx.stopped)
+	{
+		const uint32 rank = static_cast<uint32>(rl_ctz(playable));
+		playable &= playable - 1;
+		if (--ctx.counts[rank] == 0)
+		{
+			ctx.ranks &= ~(1u << rank);
+		}
+		_rl_anagram_walk(ctx, _rl_anagram_child(index, node_index, rank), depth + 1);
+		ctx.counts[rank]++;
+		ctx.ranks |= 1u << rank;
+	}
+}
+
+void rl_anagram_init(rl_anagram_index& index)
+{
+	memset(&index, 0, sizeof(index));
+}
+
+void rl_anagram_free(rl_anagram_index& index)
+{
+	free(index.data);
+	rl_anagram_init(index);
+}
+
+int32 rl_anagram_build(rl_anagram_index& index, const rl_dawg& dawg)
+{
+	assert(dawg.data);
+	assert(!dawg.is_gaddag);
+	rl_anagram_free(index);
+	_rl_anagram_rank_letters(index, dawg);
+
+	// Gather every word's signature, then sort them so that words sharing a signature (or a prefix of one) are adjacent
+	_rl_anagram_build_ctx ctx;
+	ctx.dawg = &dawg;
+	ctx.index = &index;
+	ctx.entries = reinterpret_cast<_rl_anagram_entry*>(malloc(MAX(dawg.num_words, 1) * sizeof(_rl_anagram_entry)));
+	assert(ctx.entries);
+	ctx.num_entries = 0;
+	_rl_anagram_collect(ctx, 0, 0);
+	assert(ctx.num_entries == dawg.num_words);
+	qsort(ctx.entries, ctx.num_entries, sizeof(_rl_anagram_entry), _rl_anagram_compare_entries);
+
+	// Each signature adds a node for every letter past the prefix it shares with the one before it
+	int32 num_nodes = 1;
+	for (int32 i = 0; i < ctx.num_entries; i++)
+	{
+		const int32 key_len = _rl_anagram_key_len(ctx.entries[i]);
+		int32 shared_len = 0;
+		if (i > 0)
+		{
+			while (shared_len < key_len && ctx.entries[i].key[shared_len] == ctx.entries[i - 1].key[shared_len])
+			{
+				shared_len++;
+			}
+		}
+		num_nodes += key_len - shared_len;
+	}
+
+	// Lay out all arrays in a single allocation
+	const size_t masks_size = num_nodes * sizeof(uint32);
+	const size_t first_child_size = num_nodes * sizeof(int32);
+	const size_t word_begin_size = (num_nodes + 1) * sizeof(int32);
+	const size_t ids_size = ctx.num_entries * sizeof(int32);
+	uint8* data = reinterpret_cast<uint8*>(malloc(masks_size + first_child_size + word_begin_size + ids_size));
+	assert(data);
+	index.data = data;
+	index.child_masks = reinterpret_cast<uint32*>(data);
+	index.first_child = reinterpret_cast<int32*>(data + masks_size);
+	index.word_begin = reinterpret_cast<int32*>(data + masks_size + first_child_size);
+	index.word_ids = reinterpret_cast<int32*>(data + masks_size + first_child_size + word_begin_size);
+	index.num_nodes = num_nodes;
+	index.num_words = ctx.num_entries;
+	index.num_signatures = 0;
+
+	// Build the trie, counting each node's words, then total up the counts to find where each node's words begin
+	ctx.entry_begin = reinterpret_cast<int32*>(malloc(num_nodes * sizeof(int32)));
+	assert(ctx.entry_begin);
+	ctx.next_node = 1;
+	_rl_anagram_build_node(ctx, 0, 0, ctx.num_entries, 0);
+	assert(ctx.next_node == num_nodes);
+	index.word_begin[0] = 0;
+	for (int32 node_index = 0; node_index < num_nodes; node_index++)
+	{
+		const int32 num_node_words = index.word_begin[node_index + 1];
+		index.word_begin[node_index + 1] = index.word_begin[node_index] + num_node_words;
+		for (int32 i = 0; i < num_node_words; i++)
+		{
+			index.word_ids[index.word_begin[node_index] + i] = ctx.entries[ctx.entry_begin[node_index] + i].word_id;
+		}
+	}
+	free(ctx.entry_begin);
+	free(ctx.entries);
+	return index.num_words;
+}
+
+size_t rl_anagram_num_bytes(const rl_anagram_index& index)
+{
+	if (!index.data)
+	{
+		return 0;
+	}
+	return index.num_nodes * (sizeof(uint32) + sizeof(int32)) + (index.num_nodes + 1) * sizeof(int32) + index.num_words * sizeof(int32);
+}
+
+int32 rl_anagram_find(const rl_anagram_index& index, const uint8* letters, int32 num_letters, rl_anagram_visit_fn visit, void* user_data)
+{
+	assert(index.data);
+
+	// Count the letters, then spell out their signature from the root, rarest letters first
+	if (num_letters > static_cast<int32>(RL_MAX_WORD_LEN))
+	{
+		return 0;
+	}
+	uint8 counts[26];
+	memset(counts, 0, sizeof(counts));
+	for (int32 letter_index = 0; letter_index < num_letters; letter_index++)
+	{
+		const uint32 ordinal = static_cast<uint32>(letters[letter_index] - 'a');
+		if (ordinal >= 26)
+		{
+			return 0;
+		}
+		counts[index.letter_ranks[ordinal]]++;
+	}
+	int32 node_index = 0;
+	for (uint32 rank = 0; rank < 26; rank++)
+	{
+		for (int32 i = 0; i < counts[rank]; i++)
+		{
+			if ((index.child_masks[node_index] & (1u << rank)) == 0)
+			{
+				return 0;
+			}
+			node_index = _rl_anagram_child(index, node_index, rank);
+		}
+	}
+
+	_rl_anagram_query_ctx ctx;
+	ctx.index = &index;
+	ctx.visit = visit;
+	ctx.user_data = user_data;
+	ctx.num_found = 0;
+	ctx.stopped = false;
+	_rl_anagram_report(ctx, node_index, num_letters);
+	return ctx.num_found;
+}
+
+int32 rl_anagram_find_sub(const rl_anagram_index& index, const rl_rack& rack, rl_anagram_visit_fn visit, void* user_data)
+{
+	assert(index.data);
+
+	_rl_anagram_query_ctx ctx;
+	ctx.index = &index;
+	ctx.ranks = 0;
+	for (int32 ordinal = 0; ordinal < 26; ordinal++)
+	{
+		const uint8 rank = index.letter_ranks[ordinal];
+		ctx.counts[rank] = rack.counts[ordinal];
+		if (rack.counts[ordinal] > 0)
+		{
+			ctx.ranks |= 1u << rank;
+		}
+	}
+	ctx.visit = visit;
+	ctx.user_data = user_data;
+	ctx.num_found = 0;
+	ctx.stopped = false;
+	_rl_anagram_walk(ctx, 0, 0);
+	return ctx.num_found;
+}
@@ -3,11 +3,86 @@
 #include <cstdlib>
 #include <cassert>
 #include <cstring>
+#include <atomic>
 
 #include "rl_util.h"
 #include "rl_dawg.h"
-#include "rl_node.h"
-#include "rl_edgemap.h"
+
+// Source of each board's generation id; starts at 1 so that 0 never matches an initialized board
+static std::atomic<uint32> _rl_board_next_generation(1);
+
+// Standard English tile values, from 'a' to 'z'
+static const uint8 RL_STANDARD_LETTER_VALUES[26] = { 1, 3, 3, 2, 1, 4, 2, 4, 1, 8, 5, 1, 3, 1, 1, 3, 10, 1, 1, 1, 1, 4, 4, 8, 4, 10 };
+
+// Premium squares of a standard 15x15 board: 'T' and 'D' triple and double the word, 't' and 'd' the letter
+static const char* RL_STANDARD_PREMIUMS[15] = {
+	"T..d...T...d..T",
+	".D...t...t...D.",
+	"..D...d.d...D..",
+	"d..D...d...D..d",
+	"....D.....D....",
+	".t...t...t...t.",
+	"..d...d.d...d..",
+	"T..d...D...d..T",
+	"..d...d.d...d..",
+	".t...t...t...t.",
+	"....D.....D....",
+	"d..D...d...D..d",
+	"..D...d.d...D..",
+	".D...t...t...D.",
+	"T..d...T...d..T",
+};
+
+static void _rl_board_set_anchor_bit(uint64* line_bits, uint64* summary, int32 line_index, int32 line_words, int32 bit_index)
+{
+	line_bits[line_index * line_words + bit_index / 64] |= 1ULL << (bit_index % 64);
+	summary[line_index / 64] |= 1ULL << (line_index % 64);
+}
+
+static void _rl_board_clear_anchor_bit(uint64* line_bits, uint64* summary, int32 line_index, int32 line_words, int32 bit_index)
+{
+	// Once the line has no anchors left, drop it from the summary so that searches skip it entirely
+	uint64* line = line_bits + line_index * line_words;
+	line[bit_index / 64] &= ~(1ULL << (bit_index % 64));
+	for (int32 word_index = 0; word_index < line_words; word_index++)
+	{
+		if (line[word_index] != 0)
+		{
+			return;
+		}
+	}
+	summary[line_index / 64] &= ~(1ULL << (line_index % 64));
+}
+
+static void _rl_board_add_anchor(rl_board& board, int32 index)
+{
+	int32 x;
+	int32 y;
+	rl_board_coord(board, index, x, y);
+	_rl_board_set_anchor_bit(board.anchor_rows, board.anchor_row_summary, y, board.anchor_row_words, x);
+	_rl_board_set_anchor_bit(board.anchor_columns, board.anchor_column_summary, x, board.anchor_column_words, y);
+	board.num_anchors++;
+}
+
+static void _rl_board_remove_anchor(rl_board& board, int32 index)
+{
+	int32 x;
+	int32 y;
+	rl_board_coord(board, index, x, y);
+	_rl_board_clear_anchor_bit(board.anchor_rows, board.anchor_row_summary, y, board.anchor_row_words, x);
+	_rl_board_clear_anchor_bit(board.anchor_columns, board.anchor_column_summary, x, board.anchor_column_words, y);
+	board.num_anchors--;
+}
+
+static void _rl_board_touch(rl_board& board, int32 index)
+{
+	// Note that the row and column through this square have changed as of the current version of the board
+	int32 x;
+	int32 y;
+	rl_board_coord(board, index, x, y);
+	board.row_versions[y] = board.version;
+	board.column_versions[x] = board.version;
+}
 
 static void _rl_board_clear(rl_board& board)
 {
@@ -28,11 +103,31 @@ static void _rl_board_clear(rl_board& board)
 		board.blockflags[row_start + board.size_x - 1] |= RL_BLOCKFLAG_NEXT_ACROSS;
 	}
 
-	// Initialize the checkbits for all squares to allow any combination of letters
+	// Initialize the checkbits for all squares to allow any combination of letters, with no cross words to score
 	for (int32 i = 0; i < num_squares; i++)
 	{
 		board.checkbits_x[i] = RL_CHECKBITS_ANY;
 		board.checkbits_y[i] = RL_CHECKBITS_ANY;
+		board.cross_sums_x[i] = -1;
+		board.cross_sums_y[i] = -1;
+	}
+
+	// With no letters on the board, there are no anchors
+	board.num_anchors = 0;
+	memset(board.anchor_rows, 0, board.size_y * board.anchor_row_words * sizeof(uint64));
+	memset(board.anchor_columns, 0, board.size_x * board.anchor_column_words * sizeof(uint64));
+	memset(board.anchor_row_summary, 0, ((board.size_y + 63) / 64) * sizeof(uint64));
+	memset(board.anchor_column_summary, 0, ((board.size_x + 63) / 64) * sizeof(uint64));
+
+	// Every line starts out at the board's first version
+	board.version = 1;
+	for (int32 y = 0; y < board.size_y; y++)
+	{
+		board.row_versions[y] = board.version;
+	}
+	for (int32 x = 0; x < board.size_x; x++)
+	{
+		board.column_versions[x] = board.version;
 	}
 }
 
@@ -53,8 +148,12 @@ static int32 _rl_board_flag_dirty_anchor(rl_board& board, int32 from_index, int3
 		const int32 next_index = index + search_dir_offset;
 		if (board.letters[next_index] == RL_BLANK || board.letters[next_index] == RL_ANCHOR)
 		{
-			// Flag the square as an anchor
-			board.letters[next_index] = RL_ANCHOR;
+			// Flag the square as an anchor, adding it to the anchor index if it's new
+			if (board.letters[next_index] == RL_BLANK)
+			{
+				board.letters[next_index] = RL_ANCHOR;
+				_rl_board_add_anchor(board, next_index);
+			}
 
 			// Push the index of that square into the array we've been given, and return the upated array size
 			assert(index_array_size < index_array_capacity);
@@ -81,7 +180,7 @@ static bool _rl_board_is_letter(const rl_board& board, int32 index)
 	return false;
 }
 
-static bool _rl_board_check_suffix(const rl_dawg& dawg, int32 node_index, const rl_board& board, int32 anchor_index, int32 offset, int32 suffix_len)
+static bool _rl_board_check_suffix(const rl_dawg& dawg, rl_edge edge, const rl_board& board, int32 anchor_index, int32 offset, int32 suffix_len)
 {
 	// Iterate through the letters of the suffix on the board, starting from the right of the anchor
 	for (int32 depth = 1; depth <= suffix_len; depth++)
@@ -92,23 +191,65 @@ static bool _rl_board_check_suffix(const rl_dawg& dawg, int32 node_index, const
 		const uint8 letter = board.letters[suffix_letter_index];
 
 		// Find an edge from the current DAWG node labeled with that letter
-		const rl_node& node = dawg.nodearray.items[node_index];
-		node_index = rl_edgemap_find(node.next_by_letter, letter);
+		edge = rl_dawg_find_edge(dawg, rl_edge_node_index(edge), letter);
 
 		// If there's no such letter, then we can't build a word off of the prefix node using this suffix
-		if (node_index < 0)
+		if (edge == RL_EDGE_NONE)
 		{
 			return false;
 		}
 	}
 
-	// The suffix works if the node that we've arrived at (or the prefix itself, in the case of no suffix) forms a valid word
-	return dawg.nodearray.items[node_index].is_word;
+	// The suffix works if the edge that we've arrived at (or the edge for the anchor itself, in the case of no suffix) forms a valid word
+	return rl_edge_is_word(edge);
 }
 
-static uint32 _rl_board_resolve_checkbits(const rl_dawg& dawg, const rl_board& board, int32 anchor_index, int32 offset, uint8 blockflag_prev, uint8 blockflag_next)
+static uint32 _rl_board_resolve_checkbits_gaddag(const rl_dawg& dawg, const rl_board& board, int32 anchor_index, int32 offset, int32 prefix_len, int32 suffix_len)
 {
-	// Search in either direction above and below our anchor to figure out the length of any existing words adjacent to it
+	// In a GADDAG, every word that passes through the anchor square can be found by starting from the letter at the
+	// anchor itself: for each such letter L, we walk back through the prefix in reverse, then cross the separator
+	// and walk forward through the suffix
+	uint32 value = 0;
+	const uint32 root_mask = rl_dawg_node_mask(dawg, 0);
+	for (uint32 letters = root_mask; letters != 0; letters &= letters - 1)
+	{
+		const uint32 ordinal = static_cast<uint32>(rl_ctz(letters));
+		assert(ordinal < 26);
+
+		rl_edge edge = rl_dawg_node_edge(dawg, 0, root_mask, ordinal);
+		for (int32 depth = 1; depth <= prefix_len && edge != RL_EDGE_NONE; depth++)
+		{
+			const int32 index = anchor_index - (offset * depth);
+			assert(_rl_board_is_letter(board, index));
+			edge = rl_dawg_find_edge(dawg, rl_edge_node_index(edge), board.letters[index]);
+		}
+		if (edge == RL_EDGE_NONE)
+		{
+			continue;
+		}
+
+		// With no suffix, the reversed prefix must form a complete entry; otherwise the suffix follows the separator
+		if (suffix_len > 0)
+		{
+			edge = rl_dawg_find_edge(dawg, rl_edge_node_index(edge), RL_GADDAG_SEPARATOR);
+			if (edge == RL_EDGE_NONE)
+			{
+				continue;
+			}
+		}
+		if (_rl_board_check_suffix(dawg, edge, board, anchor_index, offset, suffix_len))
+		{
+			value |= (1 << ordinal);
+		}
+	}
+	return value;
+}
+
+static uint32 _rl_board_resolve_checkbits(const rl_dawg& dawg, const rl_board& board, int32 anchor_index, int32 offset, uint8 blockflag_prev, uint8 blockflag_next, int32& out_cross_sum)
+{
+	// Search in either direction above and below our anchor to figure out the length of any existing words adjacent to
+	// it, totting up the value of their letters along the way
+	int32 cross_sum = 0;
 	int32 prefix_len = 0;
 	{
 		int32 index = anchor_index;
@@ -119,6 +260,7 @@ static uint32 _rl_board_resolve_checkbits(const rl_dawg& dawg, const rl_board& b
 			{
 				break;
 			}
+			cross_sum += board.letter_values[board.letters[prev_index] - 'a'];
 			prefix_len++;
 			index = prev_index;
 		}
@@ -134,12 +276,18 @@ static uint32 _rl_board_resolve_checkbits(const rl_dawg& dawg, const rl_board& b
 			{
 				break;
 			}
+			cross_sum += board.letter_values[board.letters[next_index] - 'a'];
 			suffix_len++;
 			index = next_index;
 		}
 	}
+	out_cross_sum = prefix_len > 0 || suffix_len > 0 ? cross_sum : -1;
 
 	// If we have a prefix or a suffix, we need to do a constrained DAWG search for valid words; otherwise any letter is valid here
+	if ((prefix_len > 0 || suffix_len > 0) && dawg.is_gaddag)
+	{
+		return _rl_board_resolve_checkbits_gaddag(dawg, board, anchor_index, offset, prefix_len, suffix_len);
+	}
 	if (prefix_len > 0 || suffix_len > 0)
 	{
 		// Establish our resulting bit vector, with bits representing 'a' thru 'z'
@@ -153,23 +301,22 @@ static uint32 _rl_board_resolve_checkbits(const rl_dawg& dawg, const rl_board& b
 			const uint8 letter = board.letters[index];
 
 			// If the prefix is not contained in the DAWG, no letters can be played here
-			const rl_node& node = dawg.nodearray.items[prefix_node_index];
-			const int32 next_node_index = rl_edgemap_find(node.next_by_letter, letter);
-			if (next_node_index < 0)
+			const rl_edge edge = rl_dawg_find_edge(dawg, prefix_node_index, letter);
+			if (edge == RL_EDGE_NONE)
 			{
 				return 0;
 			}
-			prefix_node_index = next_node_index;
+			prefix_node_index = rl_edge_node_index(edge);
 		}
 
 		// From that node, check each edge (labeled with letter L) leading out of that node to see if (prefix + L + suffix) forms a valid word
-		const rl_node& prefix_node = dawg.nodearray.items[prefix_node_index];
-		for (int32 edge_index = 0; edge_index < prefix_node.next_by_letter.size; edge_index++)
+		const uint32 prefix_mask = rl_dawg_node_mask(dawg, prefix_node_index);
+		for (uint32 letters = prefix_mask; letters != 0; letters &= letters - 1)
 		{
-			const rl_edgemap_item& edge = prefix_node.next_by_letter.items[edge_index];
-			const int32 ordinal = edge.letter - 'a';
-			assert(ordinal >= 0 && ordinal < 26);
-			if (_rl_board_check_suffix(dawg, edge.node_index, board, anchor_index, offset, suffix_len))
+			const uint32 ordinal = static_cast<uint32>(rl_ctz(letters));
+			assert(ordinal < 26);
+			const rl_edge edge = rl_dawg_node_edge(dawg, prefix_node_index, prefix_mask, ordinal);
+			if (_rl_board_check_suffix(dawg, edge, board, anchor_index, offset, suffix_len))
 			{
 				value |= (1 << ordinal);
 			}
@@ -184,8 +331,8 @@ static void _rl_board_recompute_checkbits(const rl_dawg& dawg, rl_board& board,
 {
 	assert(board.letters[anchor_index] == RL_ANCHOR);
 
-	board.checkbits_x[anchor_index] = _rl_board_resolve_checkbits(dawg, board, anchor_index, 1, RL_BLOCKFLAG_PREV_ACROSS, RL_BLOCKFLAG_NEXT_ACROSS);
-	board.checkbits_y[anchor_index] = _rl_board_resolve_checkbits(dawg, board, anchor_index, board.size_x, RL_BLOCKFLAG_PREV_DOWN, RL_BLOCKFLAG_NEXT_DOWN);
+	board.checkbits_x[anchor_index] = _rl_board_resolve_checkbits(dawg, board, anchor_index, 1, RL_BLOCKFLAG_PREV_ACROSS, RL_BLOCKFLAG_NEXT_ACROSS, board.cross_sums_x[anchor_index]);
+	board.checkbits_y[anchor_index] = _rl_board_resolve_checkbits(dawg, board, anchor_index, board.size_x, RL_BLOCKFLAG_PREV_DOWN, RL_BLOCKFLAG_NEXT_DOWN, board.cross_sums_y[anchor_index]);
 }
 
 void rl_board_init(rl_board& board, int32 playable_size_x, int32 playable_size_y)
@@ -198,12 +345,34 @@ void rl_board_init(rl_board& board, int32 playable_size_x, int32 playable_size_y
 	board.blockflags = reinterpret_cast<uint8*>(malloc(num_squares));
 	board.checkbits_x = reinterpret_cast<uint32*>(malloc(num_squares * sizeof(uint32)));
 	board.checkbits_y = reinterpret_cast<uint32*>(malloc(num_squares * sizeof(uint32)));
+	board.cross_sums_x = reinterpret_cast<int32*>(malloc(num_squares * sizeof(int32)));
+	board.cross_sums_y = reinterpret_cast<int32*>(malloc(num_squares * sizeof(int32)));
+	board.letter_multipliers = nullptr;
+	board.word_multipliers = nullptr;
+	memcpy(board.letter_values, RL_STANDARD_LETTER_VALUES, sizeof(board.letter_values));
+	board.anchor_row_words = (board.size_x + 63) / 64;
+	board.anchor_column_words = (board.size_y + 63) / 64;
+	board.anchor_rows = reinterpret_cast<uint64*>(malloc(board.size_y * board.anchor_row_words * sizeof(uint64)));
+	board.anchor_columns = reinterpret_cast<uint64*>(malloc(board.size_x * board.anchor_column_words * sizeof(uint64)));
+	board.anchor_row_summary = reinterpret_cast<uint64*>(malloc(((board.size_y + 63) / 64) * sizeof(uint64)));
+	board.anchor_column_summary = reinterpret_cast<uint64*>(malloc(((board.size_x + 63) / 64) * sizeof(uint64)));
+	board.row_versions = reinterpret_cast<uint32*>(malloc(board.size_y * sizeof(uint32)));
+	board.column_versions = reinterpret_cast<uint32*>(malloc(board.size_x * sizeof(uint32)));
 
 	assert(board.letters);	
 	assert(board.blockflags);
 	assert(board.checkbits_x);
 	assert(board.checkbits_y);
-
+	assert(board.cross_sums_x);
+	assert(board.cross_sums_y);
+	assert(board.anchor_rows);
+	assert(board.anchor_columns);
+	assert(board.anchor_row_summary);
+	assert(board.anchor_column_summary);
+	assert(board.row_versions);
+	assert(board.column_versions);
+
+	board.generation = _rl_board_next_generation++;
 	_rl_board_clear(board);
 }
 
@@ -213,6 +382,16 @@ void rl_board_free(rl_board& board)
 	free(board.blockflags);
 	free(board.checkbits_x);
 	free(board.checkbits_y);
+	free(board.cross_sums_x);
+	free(board.cross_sums_y);
+	free(board.letter_multipliers);
+	free(board.word_multipliers);
+	free(board.anchor_rows);
+	free(board.anchor_columns);
+	free(board.anchor_row_summary);
+	free(board.anchor_column_summary);
+	free(board.row_versions);
+	free(board.column_versions);
 }
 
 int32 rl_board_index(const rl_board& board, int32 playable_x, int32 playable_y)
@@ -250,6 +429,9 @@ void rl_board_write(const rl_dawg& dawg, rl_board& board, int32 start_index, boo
 	int32 dirty_anchors[RL_MAX_WORD_LEN * 2 + 2];
 	int32 num_dirty_anchors = 0;
 
+	// Every line that holds a letter we place or an anchor we update will have changed as of this new version
+	board.version++;
+
 	// Iterate forward from the start index, writing the word into the board letter-by-letter
 	int32 index = start_index;
 	for (int32 letter_index = 0; letter_index < s_len; letter_index++)
@@ -261,8 +443,13 @@ void rl_board_write(const rl_dawg& dawg, rl_board& board, int32 start_index, boo
 		const uint8 existing_letter = board.letters[index];
 		if (existing_letter == RL_BLANK || existing_letter == RL_ANCHOR)
 		{
-			// Copy the letter into the board's letters array
+			// Copy the letter into the board's letters array, taking the square out of the anchor index if it was an anchor
 			board.letters[index] = s[letter_index];
+			if (existing_letter == RL_ANCHOR)
+			{
+				_rl_board_remove_anchor(board, index);
+			}
+			_rl_board_touch(board, index);
 
 			// Search up and down for crosswords, to find the nearest adjacent blank spaces to the space we just updated; these are now anchors and they need their cross-check bits updated
 			num_dirty_anchors = _rl_board_flag_dirty_anchor(board, index, -cross_offset, cross_blockflag_prev, dirty_anchors, num_dirty_anchors, COUNT_OF(dirty_anchors));
@@ -287,6 +474,7 @@ void rl_board_write(const rl_dawg& dawg, rl_board& board, int32 start_index, boo
 	{
 		const int32 dirty_anchor_index = dirty_anchors[array_index];
 		_rl_board_recompute_checkbits(dawg, board, dirty_anchor_index);
+		_rl_board_touch(board, dirty_anchor_index);
 	}
 }
 
@@ -299,4 +487,73 @@ void rl_board_block_next(rl_board& board, int32 index, bool across)
 
 	board.blockflags[index] |= blockflag_next;
 	board.blockflags[next_index] |= blockflag_prev;
+
+	board.version++;
+	_rl_board_touch(board, index);
+	_rl_board_touch(board, next_index);
+}
+
+void rl_board_set_premium(rl_board& board, int32 index, uint8 letter_multiplier, uint8 word_multiplier)
+{
+	assert(index >= 0 && index < board.size_x * board.size_y);
+	assert(letter_multiplier >= 1 && word_multiplier >= 1);
+
+	const int32 num_squares = board.size_x * board.size_y;
+	if (!board.letter_multipliers)
+	{
+		board.letter_multipliers = reinterpret_cast<uint8*>(malloc(num_squares));
+		board.word_multipliers = reinterpret_cast<uint8*>(malloc(num_squares));
+		assert(board.letter_multipliers);
+		assert(board.word_multipliers);
+		memset(board.letter_multipliers, 1, num_squares);
+		memset(board.word_multipliers, 1, num_squares);
+	}
+	board.letter_multipliers[index] = letter_multiplier;
+	board.word_multipliers[index] = word_multiplier;
+}
+
+void rl_board_set_standard_premiums(rl_board& board)
+{
+	for (int32 y = 0; y < board.size_y; y++)
+	{
+		for (int32 x = 0; x < board.size_x; x++)
+		{
+			const char premium = RL_STANDARD_PREMIUMS[y % 15][x % 15];
+			const uint8 letter_multiplier = premium == 't' ? 3 : (premium == 'd' ? 2 : 1);
+			const uint8 word_multiplier = premium == 'T' ? 3 : (premium == 'D' ? 2 : 1);
+			rl_board_set_premium(board, rl_board_index(board, x, y), letter_multiplier, word_multiplier);
+		}
+	}
+}
+
+int32 rl_board_score_move(const rl_board& board, int32 index, int32 offset, const uint8* word, int32 word_len)
+{
+	// Letters already on the board count at face value; tiles played into empty squares pick up that square's premiums,
+	// and also score any cross word they complete in the perpendicular direction
+	const int32* cross_sums = offset == 1 ? board.cross_sums_y : board.cross_sums_x;
+	int32 word_sum = 0;
+	int32 word_multiplier = 1;
+	int32 cross_score = 0;
+	int32 square_index = index;
+	for (int32 letter_index = 0; letter_index < word_len; letter_index++)
+	{
+		const int32 value = board.letter_values[word[letter_index] - 'a'];
+		if (_rl_board_is_letter(board, square_index))
+		{
+			word_sum += value;
+		}
+		else
+		{
+			const int32 letter_multiplier = board.letter_multipliers ? board.letter_multipliers[square_index] : 1;
+			const int32 square_word_multiplier = board.word_multipliers ? board.word_multipliers[square_index] : 1;
+			word_sum += value * letter_multiplier;
+			word_multiplier *= square_word_multiplier;
+			if (cross_sums[square_index] >= 0)
+			{
+				cross_score += (cross_sums[square_index] + value * letter_multiplier) * square_word_multiplier;
+			}
+		}
+		square_index += offset;
+	}
+	return word_sum * word_multiplier + cross_score;
 }
@@ -1,12 +1,79 @@
 #include "rl_dawg.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include <cstdlib>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
 
+#include <thread>
+#include <atomic>
+
 #include "rl_util.h"
 #include "rl_node.h"
+#include "rl_edgepool.h"
+#include "rl_wordreader.h"
+#include "rl_wordlist.h"
+
+static const uint8 _RL_DAWG_FILE_MAGIC[4] = { 'R', 'L', 'D', 'G' };
+static const uint32 _RL_DAWG_FILE_ENDIAN_TAG = 0x01020304;
+static const uint32 _RL_DAWG_FILE_VERSION = 4;
+static const uint32 _RL_DAWG_FILE_FLAG_GADDAG = 1 << 0;
+
+/*
+	Fixed-size header at the start of a binary DAWG image, followed immediately by a
+	verbatim copy of the DAWG's data block. All values are written in the byte order
+	of the machine that saved the file: endian_tag lets a reader detect a mismatch.
+*/
+struct _rl_dawg_file_header
+{
+	uint8 magic[4];
+	uint32 endian_tag;
+	uint32 version;
+	uint32 header_size;
+	int32 num_nodes;
+	int32 num_edges;
+	int32 num_words;
+	uint32 flags;
+	uint64 data_size;
+	uint64 checksum;
+	rl_distribution distribution;
+};
+
+static uint64 _rl_dawg_checksum(const uint8* buf, size_t size)
+{
+	// 64-bit FNV-1a, consuming 4 bytes per round: the data block is always a multiple of 4 bytes
+	uint64 hash = 0xcbf29ce484222325;
+	const uint32* words = reinterpret_cast<const uint32*>(buf);
+	for (size_t i = 0, n = size / sizeof(uint32); i < n; i++)
+	{
+		hash ^= words[i];
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+static size_t _rl_dawg_layout(rl_dawg& dawg, uint8* base)
+{
+	// Given the node and edge counts, compute where each array lives within the DAWG's data block
+	const size_t node_edges_size = (dawg.num_nodes + 1) * sizeof(uint32);
+	const size_t node_summaries_size = dawg.num_nodes * sizeof(rl_node_summary);
+	const size_t edges_size = dawg.num_edges * sizeof(rl_edge);
+	dawg.node_edges = reinterpret_cast<uint32*>(base);
+	dawg.node_summaries = reinterpret_cast<rl_node_summary*>(base + node_edges_size);
+	dawg.edges = reinterpret_cast<rl_edge*>(base + node_edges_size + node_summaries_size);
+	dawg.edge_ranks = reinterpret_cast<uint32*>(base + node_edges_size + node_summaries_size + edges_size);
+	return node_edges_size + node_summaries_size + edges_size * 2;
+}
 
 static void _rl_dawg_ctx_minimize(rl_dawg_ctx& ctx, int32 to_depth)
 {
@@ -18,7 +85,7 @@ static void _rl_dawg_ctx_minimize(rl_dawg_ctx& ctx, int32 to_depth)
 
 		rl_node& to_node = ctx.nodearray.items[edge.to_index];
 		const uint64 to_node_signature = rl_node_signature(to_node);
-		const int32 equivalent_node_index = rl_nodelookup_find(ctx.minimized_lookup, to_node_signature);
+		const int32 equivalent_node_index = rl_nodelookup_find(ctx.minimized_lookup, ctx.nodearray, to_node, to_node_signature);
 		if (equivalent_node_index >= 0)
 		{
 			rl_node& from_node = ctx.nodearray.items[edge.from_index];
@@ -33,9 +100,8 @@ static void _rl_dawg_ctx_minimize(rl_dawg_ctx& ctx, int32 to_depth)
 	}
 }
 
-void rl_dawg_ctx_init(rl_dawg_ctx& ctx)
+static void _rl_dawg_ctx_init_common(rl_dawg_ctx& ctx)
 {
-	rl_nodearray_init(ctx.nodearray, 8192);
 	rl_nodearray_push(ctx.nodearray, false);
 	rl_nodelookup_init(ctx.minimized_lookup, 8192);
 
@@ -43,11 +109,31 @@ void rl_dawg_ctx_init(rl_dawg_ctx& ctx)
 	ctx.edge_stack_size = 0;
 
 	ctx.prev_word_len = 0;
+	ctx.allow_separator = false;
 
 	memset(ctx.letter_counts, 0, sizeof(ctx.letter_counts));
 	ctx.letter_counts_sum = 0;
 }
 
+void rl_dawg_ctx_init(rl_dawg_ctx& ctx)
+{
+	rl_nodearray_init(ctx.nodearray, 8192);
+	_rl_dawg_ctx_init_common(ctx);
+}
+
+void rl_dawg_ctx_init_arena(rl_dawg_ctx& ctx, size_t wordlist_size)
+{
+	// Minimized DAWGs of real word lists have roughly one node for every 20-25 bytes of input: reserving one node per
+	// 16 bytes means the nodearray will seldom need to be reallocated, and never more than once or twice
+	const size_t estimated_num_nodes = wordlist_size / 16;
+	const int32 node_capacity = static_cast<int32>(MIN(MAX(estimated_num_nodes, static_cast<size_t>(8192)), static_cast<size_t>(1 << 26)));
+
+	// Most nodes have few enough edges to fit in the smallest edgemap size class, so size the first slab to match
+	const size_t edge_slab_size = static_cast<size_t>(node_capacity) * RL_EDGEMAP_CAPACITY_STEP * sizeof(rl_edgemap_item);
+	rl_nodearray_init_pooled(ctx.nodearray, node_capacity, edge_slab_size);
+	_rl_dawg_ctx_init_common(ctx);
+}
+
 void rl_dawg_ctx_free(rl_dawg_ctx& ctx)
 {
 	rl_nodearray_free(ctx.nodearray);
@@ -63,25 +149,39 @@ bool rl_dawg_ctx_add(rl_dawg_ctx& ctx, const uint8* word, int32 word_len)
 	}
 
 	// Reject any buffer-bustin' words that exceed our maximum length
-	if (word_len > RL_MAX_WORD_LEN)
+	if (word_len > RL_MAX_WORD_LEN + (ctx.allow_separator ? 1 : 0))
 	{
 		return false;
 	}
 
-	// Require that every character in the word is a simple ASCII letter 'a' thru 'z'
+	// Require that every character in the word is a simple ASCII letter 'a' thru 'z', or
+	// the separator in a GADDAG entry
+	int32 num_separators = 0;
 	for (int32 letter_index = 0; letter_index < word_len; letter_index++)
 	{
 		const uint8 letter = word[letter_index];
-		if (letter < 'a' || letter > 'z')
+		if (letter == RL_GADDAG_SEPARATOR && ctx.allow_separator)
+		{
+			num_separators++;
+		}
+		else if (letter < 'a' || letter > 'z')
 		{
 			return false;
 		}
 	}
+	if (num_separators > 1 || word_len - num_separators > RL_MAX_WORD_LEN)
+	{
+		return false;
+	}
 
 	// Count each letter in the word toward our base distribution
 	for (int32 letter_index = 0; letter_index < word_len; letter_index++)
 	{
 		const uint8 letter = word[letter_index];
+		if (letter == RL_GADDAG_SEPARATOR)
+		{
+			continue;
+		}
 		const uint8 index = letter - 'a';
 
 		ctx.letter_counts[index]++;
@@ -122,8 +222,7 @@ bool rl_dawg_ctx_add(rl_dawg_ctx& ctx, const uint8* word, int32 word_len)
 		const bool is_word = letter_index == word_len - 1;
 
 		const int32 new_node_index = rl_nodearray_push(ctx.nodearray, is_word);
-		rl_node& prev_node = ctx.nodearray.items[prev_node_index];
-		rl_edgemap_insert(prev_node.next_by_letter, letter, new_node_index);
+		rl_nodearray_insert_edge(ctx.nodearray, prev_node_index, letter, new_node_index);
 
 		assert(ctx.edge_stack_size < COUNT_OF(ctx.edge_stack));
 		rl_pending_edge& edge = ctx.edge_stack[ctx.edge_stack_size];
@@ -151,60 +250,1411 @@ void rl_dawg_ctx_move_nodes(rl_dawg_ctx& ctx, rl_dawg& dawg)
 	dawg.nodearray.capacity = ctx.nodearray.capacity;
 	dawg.nodearray.size = ctx.nodearray.size;
 	dawg.nodearray.items = ctx.nodearray.items;
+	dawg.nodearray.edgepool = ctx.nodearray.edgepool;
 
 	ctx.nodearray.capacity = 0;
 	ctx.nodearray.size = 0;
 	ctx.nodearray.items = nullptr;
+	ctx.nodearray.edgepool = nullptr;
 }
 
+// Source of each DAWG's generation id; starts at 1 so that 0 never matches a frozen DAWG
+static std::atomic<uint32> _rl_dawg_next_generation(1);
+
 void rl_dawg_init(rl_dawg& dawg)
 {
 	memset(&dawg, 0, sizeof(dawg));
 }
 
+static void _rl_dawg_release_data(rl_dawg& dawg)
+{
+	if (dawg.mapping)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(dawg.mapping);
+#else
+		munmap(dawg.mapping, dawg.mapping_size);
+#endif
+	}
+	else
+	{
+		free(dawg.data);
+	}
+	dawg.data = nullptr;
+	dawg.mapping = nullptr;
+	dawg.mapping_size = 0;
+}
+
 void rl_dawg_free(rl_dawg& dawg)
 {
 	rl_nodearray_free(dawg.nodearray);
+	_rl_dawg_release_data(dawg);
 }
 
-int32 rl_dawg_build(rl_dawg& dawg, const char* wordlist_path)
+static void _rl_dawg_summarize(rl_dawg& dawg, int32 node_index, bool* summarized, uint32* word_counts)
+{
+	// Summarize every node below this one first: each node is reachable along many paths, but only needs to be visited once
+	rl_node_summary& summary = dawg.node_summaries[node_index];
+	uint32 word_count = 0;
+	summary.letters = summary.mask;
+	summary.min_len = 0;
+	summary.max_len = 0;
+
+	const rl_edge* edges_end = rl_dawg_edges_end(dawg, node_index);
+	for (const rl_edge* edge = rl_dawg_edges_begin(dawg, node_index); edge != edges_end; edge++)
+	{
+		const int32 next_index = rl_edge_node_index(*edge);
+		if (!summarized[next_index])
+		{
+			_rl_dawg_summarize(dawg, next_index, summarized, word_counts);
+		}
+
+		// Every word completed through an earlier edge sorts before every word completed through this one
+		dawg.edge_ranks[edge - dawg.edges] = word_count;
+		word_count += word_counts[next_index] + (rl_edge_is_word(*edge) ? 1 : 0);
+
+		const rl_node_summary& next = dawg.node_summaries[next_index];
+		summary.letters |= next.letters;
+
+		// A terminal edge completes a word with just its own letter; otherwise the shortest word along this edge is
+		// the shortest one below the node it leads to. Every node other than the last in a word has at least one edge.
+		const int32 min_len = rl_edge_is_word(*edge) ? 1 : next.min_len + 1;
+		const int32 max_len = next.max_len + 1;
+		assert(rl_edge_is_word(*edge) || next.min_len > 0);
+		if (summary.min_len == 0 || min_len < summary.min_len)
+		{
+			summary.min_len = static_cast<uint8>(min_len);
+		}
+		if (max_len > summary.max_len)
+		{
+			summary.max_len = static_cast<uint8>(max_len);
+		}
+	}
+	word_counts[node_index] = word_count;
+	summarized[node_index] = true;
+}
+
+void rl_dawg_freeze(rl_dawg& dawg)
+{
+	assert(dawg.nodearray.size > 0);
+	assert(!dawg.data);
+
+	// Count the total number of edges so we can size a single buffer for the whole DAWG
+	const int32 num_nodes = dawg.nodearray.size;
+	int32 num_edges = 0;
+	for (int32 node_index = 0; node_index < num_nodes; node_index++)
+	{
+		num_edges += dawg.nodearray.items[node_index].next_by_letter.size;
+	}
+	assert(num_nodes < (1 << (32 - RL_EDGE_NODE_SHIFT)));
+
+	// Allocate the offset table and the edge array back-to-back in one block
+	dawg.num_nodes = num_nodes;
+	dawg.num_edges = num_edges;
+	dawg.data = malloc(_rl_dawg_layout(dawg, nullptr));
+	assert(dawg.data);
+	_rl_dawg_layout(dawg, reinterpret_cast<uint8*>(dawg.data));
+
+	// Zero the node summaries up front, so that their padding doesn't leave indeterminate bytes in the saved image
+	memset(dawg.node_summaries, 0, num_nodes * sizeof(rl_node_summary));
+
+	// Pack each node's edges into the flat array, carrying the terminal flag of each destination node on the edge itself
+	int32 edge_index = 0;
+	for (int32 node_index = 0; node_index < num_nodes; node_index++)
+	{
+		dawg.node_edges[node_index] = edge_index;
+		uint32 mask = 0;
+
+		const rl_edgemap& edgemap = dawg.nodearray.items[node_index].next_by_letter;
+		for (int32 item_index = 0; item_index < edgemap.size; item_index++)
+		{
+			const rl_edgemap_item& item = edgemap.items[item_index];
+			assert(item.letter >= 'a' && item.letter <= RL_GADDAG_SEPARATOR);
+			assert(item.node_index > 0 && item.node_index < num_nodes);
+
+			// Edges must be in strictly ascending order by letter, so that each edge's rank in the mask is its position
+			rl_edge edge = static_cast<uint32>(item.letter - 'a');
+			assert((mask >> edge) == 0);
+			mask |= 1u << edge;
+			if (dawg.nodearray.items[item.node_index].is_word)
+			{
+				edge |= RL_EDGE_TERMINAL;
+			}
+			edge |= static_cast<uint32>(item.node_index) << RL_EDGE_NODE_SHIFT;
+			dawg.edges[edge_index] = edge;
+			edge_index++;
+		}
+		dawg.node_summaries[node_index].mask = mask;
+	}
+	dawg.node_edges[num_nodes] = edge_index;
+	assert(edge_index == num_edges);
+
+	// With every edge in place, summarize the words below each node, and count them to rank each edge
+	bool* summarized = reinterpret_cast<bool*>(calloc(num_nodes, sizeof(bool)));
+	uint32* word_counts = reinterpret_cast<uint32*>(malloc(num_nodes * sizeof(uint32)));
+	assert(summarized && word_counts);
+	_rl_dawg_summarize(dawg, 0, summarized, word_counts);
+	free(word_counts);
+	free(summarized);
+
+	// The nodearray is no longer needed once the DAWG is frozen
+	rl_nodearray_free(dawg.nodearray);
+	dawg.nodearray.capacity = 0;
+	dawg.nodearray.size = 0;
+	dawg.nodearray.items = nullptr;
+	dawg.nodearray.edgepool = nullptr;
+	dawg.generation = _rl_dawg_next_generation++;
+}
+
+struct _rl_dawg_reorder_key
+{
+	uint32 weight;
+	int32 bfs_position;
+	int32 node_index;
+};
+
+static int _rl_dawg_compare_reorder_keys(const void* lhs, const void* rhs)
+{
+	// Heaviest nodes first, falling back to breadth-first order among nodes of equal weight
+	const _rl_dawg_reorder_key& a = *reinterpret_cast<const _rl_dawg_reorder_key*>(lhs);
+	const _rl_dawg_reorder_key& b = *reinterpret_cast<const _rl_dawg_reorder_key*>(rhs);
+	if (a.weight != b.weight)
+	{
+		return a.weight > b.weight ? -1 : 1;
+	}
+	return a.bfs_position - b.bfs_position;
+}
+
+void rl_dawg_reorder(rl_dawg& dawg, const uint32* node_weights)
+{
+	assert(dawg.data);
+	assert(!dawg.packed);
+	const int32 num_nodes = dawg.num_nodes;
+	const int32 num_edges = dawg.num_edges;
+
+	// List the nodes in breadth-first order from the root, visiting each node's children in order by letter: the
+	// nodes for short prefixes, which every search passes through, end up packed together at the front
+	int32* order = reinterpret_cast<int32*>(malloc(num_nodes * sizeof(int32)));
+	int32* new_indices = reinterpret_cast<int32*>(malloc(num_nodes * sizeof(int32)));
+	assert(order && new_indices);
+	for (int32 node_index = 0; node_index < num_nodes; node_index++)
+	{
+		new_indices[node_index] = -1;
+	}
+	int32 num_ordered = 0;
+	order[num_ordered++] = 0;
+	new_indices[0] = 0;
+	for (int32 queue_index = 0; queue_index < num_ordered; queue_index++)
+	{
+		const int32 node_index = order[queue_index];
+		const rl_edge* edges_end = rl_dawg_edges_end(dawg, node_index);
+		for (const rl_edge* edge = rl_dawg_edges_begin(dawg, node_index); edge != edges_end; edge++)
+		{
+			const int32 next_index = rl_edge_node_index(*edge);
+			if (new_indices[next_index] < 0)
+			{
+				new_indices[next_index] = num_ordered;
+				order[num_ordered++] = next_index;
+			}
+		}
+	}
+	assert(num_ordered == num_nodes);
+
+	// If we're given weights for each node, sort by weight instead, but keep the root at index 0: that's where every
+	// traversal begins, and no edge may lead to it
+	if (node_weights)
+	{
+		_rl_dawg_reorder_key* keys = reinterpret_cast<_rl_dawg_reorder_key*>(malloc(num_nodes * sizeof(_rl_dawg_reorder_key)));
+		assert(keys);
+		for (int32 position = 0; position < num_nodes; position++)
+		{
+			keys[position].weight = node_weights[order[position]];
+			keys[position].bfs_position = position;
+			keys[position].node_index = order[position];
+		}
+		qsort(keys + 1, num_nodes - 1, sizeof(_rl_dawg_reorder_key), _rl_dawg_compare_reorder_keys);
+		for (int32 position = 0; position < num_nodes; position++)
+		{
+			order[position] = keys[position].node_index;
+			new_indices[order[position]] = position;
+		}
+		free(keys);
+	}
+
+	// Copy every node into a new data block in its new position, with its edges following the same order, and with
+	// each edge rewritten to point to the new index of the node at its end
+	rl_dawg reordered;
+	rl_dawg_init(reordered);
+	reordered.num_nodes = num_nodes;
+	reordered.num_edges = num_edges;
+	reordered.data = malloc(_rl_dawg_layout(reordered, nullptr));
+	assert(reordered.data);
+	_rl_dawg_layout(reordered, reinterpret_cast<uint8*>(reordered.data));
+
+	uint32 edge_index = 0;
+	for (int32 position = 0; position < num_nodes; position++)
+	{
+		const int32 node_index = order[position];
+		reordered.node_edges[position] = edge_index;
+		reordered.node_summaries[position] = dawg.node_summaries[node_index];
+		for (uint32 old_edge_index = dawg.node_edges[node_index]; old_edge_index < dawg.node_edges[node_index + 1]; old_edge_index++)
+		{
+			const rl_edge edge = dawg.edges[old_edge_index];
+			const uint32 new_node_index = static_cast<uint32>(new_indices[rl_edge_node_index(edge)]);
+			reordered.edges[edge_index] = (edge & ~(~0u << RL_EDGE_NODE_SHIFT)) | (new_node_index << RL_EDGE_NODE_SHIFT);
+			reordered.edge_ranks[edge_index] = dawg.edge_ranks[old_edge_index];
+			edge_index++;
+		}
+	}
+	reordered.node_edges[num_nodes] = edge_index;
+	assert(edge_index == static_cast<uint32>(num_edges));
+	free(new_indices);
+	free(order);
+
+	// Swap the new block in for the old one, which may have been mapped from a file
+	_rl_dawg_release_data(dawg);
+	dawg.data = reordered.data;
+	_rl_dawg_layout(dawg, reinterpret_cast<uint8*>(dawg.data));
+	dawg.generation = _rl_dawg_next_generation++;
+}
+
+bool rl_dawg_contains(const rl_dawg& dawg, const uint8* word, int32 word_len)
+{
+	assert(dawg.data);
+	rl_edge edge = RL_EDGE_NONE;
+	int32 node_index = 0;
+	for (int32 i = 0; i < word_len; i++)
+	{
+		edge = rl_dawg_find_edge(dawg, node_index, word[i]);
+		if (edge == RL_EDGE_NONE)
+		{
+			return false;
+		}
+		node_index = rl_edge_node_index(edge);
+	}
+	return rl_edge_is_word(edge);
+}
+
+// Number of lookups that rl_dawg_contains_batch advances together
+static const int32 _RL_DAWG_BATCH_NUM_LANES = 16;
+
+struct _rl_dawg_batch_lane
+{
+	int32 query;
+	const uint8* next_letter;
+	const uint8* end;
+	int32 node_index;
+};
+
+static bool _rl_dawg_batch_start(_rl_dawg_batch_lane& lane, const uint8* const* words, const int32* lens, int32 n, int32& next_query)
+{
+	// Assign the next word to the lane, starting from the root: empty words are never found, so they're skipped
+	while (next_query < n && lens[next_query] <= 0)
+	{
+		next_query++;
+	}
+	if (next_query == n)
+	{
+		return false;
+	}
+	lane.query = next_query++;
+	lane.next_letter = words[lane.query];
+	lane.end = lane.next_letter + lens[lane.query];
+	lane.node_index = 0;
+	return true;
+}
+
+void rl_dawg_contains_batch(const rl_dawg& dawg, const uint8* const* words, const int32* lens, int32 n, uint8* out_bits)
+{
+	assert(dawg.data);
+	memset(out_bits, 0, (n + 7) / 8);
+
+	_rl_dawg_batch_lane lanes[_RL_DAWG_BATCH_NUM_LANES];
+	int32 num_lanes = 0;
+	int32 next_query = 0;
+	while (num_lanes < _RL_DAWG_BATCH_NUM_LANES && _rl_dawg_batch_start(lanes[num_lanes], words, lens, n, next_query))
+	{
+		num_lanes++;
+	}
+
+	// Advance each lane by one letter in turn, prefetching the node at the end of its edge: by the time we come back
+	// around to the lane, the node should have arrived, while the other lanes were waiting on nodes of their own. A
+	// lane whose word is finished (or can't be in the DAWG) takes on the next word, or if there are none left, is
+	// retired by moving the last lane into its place.
+	while (num_lanes > 0)
+	{
+		int32 lane_index = 0;
+		while (lane_index < num_lanes)
+		{
+			_rl_dawg_batch_lane& lane = lanes[lane_index];
+			const rl_edge edge = rl_dawg_find_edge(dawg, lane.node_index, *lane.next_letter);
+			bool finished = edge == RL_EDGE_NONE;
+			if (!finished)
+			{
+				lane.node_index = rl_edge_node_index(edge);
+				if (++lane.next_letter == lane.end)
+				{
+					if (rl_edge_is_word(edge))
+					{
+						out_bits[lane.query >> 3] |= static_cast<uint8>(1u << (lane.query & 7));
+					}
+					finished = true;
+				}
+				else if (dawg.packed)
+				{
+					rl_prefetch(dawg.packed + lane.node_index);
+				}
+				else
+				{
+					rl_prefetch(dawg.node_summaries + lane.node_index);
+					rl_prefetch(dawg.node_edges + lane.node_index);
+				}
+			}
+
+			if (finished && !_rl_dawg_batch_start(lane, words, lens, n, next_query))
+			{
+				lane = lanes[--num_lanes];
+				continue;
+			}
+			lane_index++;
+		}
+	}
+}
+
+static uint32 _rl_dawg_packed_width(uint32 value)
+{
+	// Number of bytes needed to hold the given value
+	return value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+}
+
+void rl_dawg_pack(const rl_dawg& dawg, rl_dawg& packed)
+{
+	assert(dawg.data && !dawg.packed);
+	assert(packed.nodearray.size == 0 && !packed.data);
+
+	// Edges are written one byte at a time, least significant first, but read back as 32-bit values
+	const uint32 probe = 1;
+	assert(*reinterpret_cast<const uint8*>(&probe) == 1);
+	(void)probe;
+
+	// Find the order in which a depth-first traversal finishes with each node: reversed, it puts every node after
+	// all of its parents, with the root first, and places many nodes directly after one of their parents
+	const int32 num_nodes = dawg.num_nodes;
+	int32* order = reinterpret_cast<int32*>(malloc(num_nodes * sizeof(int32)));
+	bool* visited = reinterpret_cast<bool*>(calloc(num_nodes, sizeof(bool)));
+	assert(order && visited);
+	int32 stack_nodes[RL_MAX_WORD_LEN + 2];
+	uint32 stack_edges[RL_MAX_WORD_LEN + 2];
+	int32 stack_size = 0;
+	int32 num_finished = 0;
+	stack_nodes[stack_size] = 0;
+	stack_edges[stack_size] = dawg.node_edges[0];
+	stack_size++;
+	visited[0] = true;
+	while (stack_size > 0)
+	{
+		const int32 node_index = stack_nodes[stack_size - 1];
+		if (stack_edges[stack_size - 1] < dawg.node_edges[node_index + 1])
+		{
+			const int32 next_index = rl_edge_node_index(dawg.edges[stack_edges[stack_size - 1]++]);
+			if (!visited[next_index])
+			{
+				assert(stack_size < static_cast<int32>(COUNT_OF(stack_nodes)));
+				visited[next_index] = true;
+				stack_nodes[stack_size] = next_index;
+				stack_edges[stack_size] = dawg.node_edges[next_index];
+				stack_size++;
+			}
+		}
+		else
+		{
+			order[num_nodes - 1 - num_finished++] = node_index;
+			stack_size--;
+		}
+	}
+	assert(num_finished == num_nodes && order[0] == 0);
+	free(visited);
+
+	// Each node's edges are all as wide as its farthest edge needs, which depends on where its children end up, which
+	// in turn depends on the widths of the edges before them: start narrow, and widen edges until the layout settles
+	uint32* offsets = reinterpret_cast<uint32*>(malloc(num_nodes * sizeof(uint32)));
+	uint8* widths = reinterpret_cast<uint8*>(malloc(num_nodes));
+	assert(offsets && widths);
+	memset(widths, 1, num_nodes);
+	size_t packed_size = 0;
+	bool widened = true;
+	while (widened)
+	{
+		packed_size = 0;
+		for (int32 position = 0; position < num_nodes; position++)
+		{
+			const int32 node_index = order[position];
+			offsets[node_index] = static_cast<uint32>(packed_size);
+			packed_size += sizeof(uint32) + widths[node_index] * (dawg.node_edges[node_index + 1] - dawg.node_edges[node_index]);
+		}
+		assert(packed_size < (static_cast<size_t>(1) << (32 - RL_EDGE_NODE_SHIFT)));
+
+		widened = false;
+		for (int32 node_index = 0; node_index < num_nodes; node_index++)
+		{
+			for (uint32 edge_index = dawg.node_edges[node_index]; edge_index < dawg.node_edges[node_index + 1]; edge_index++)
+			{
+				const uint32 distance = offsets[rl_edge_node_index(dawg.edges[edge_index])] - offsets[node_index];
+				const uint32 width = _rl_dawg_packed_width((distance << 1) | 1);
+				if (width > widths[node_index])
+				{
+					widths[node_index] = static_cast<uint8>(width);
+					widened = true;
+				}
+			}
+		}
+	}
+
+	// Write out each node's record, padding the end of the block so that reading any edge as a 32-bit value stays
+	// within bounds
+	uint8* block = reinterpret_cast<uint8*>(calloc(packed_size + sizeof(uint32) - 1, 1));
+	assert(block);
+	for (int32 node_index = 0; node_index < num_nodes; node_index++)
+	{
+		const uint32 mask = dawg.node_summaries[node_index].mask;
+		const uint32 width = widths[node_index];
+		assert((mask & ~RL_PACKED_MASK_BITS) == 0);
+		const uint32 header = mask | ((width - 1) << RL_PACKED_WIDTH_SHIFT);
+		uint8* record = block + offsets[node_index];
+		memcpy(record, &header, sizeof(header));
+		uint8* edge_bytes = record + sizeof(header);
+		for (uint32 edge_index = dawg.node_edges[node_index]; edge_index < dawg.node_edges[node_index + 1]; edge_index++)
+		{
+			const rl_edge edge = dawg.edges[edge_index];
+			const uint32 distance = offsets[rl_edge_node_index(edge)] - offsets[node_index];
+			const uint32 value = (distance << 1) | (rl_edge_is_word(edge) ? 1 : 0);
+			for (uint32 byte_index = 0; byte_index < width; byte_index++)
+			{
+				*edge_bytes++ = static_cast<uint8>(value >> (8 * byte_index));
+			}
+		}
+	}
+	free(widths);
+	free(offsets);
+	free(order);
+
+	rl_dawg_init(packed);
+	packed.num_nodes = num_nodes;
+	packed.num_edges = dawg.num_edges;
+	packed.data = block;
+	packed.packed = block;
+	packed.packed_size = packed_size;
+	packed.num_words = dawg.num_words;
+	packed.is_gaddag = dawg.is_gaddag;
+	packed.generation = _rl_dawg_next_generation++;
+	memcpy(&packed.distribution, &dawg.distribution, sizeof(rl_distribution));
+}
+
+size_t rl_dawg_num_bytes(const rl_dawg& dawg)
+{
+	if (dawg.packed)
+	{
+		return dawg.packed_size;
+	}
+	rl_dawg layout = dawg;
+	return _rl_dawg_layout(layout, nullptr);
+}
+
+int32 rl_dawg_word_id(const rl_dawg& dawg, const uint8* word, int32 word_len)
+{
+	assert(dawg.data);
+	assert(!dawg.packed);
+	assert(!dawg.is_gaddag);
+
+	// Walk the word's path from the root. At each step, every word below the node's earlier edges precedes ours, as
+	// does the word that ends at the edge we take, if any (unless it's our word).
+	uint32 word_id = 0;
+	int32 node_index = 0;
+	for (int32 letter_index = 0; letter_index < word_len; letter_index++)
+	{
+		const uint32 ordinal = static_cast<uint32>(word[letter_index] - 'a');
+		const uint32 mask = rl_dawg_node_mask(dawg, node_index);
+		if (ordinal >= 26 || (mask & (1u << ordinal)) == 0)
+		{
+			return -1;
+		}
+
+		const uint32 edge_index = rl_dawg_node_edge_index(dawg, node_index, mask, ordinal);
+		const rl_edge edge = dawg.edges[edge_index];
+		word_id += dawg.edge_ranks[edge_index];
+		if (letter_index == word_len - 1)
+		{
+			return rl_edge_is_word(edge) ? static_cast<int32>(word_id) : -1;
+		}
+		if (rl_edge_is_word(edge))
+		{
+			word_id++;
+		}
+		node_index = rl_edge_node_index(edge);
+	}
+	return -1;
+}
+
+int32 rl_dawg_word_at(const rl_dawg& dawg, int32 word_id, uint8* out_word)
+{
+	assert(dawg.data);
+	assert(!dawg.packed);
+	assert(!dawg.is_gaddag);
+	assert(word_id >= 0 && word_id < dawg.num_words);
+
+	// Retrace the steps of rl_dawg_word_id: at each node, the word lies below the last edge whose rank doesn't exceed
+	// the number of words remaining before it. Every edge leads to at least one word, so ranks are strictly ascending.
+	uint32 num_preceding = static_cast<uint32>(word_id);
+	int32 node_index = 0;
+	int32 word_len = 0;
+	while (true)
+	{
+		assert(word_len < RL_MAX_WORD_LEN);
+		uint32 lo = dawg.node_edges[node_index];
+		uint32 hi = dawg.node_edges[node_index + 1] - 1;
+		assert(lo <= hi);
+		while (lo < hi)
+		{
+			const uint32 mid = (lo + hi + 1) / 2;
+			if (dawg.edge_ranks[mid] <= num_preceding)
+			{
+				lo = mid;
+			}
+			else
+			{
+				hi = mid - 1;
+			}
+		}
+
+		const rl_edge edge = dawg.edges[lo];
+		out_word[word_len++] = rl_edge_letter(edge);
+		num_preceding -= dawg.edge_ranks[lo];
+		if (rl_edge_is_word(edge))
+		{
+			if (num_preceding == 0)
+			{
+				return word_len;
+			}
+			num_preceding--;
+		}
+		node_index = rl_edge_node_index(edge);
+	}
+}
+
+int32 rl_dawg_random_word(const rl_dawg& dawg, uint32 randval, uint8* out_word)
+{
+	// Scale the random value down to the range of word IDs, rather than taking a modulus, to keep any bias negligible
+	assert(dawg.num_words > 0);
+	const int32 word_id = static_cast<int32>((static_cast<uint64>(randval) * static_cast<uint64>(dawg.num_words)) >> 32);
+	return rl_dawg_word_at(dawg, word_id, out_word);
+}
+
+bool rl_dawg_save(const rl_dawg& dawg, const char* path)
+{
+	assert(dawg.data);
+	assert(!dawg.packed);
+
+	// Compute the size of the data block from the DAWG's counts, without touching its pointers
+	rl_dawg layout = dawg;
+	const size_t data_size = _rl_dawg_layout(layout, nullptr);
+
+	_rl_dawg_file_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, _RL_DAWG_FILE_MAGIC, sizeof(header.magic));
+	header.endian_tag = _RL_DAWG_FILE_ENDIAN_TAG;
+	header.version = _RL_DAWG_FILE_VERSION;
+	header.header_size = sizeof(header);
+	header.num_nodes = dawg.num_nodes;
+	header.num_edges = dawg.num_edges;
+	header.num_words = dawg.num_words;
+	header.flags = dawg.is_gaddag ? _RL_DAWG_FILE_FLAG_GADDAG : 0;
+	header.data_size = data_size;
+	header.checksum = _rl_dawg_checksum(reinterpret_cast<const uint8*>(dawg.data), data_size);
+	header.distribution = dawg.distribution;
+
+	FILE* fp = fopen(path, "wb");
+	if (!fp)
+	{
+		printf("WARNING: Could not open '%s' for write\n", path);
+		return false;
+	}
+	const bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 && fwrite(dawg.data, data_size, 1, fp) == 1;
+	if (fclose(fp) != 0 || !ok)
+	{
+		printf("WARNING: Failed to write DAWG to '%s'\n", path);
+		return false;
+	}
+	return true;
+}
+
+int32 rl_dawg_load_mapped(rl_dawg& dawg, const char* path)
+{
+	assert(dawg.nodearray.size == 0);
+	assert(!dawg.data);
+
+	// Map the entire file into memory, read-only: pages are shared with any other process that maps the same file
+	void* mapping = nullptr;
+	size_t mapping_size = 0;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER file_size;
+		if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+		{
+			HANDLE file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (file_mapping)
+			{
+				mapping = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+				mapping_size = static_cast<size_t>(file_size.QuadPart);
+				CloseHandle(file_mapping);
+			}
+		}
+		CloseHandle(file);
+	}
+#else
+	const int fd = open(path, O_RDONLY);
+	if (fd >= 0)
+	{
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			mapping_size = st.st_size;
+			if (mapping == MAP_FAILED)
+			{
+				mapping = nullptr;
+			}
+		}
+		close(fd);
+	}
+#endif
+	if (!mapping)
+	{
+		printf("WARNING: Could not map '%s' for read\n", path);
+		return 0;
+	}
+
+	// Validate the header before trusting anything else in the file
+	const uint8* base = reinterpret_cast<const uint8*>(mapping);
+	const _rl_dawg_file_header* header = reinterpret_cast<const _rl_dawg_file_header*>(base);
+	const char* error = nullptr;
+	if (mapping_size < sizeof(_rl_dawg_file_header) || memcmp(header->magic, _RL_DAWG_FILE_MAGIC, sizeof(header->magic)) != 0)
+	{
+		error = "not a DAWG image";
+	}
+	else if (header->endian_tag != _RL_DAWG_FILE_ENDIAN_TAG)
+	{
+		error = "byte order does not match this machine";
+	}
+	else if (header->version != _RL_DAWG_FILE_VERSION || header->header_size != sizeof(_rl_dawg_file_header))
+	{
+		error = "unsupported format version";
+	}
+	else if (header->num_nodes <= 0 || header->num_edges < 0 || header->data_size != mapping_size - sizeof(_rl_dawg_file_header))
+	{
+		error = "truncated or corrupt";
+	}
+	else
+	{
+		rl_dawg layout = dawg;
+		layout.num_nodes = header->num_nodes;
+		layout.num_edges = header->num_edges;
+		if (_rl_dawg_layout(layout, nullptr) != header->data_size)
+		{
+			error = "truncated or corrupt";
+		}
+		else if (_rl_dawg_checksum(base + sizeof(_rl_dawg_file_header), header->data_size) != header->checksum)
+		{
+			error = "checksum mismatch";
+		}
+	}
+	if (error)
+	{
+		printf("WARNING: Could not load '%s': %s\n", path, error);
+#ifdef _WIN32
+		UnmapViewOfFile(mapping);
+#else
+		munmap(mapping, mapping_size);
+#endif
+		return 0;
+	}
+
+	// Point the DAWG's arrays directly into the mapped data block
+	dawg.num_nodes = header->num_nodes;
+	dawg.num_edges = header->num_edges;
+	dawg.num_words = header->num_words;
+	dawg.is_gaddag = (header->flags & _RL_DAWG_FILE_FLAG_GADDAG) != 0;
+	dawg.distribution = header->distribution;
+	dawg.data = const_cast<uint8*>(base + sizeof(_rl_dawg_file_header));
+	dawg.mapping = mapping;
+	dawg.mapping_size = mapping_size;
+	dawg.generation = _rl_dawg_next_generation++;
+	_rl_dawg_layout(dawg, reinterpret_cast<uint8*>(dawg.data));
+	return dawg.num_words;
+}
+
+static void _rl_dawg_build_finish(rl_dawg& dawg, rl_dawg_ctx& ctx, int32 num_words_accepted)
+{
+	// Compute the frequency with which each letter appears in the input word list
+	rl_distribution_init(dawg.distribution, ctx.letter_counts, ctx.letter_counts_sum);
+
+	// Finish minimizing the DAWG, transfer ownership of the node aray into the rl_dawg, then free the context
+	rl_dawg_ctx_finalize(ctx);
+	rl_dawg_ctx_move_nodes(ctx, dawg);
+	rl_dawg_ctx_free(ctx);
+
+	// Convert the nodearray into its final, contiguous read-only layout
+	rl_dawg_freeze(dawg);
+	dawg.num_words = num_words_accepted;
+}
+
+static int32 _rl_dawg_build_from_reader(rl_dawg& dawg, rl_wordreader& reader)
 {
 	assert(dawg.nodearray.capacity == 0);
 	assert(dawg.nodearray.size == 0);
 	assert(!dawg.nodearray.items);
+	assert(!dawg.data);
+
+	// Initialize a context object to contain the state necessary for building the DAWG, pre-sizing its storage from
+	// the size of the word list (if known)
+	rl_dawg_ctx ctx;
+	rl_dawg_ctx_init_arena(ctx, rl_wordreader_file_size(reader.fd));
+
+	// Feed each word into the DAWG context straight from the reader's buffer: words that the reader has already
+	// flagged as containing something other than 'a' through 'z' would be rejected anyway, so we skip them early
+	int32 num_words_accepted = 0;
+	const uint8* word;
+	int32 word_len;
+	bool word_is_valid;
+	while (rl_wordreader_next(reader, word, word_len, word_is_valid))
+	{
+		if (word_is_valid && rl_dawg_ctx_add(ctx, word, word_len))
+		{
+			num_words_accepted++;
+		}
+	}
+
+	// If the word list couldn't be read in full, give up rather than building a DAWG from part of it
+	if (reader.error)
+	{
+		rl_dawg_ctx_free(ctx);
+		return 0;
+	}
+
+	_rl_dawg_build_finish(dawg, ctx, num_words_accepted);
+	return num_words_accepted;
+}
 
+int32 rl_dawg_build(rl_dawg& dawg, const char* wordlist_path)
+{
 	// Open the word list file: it should be a list of whitespace-delimited words, in lexicographical order
-	FILE* fp = fopen(wordlist_path, "r");
+	rl_wordreader reader;
+	if (!rl_wordreader_open(reader, wordlist_path))
+	{
+		printf("WARNING: Could not open '%s' for read\n", wordlist_path);
+		return 0;
+	}
+	const int32 num_words_accepted = _rl_dawg_build_from_reader(dawg, reader);
+	rl_wordreader_free(reader);
+	return num_words_accepted;
+}
+
+int32 rl_dawg_build_fd(rl_dawg& dawg, int fd)
+{
+	rl_wordreader reader;
+	rl_wordreader_init(reader, fd);
+	const int32 num_words_accepted = _rl_dawg_build_from_reader(dawg, reader);
+	rl_wordreader_free(reader);
+	return num_words_accepted;
+}
+
+static FILE* _rl_dawg_spill_run(const rl_wordlist& wordlist)
+{
+	// Write the (sorted) words out to an anonymous temp file, one per line, and rewind it so it's ready to be read back
+	FILE* fp = tmpfile();
 	if (!fp)
+	{
+		return nullptr;
+	}
+	for (int32 word_index = 0; word_index < wordlist.num_entries; word_index++)
+	{
+		fwrite(rl_wordlist_word(wordlist, word_index), 1, wordlist.entries[word_index].len, fp);
+		fputc('\n', fp);
+	}
+	if (fflush(fp) != 0)
+	{
+		fclose(fp);
+		return nullptr;
+	}
+	rewind(fp);
+	return fp;
+}
+
+/*
+	Sorted run of words spilled to a temp file, along with the word at the head of the
+	run while the runs are being merged.
+*/
+struct _rl_dawg_run
+{
+	FILE* fp;
+	rl_wordreader reader;
+	const uint8* word;
+	int32 word_len;
+};
+
+static bool _rl_dawg_run_advance(_rl_dawg_run& run)
+{
+	bool word_is_valid;
+	return rl_wordreader_next(run.reader, run.word, run.word_len, word_is_valid);
+}
+
+static bool _rl_dawg_run_less(const _rl_dawg_run& lhs, const _rl_dawg_run& rhs)
+{
+	const int cmp = memcmp(lhs.word, rhs.word, MIN(lhs.word_len, rhs.word_len));
+	return cmp < 0 || (cmp == 0 && lhs.word_len < rhs.word_len);
+}
+
+static void _rl_dawg_run_sift_down(_rl_dawg_run* runs, int32* heap, int32 heap_size, int32 pos)
+{
+	while (true)
+	{
+		const int32 left = pos * 2 + 1;
+		const int32 right = left + 1;
+		int32 smallest = pos;
+		if (left < heap_size && _rl_dawg_run_less(runs[heap[left]], runs[heap[smallest]]))
+		{
+			smallest = left;
+		}
+		if (right < heap_size && _rl_dawg_run_less(runs[heap[right]], runs[heap[smallest]]))
+		{
+			smallest = right;
+		}
+		if (smallest == pos)
+		{
+			return;
+		}
+		const int32 temp = heap[pos];
+		heap[pos] = heap[smallest];
+		heap[smallest] = temp;
+		pos = smallest;
+	}
+}
+
+static int32 _rl_dawg_merge_runs(rl_dawg_ctx& ctx, FILE** run_files, int32 num_runs, bool& out_read_failed)
+{
+	// Open a reader on each run, and arrange the runs in a min-heap ordered by the word at the head of each run
+	_rl_dawg_run* runs = reinterpret_cast<_rl_dawg_run*>(malloc(num_runs * sizeof(_rl_dawg_run)));
+	int32* heap = reinterpret_cast<int32*>(malloc(num_runs * sizeof(int32)));
+	assert(runs && heap);
+	int32 heap_size = 0;
+	for (int32 run_index = 0; run_index < num_runs; run_index++)
+	{
+		_rl_dawg_run& run = runs[run_index];
+		run.fp = run_files[run_index];
+		rl_wordreader_init(run.reader, fileno(run.fp));
+		if (_rl_dawg_run_advance(run))
+		{
+			heap[heap_size++] = run_index;
+		}
+	}
+	for (int32 pos = heap_size / 2 - 1; pos >= 0; pos--)
+	{
+		_rl_dawg_run_sift_down(runs, heap, heap_size, pos);
+	}
+
+	// Repeatedly take the smallest word from across all runs, skipping any word that repeats the previous one, which
+	// yields every distinct word in sorted order
+	int32 num_words_accepted = 0;
+	uint8 prev_word[RL_MAX_WORD_LEN];
+	int32 prev_word_len = -1;
+	while (heap_size > 0)
+	{
+		_rl_dawg_run& run = runs[heap[0]];
+		if (run.word_len != prev_word_len || memcmp(run.word, prev_word, run.word_len) != 0)
+		{
+			assert(run.word_len <= RL_MAX_WORD_LEN);
+			memcpy(prev_word, run.word, run.word_len);
+			prev_word_len = run.word_len;
+			if (rl_dawg_ctx_add(ctx, run.word, run.word_len))
+			{
+				num_words_accepted++;
+			}
+		}
+
+		if (!_rl_dawg_run_advance(run))
+		{
+			heap[0] = heap[--heap_size];
+		}
+		_rl_dawg_run_sift_down(runs, heap, heap_size, 0);
+	}
+
+	out_read_failed = false;
+	for (int32 run_index = 0; run_index < num_runs; run_index++)
+	{
+		out_read_failed = out_read_failed || runs[run_index].reader.error;
+		rl_wordreader_free(runs[run_index].reader);
+		fclose(runs[run_index].fp);
+	}
+	free(heap);
+	free(runs);
+	return num_words_accepted;
+}
+
+static int32 _rl_dawg_build_unsorted_from_reader(rl_dawg& dawg, rl_wordreader& reader, size_t memory_budget)
+{
+	assert(dawg.nodearray.size == 0);
+	assert(!dawg.data);
+	if (memory_budget == 0)
+	{
+		memory_budget = RL_DAWG_DEFAULT_SORT_BUDGET;
+	}
+
+	// Collect every valid word into memory. Words that are too long would be rejected by rl_dawg_ctx_add anyway, so we
+	// skip them here and keep only words that our sort and merge can handle.
+	const size_t file_size = rl_wordreader_file_size(reader.fd);
+	rl_wordlist wordlist;
+	rl_wordlist_init(wordlist, MIN(file_size, memory_budget / 2));
+
+	FILE** run_files = nullptr;
+	int32 num_runs = 0;
+	bool spill_failed = false;
+	const uint8* word;
+	int32 word_len;
+	bool word_is_valid;
+	while (rl_wordreader_next(reader, word, word_len, word_is_valid))
+	{
+		if (!word_is_valid || word_len > RL_MAX_WORD_LEN)
+		{
+			continue;
+		}
+		rl_wordlist_append(wordlist, word, word_len);
+
+		// If we've exceeded our memory budget, sort what we have and spill it to disk as a sorted run, then keep going
+		if (rl_wordlist_sort_size(wordlist) > memory_budget)
+		{
+			rl_wordlist_sort(wordlist);
+			FILE* fp = _rl_dawg_spill_run(wordlist);
+			if (!fp)
+			{
+				spill_failed = true;
+				break;
+			}
+			run_files = reinterpret_cast<FILE**>(realloc(run_files, (num_runs + 1) * sizeof(FILE*)));
+			assert(run_files);
+			run_files[num_runs++] = fp;
+			rl_wordlist_clear(wordlist);
+		}
+	}
+
+	bool read_failed = reader.error;
+
+	// Sort whatever remains in memory: if it all fit within our budget, we can build straight from the wordlist
+	rl_wordlist_sort(wordlist);
+	rl_dawg_ctx ctx;
+	rl_dawg_ctx_init_arena(ctx, file_size);
+	int32 num_words_accepted = 0;
+	if (num_runs == 0 && !spill_failed && !read_failed)
+	{
+		for (int32 word_index = 0; word_index < wordlist.num_entries; word_index++)
+		{
+			if (rl_dawg_ctx_add(ctx, rl_wordlist_word(wordlist, word_index), wordlist.entries[word_index].len))
+			{
+				num_words_accepted++;
+			}
+		}
+	}
+	else if (!spill_failed && !read_failed)
+	{
+		// Otherwise, spill the final run as well and merge all the runs together
+		FILE* fp = _rl_dawg_spill_run(wordlist);
+		if (fp)
+		{
+			run_files = reinterpret_cast<FILE**>(realloc(run_files, (num_runs + 1) * sizeof(FILE*)));
+			assert(run_files);
+			run_files[num_runs++] = fp;
+			rl_wordlist_free(wordlist);
+			num_words_accepted = _rl_dawg_merge_runs(ctx, run_files, num_runs, read_failed);
+			num_runs = 0;
+		}
+		else
+		{
+			spill_failed = true;
+		}
+	}
+	rl_wordlist_free(wordlist);
+
+	// If we couldn't read the word list or write a temp file, give up rather than building a DAWG from a partial word
+	// list (a failed read has already been reported by the reader)
+	if (spill_failed || read_failed)
+	{
+		if (spill_failed)
+		{
+			printf("WARNING: Could not write temp file while sorting word list\n");
+		}
+		for (int32 run_index = 0; run_index < num_runs; run_index++)
+		{
+			fclose(run_files[run_index]);
+		}
+		free(run_files);
+		rl_dawg_ctx_free(ctx);
+		return 0;
+	}
+	free(run_files);
+
+	_rl_dawg_build_finish(dawg, ctx, num_words_accepted);
+	return num_words_accepted;
+}
+
+int32 rl_dawg_build_unsorted(rl_dawg& dawg, const char* wordlist_path, size_t memory_budget)
+{
+	rl_wordreader reader;
+	if (!rl_wordreader_open(reader, wordlist_path))
 	{
 		printf("WARNING: Could not open '%s' for read\n", wordlist_path);
 		return 0;
 	}
+	const int32 num_words_accepted = _rl_dawg_build_unsorted_from_reader(dawg, reader, memory_budget);
+	rl_wordreader_free(reader);
+	return num_words_accepted;
+}
 
-	// Initialize a context object to contain the state necessary for building the DAWG
+int32 rl_dawg_build_unsorted_fd(rl_dawg& dawg, int fd, size_t memory_budget)
+{
+	rl_wordreader reader;
+	rl_wordreader_init(reader, fd);
+	const int32 num_words_accepted = _rl_dawg_build_unsorted_from_reader(dawg, reader, memory_budget);
+	rl_wordreader_free(reader);
+	return num_words_accepted;
+}
+
+int32 rl_dawg_build_gaddag(rl_dawg& dawg, const char* wordlist_path)
+{
+	assert(dawg.nodearray.size == 0);
+	assert(!dawg.data);
+
+	// Collect every distinct valid word into memory
+	rl_wordreader reader;
+	if (!rl_wordreader_open(reader, wordlist_path))
+	{
+		printf("WARNING: Could not open '%s' for read\n", wordlist_path);
+		return 0;
+	}
+	const size_t file_size = rl_wordreader_file_size(reader.fd);
+	rl_wordlist words;
+	rl_wordlist_init(words, file_size);
+	const uint8* word;
+	int32 word_len;
+	bool word_is_valid;
+	while (rl_wordreader_next(reader, word, word_len, word_is_valid))
+	{
+		if (word_is_valid && word_len <= RL_MAX_WORD_LEN)
+		{
+			rl_wordlist_append(words, word, word_len);
+		}
+	}
+	const bool read_failed = reader.error;
+	rl_wordreader_free(reader);
+	if (read_failed)
+	{
+		rl_wordlist_free(words);
+		return 0;
+	}
+	rl_wordlist_sort(words);
+
+	// Expand each word of n letters into n GADDAG entries, one for each split point: the letters before the split in
+	// reverse order, then the separator and the letters after the split (omitted when the split is at the very end).
+	// The distribution is based on the words themselves, since every entry would otherwise count each letter n times.
+	uint32 letter_counts[26] = { 0 };
+	uint32 letter_counts_sum = 0;
+	rl_wordlist entries;
+	rl_wordlist_init(entries, words.buf_size * 8);
+	for (int32 word_index = 0; word_index < words.num_entries; word_index++)
+	{
+		const uint8* letters = rl_wordlist_word(words, word_index);
+		const int32 len = words.entries[word_index].len;
+		for (int32 letter_index = 0; letter_index < len; letter_index++)
+		{
+			letter_counts[letters[letter_index] - 'a']++;
+			letter_counts_sum++;
+		}
+
+		uint8 entry[RL_MAX_WORD_LEN + 1];
+		for (int32 split = 1; split <= len; split++)
+		{
+			for (int32 i = 0; i < split; i++)
+			{
+				entry[i] = letters[split - 1 - i];
+			}
+			int32 entry_len = split;
+			if (split < len)
+			{
+				entry[entry_len++] = RL_GADDAG_SEPARATOR;
+				memcpy(entry + entry_len, letters + split, len - split);
+				entry_len += len - split;
+			}
+			rl_wordlist_append(entries, entry, entry_len);
+		}
+	}
+	const int32 num_words_accepted = words.num_entries;
+	rl_wordlist_free(words);
+
+	// Sort the entries and build them just like the words of a DAWG: each entry spells out exactly one word, so no two
+	// words produce the same entry
+	rl_wordlist_sort(entries);
+	rl_dawg_ctx ctx;
+	rl_dawg_ctx_init_arena(ctx, entries.buf_size + entries.num_entries);
+	ctx.allow_separator = true;
+	for (int32 entry_index = 0; entry_index < entries.num_entries; entry_index++)
+	{
+		const bool added = rl_dawg_ctx_add(ctx, rl_wordlist_word(entries, entry_index), entries.entries[entry_index].len);
+		assert(added);
+		(void)added;
+	}
+	rl_wordlist_free(entries);
+
+	memcpy(ctx.letter_counts, letter_counts, sizeof(letter_counts));
+	ctx.letter_counts_sum = letter_counts_sum;
+	_rl_dawg_build_finish(dawg, ctx, num_words_accepted);
+	dawg.is_gaddag = true;
+	return num_words_accepted;
+}
+
+/*
+	Slice of an in-memory word list to be built into a DAWG on its own thread: the shard
+	holds the entries [begin, end) of the word list, which are every word whose first
+	letter falls within some range, since the words are grouped by first letter.
+*/
+struct _rl_dawg_shard
+{
+	int32 begin;
+	int32 end;
+	const rl_wordlist* wordlist;
 	rl_dawg_ctx ctx;
-	rl_dawg_ctx_init(ctx);
+	int32 num_words_accepted;
+};
+
+static void _rl_dawg_shard_build(_rl_dawg_shard* shard)
+{
+	const rl_wordlist& wordlist = *shard->wordlist;
+	for (int32 word_index = shard->begin; word_index < shard->end; word_index++)
+	{
+		if (rl_dawg_ctx_add(shard->ctx, rl_wordlist_word(wordlist, word_index), wordlist.entries[word_index].len))
+		{
+			shard->num_words_accepted++;
+		}
+	}
+	rl_dawg_ctx_finalize(shard->ctx);
+}
+
+static void _rl_dawg_merge_shard(rl_dawg_ctx& ctx, const rl_nodearray& shard_nodearray, int32* index_map)
+{
+	// Walk the shard's (fully-minimized) nodes in post-order, so that every node's children have been mapped to their
+	// equivalents in the merged nodearray before we try to find an equivalent for the node itself
+	for (int32 node_index = 0; node_index < shard_nodearray.size; node_index++)
+	{
+		index_map[node_index] = -1;
+	}
 
-	// Read the file word-by-word, and feed each word into the DAWG context
+	int32 stack_nodes[RL_MAX_WORD_LEN + 1];
+	int32 stack_edges[RL_MAX_WORD_LEN + 1];
+	int32 stack_size = 1;
+	stack_nodes[0] = 0;
+	stack_edges[0] = 0;
+	while (stack_size > 0)
+	{
+		const int32 node_index = stack_nodes[stack_size - 1];
+		const rl_node& node = shard_nodearray.items[node_index];
+
+		// Descend into the next child that hasn't been mapped yet
+		int32& edge_pos = stack_edges[stack_size - 1];
+		if (edge_pos < node.next_by_letter.size)
+		{
+			const int32 child_index = node.next_by_letter.items[edge_pos].node_index;
+			edge_pos++;
+			if (index_map[child_index] < 0)
+			{
+				assert(stack_size < COUNT_OF(stack_nodes));
+				stack_nodes[stack_size] = child_index;
+				stack_edges[stack_size] = 0;
+				stack_size++;
+			}
+			continue;
+		}
+		stack_size--;
+
+		// The shard's root is never registered: its edges are merged directly into the root of the merged DAWG
+		if (node_index == 0)
+		{
+			for (int32 item_index = 0; item_index < node.next_by_letter.size; item_index++)
+			{
+				const rl_edgemap_item& item = node.next_by_letter.items[item_index];
+				rl_nodearray_insert_edge(ctx.nodearray, 0, static_cast<uint8>(item.letter), index_map[item.node_index]);
+			}
+			index_map[0] = 0;
+			continue;
+		}
+
+		// All children are mapped: append a copy of this node whose edges point into the merged nodearray, then
+		// discard that copy again if it turns out to be equivalent to a node we've already registered
+		const int32 new_index = rl_nodearray_push(ctx.nodearray, node.is_word);
+		for (int32 item_index = 0; item_index < node.next_by_letter.size; item_index++)
+		{
+			const rl_edgemap_item& item = node.next_by_letter.items[item_index];
+			assert(index_map[item.node_index] > 0);
+			rl_nodearray_insert_edge(ctx.nodearray, new_index, static_cast<uint8>(item.letter), index_map[item.node_index]);
+		}
+		const rl_node& new_node = ctx.nodearray.items[new_index];
+
+		const uint64 signature = rl_node_signature(new_node);
+		const int32 equivalent_node_index = rl_nodelookup_find(ctx.minimized_lookup, ctx.nodearray, new_node, signature);
+		if (equivalent_node_index >= 0)
+		{
+			rl_nodearray_pop(ctx.nodearray, new_index);
+			index_map[node_index] = equivalent_node_index;
+		}
+		else
+		{
+			rl_nodelookup_insert(ctx.minimized_lookup, signature, new_index);
+			index_map[node_index] = new_index;
+		}
+	}
+}
+
+int32 rl_dawg_build_parallel(rl_dawg& dawg, const char* wordlist_path, int32 num_threads)
+{
+	assert(dawg.nodearray.size == 0);
+	assert(!dawg.data);
+
+	// Read the entire word list into memory, so that every thread can scan it: we keep only the words that consist
+	// solely of 'a' through 'z', packing them into a single buffer and counting them by first letter so we can balance
+	// the shards. A word whose first letter comes before that of an earlier word is out of order, and rl_dawg_build
+	// would reject it; but no single shard would see both words, so we have to reject it here instead (still counting
+	// its letters toward the distribution, as rl_dawg_ctx_add does). Overlong words are dropped first, since they
+	// would otherwise hold back the first letter of every word after them.
+	rl_wordreader reader;
+	if (!rl_wordreader_open(reader, wordlist_path))
+	{
+		printf("WARNING: Could not open '%s' for read\n", wordlist_path);
+		return 0;
+	}
+	rl_wordlist wordlist;
+	rl_wordlist_init(wordlist, rl_wordreader_file_size(reader.fd));
+	int32 first_letter_counts[26] = { 0 };
+	uint32 rejected_letter_counts[26] = { 0 };
+	uint32 rejected_letter_counts_sum = 0;
+	uint8 prev_first_letter = 'a';
+	const uint8* word;
+	int32 word_len;
+	bool word_is_valid;
+	while (rl_wordreader_next(reader, word, word_len, word_is_valid))
+	{
+		if (!word_is_valid || word_len > RL_MAX_WORD_LEN)
+		{
+			continue;
+		}
+		if (word[0] < prev_first_letter)
+		{
+			printf("REJECT: %.*s\n", word_len, word);
+			for (int32 letter_index = 0; letter_index < word_len; letter_index++)
+			{
+				rejected_letter_counts[word[letter_index] - 'a']++;
+				rejected_letter_counts_sum++;
+			}
+			continue;
+		}
+		rl_wordlist_append(wordlist, word, word_len);
+		first_letter_counts[word[0] - 'a']++;
+		prev_first_letter = word[0];
+	}
+	const bool read_failed = reader.error;
+	rl_wordreader_free(reader);
+	if (read_failed)
+	{
+		rl_wordlist_free(wordlist);
+		return 0;
+	}
+
+	// Divide the alphabet into contiguous ranges of first letters, each holding roughly the same number of words: since
+	// the words are kept in order of their first letters, each range is a contiguous slice of the word list
+	_rl_dawg_shard shards[26];
+	int32 num_shards = 0;
+	const int32 max_shards = MAX(1, MIN(num_threads, 26));
+	{
+		const int32 target_words_per_shard = MAX(1, wordlist.num_entries / max_shards);
+		int32 shard_begin = 0;
+		int32 shard_end = 0;
+		for (int32 ordinal = 0; ordinal < 26; ordinal++)
+		{
+			shard_end += first_letter_counts[ordinal];
+			const bool is_last_letter = ordinal == 25;
+			const bool shard_is_full = shard_end - shard_begin >= target_words_per_shard && num_shards < max_shards - 1;
+			if (is_last_letter || shard_is_full)
+			{
+				_rl_dawg_shard& shard = shards[num_shards];
+				shard.begin = shard_begin;
+				shard.end = shard_end;
+				shard.wordlist = &wordlist;
+				shard.num_words_accepted = 0;
+				rl_dawg_ctx_init_arena(shard.ctx, wordlist.buf_size / max_shards);
+				num_shards++;
+
+				shard_begin = shard_end;
+			}
+		}
+		assert(shard_begin == wordlist.num_entries);
+	}
+
+	// Build each shard on its own thread (reusing the calling thread for the first shard)
+	std::thread threads[26];
+	for (int32 shard_index = 1; shard_index < num_shards; shard_index++)
+	{
+		threads[shard_index] = std::thread(_rl_dawg_shard_build, &shards[shard_index]);
+	}
+	_rl_dawg_shard_build(&shards[0]);
+	for (int32 shard_index = 1; shard_index < num_shards; shard_index++)
+	{
+		threads[shard_index].join();
+	}
+	const size_t wordlist_size = wordlist.buf_size;
+	rl_wordlist_free(wordlist);
+
+	// Merge the shards, in alphabetical order, into a single context, tallying up their letter counts as we go
+	rl_dawg_ctx ctx;
+	rl_dawg_ctx_init_arena(ctx, wordlist_size);
+	int32 max_shard_nodes = 0;
+	for (int32 shard_index = 0; shard_index < num_shards; shard_index++)
+	{
+		max_shard_nodes = MAX(max_shard_nodes, shards[shard_index].ctx.nodearray.size);
+	}
+	int32* index_map = reinterpret_cast<int32*>(malloc(max_shard_nodes * sizeof(int32)));
+	assert(index_map);
+
+	for (int32 i = 0; i < COUNT_OF(ctx.letter_counts); i++)
+	{
+		ctx.letter_counts[i] = rejected_letter_counts[i];
+	}
+	ctx.letter_counts_sum = rejected_letter_counts_sum;
 	int32 num_words_accepted = 0;
-	char temp[512];
-	while (fscanf(fp, "%511s", temp) == 1)
+	for (int32 shard_index = 0; shard_index < num_shards; shard_index++)
 	{
-		const uint8* word = reinterpret_cast<uint8*>(temp);
-		const int32 word_len = static_cast<int32>(strlen(temp));
-		if (rl_dawg_ctx_add(ctx, word, word_len))
+		_rl_dawg_shard& shard = shards[shard_index];
+		_rl_dawg_merge_shard(ctx, shard.ctx.nodearray, index_map);
+		for (int32 i = 0; i < COUNT_OF(ctx.letter_counts); i++)
 		{
-			num_words_accepted++;
+			ctx.letter_counts[i] += shard.ctx.letter_counts[i];
 		}
+		ctx.letter_counts_sum += shard.ctx.letter_counts_sum;
+		num_words_accepted += shard.num_words_accepted;
+		rl_dawg_ctx_free(shard.ctx);
 	}
-	fclose(fp);
+	free(index_map);
 
-	// Compute the frequency with which each letter appears in the input word list
+	// From here on, finish up exactly as rl_dawg_build does
 	rl_distribution_init(dawg.distribution, ctx.letter_counts, ctx.letter_counts_sum);
-
-	// Finish minimizing the DAWG, transfer ownership of the node aray into the rl_dawg, then free the context
-	rl_dawg_ctx_finalize(ctx);
 	rl_dawg_ctx_move_nodes(ctx, dawg);
 	rl_dawg_ctx_free(ctx);
+	rl_dawg_freeze(dawg);
+	dawg.num_words = num_words_accepted;
 	return num_words_accepted;
 }
@@ -0,0 +1,404 @@
+#include "rl_dawgeditor.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include "rl_util.h"
+#include "rl_node.h"
+#include "rl_edgepool.h"
+#include "rl_dawg.h"
+
+static bool _rl_dawgeditor_is_valid_word(const uint8* word, int32 word_len)
+{
+	if (!word || word_len <= 0 || word_len > RL_MAX_WORD_LEN)
+	{
+		return false;
+	}
+	for (int32 letter_index = 0; letter_index < word_len; letter_index++)
+	{
+		if (word[letter_index] < 'a' || word[letter_index] > 'z')
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static int32 _rl_dawgeditor_walk(const rl_dawgeditor& editor, const uint8* word, int32 word_len, int32* path)
+{
+	// Follow the word from the root for as long as we can, recording the index of each node along the way; returns the
+	// number of letters matched
+	path[0] = 0;
+	for (int32 letter_index = 0; letter_index < word_len; letter_index++)
+	{
+		const int32 next_index = rl_edgemap_find(editor.nodearray.items[path[letter_index]].next_by_letter, word[letter_index]);
+		if (next_index < 0)
+		{
+			return letter_index;
+		}
+		path[letter_index + 1] = next_index;
+	}
+	return word_len;
+}
+
+static int32 _rl_dawgeditor_new_node(rl_dawgeditor& editor, bool is_word)
+{
+	// Reuse a deleted node if we have one; otherwise append a new one, keeping in_degrees sized to match
+	int32 node_index;
+	if (editor.num_free_nodes > 0)
+	{
+		node_index = editor.free_nodes[--editor.num_free_nodes];
+		editor.nodearray.items[node_index].is_word = is_word;
+	}
+	else
+	{
+		node_index = rl_nodearray_push(editor.nodearray, is_word);
+		if (editor.nodearray.capacity > editor.in_degrees_capacity)
+		{
+			editor.in_degrees_capacity = editor.nodearray.capacity;
+			editor.in_degrees = reinterpret_cast<int32*>(realloc(editor.in_degrees, editor.in_degrees_capacity * sizeof(int32)));
+			assert(editor.in_degrees);
+		}
+	}
+	editor.in_degrees[node_index] = 0;
+	return node_index;
+}
+
+static void _rl_dawgeditor_delete_node(rl_dawgeditor& editor, int32 node_index)
+{
+	// The node must be unregistered and unreachable: release its edges, then put it on the free list
+	assert(node_index > 0 && editor.in_degrees[node_index] == 0);
+	rl_node& node = editor.nodearray.items[node_index];
+	for (int32 item_index = 0; item_index < node.next_by_letter.size; item_index++)
+	{
+		const int32 child_index = node.next_by_letter.items[item_index].node_index;
+		editor.in_degrees[child_index]--;
+		assert(editor.in_degrees[child_index] > 0);
+	}
+	node.is_word = false;
+	rl_edgemap_release(node.next_by_letter, *editor.nodearray.edgepool);
+
+	if (editor.num_free_nodes == editor.free_nodes_capacity)
+	{
+		editor.free_nodes_capacity = MAX(editor.free_nodes_capacity * 2, 64);
+		editor.free_nodes = reinterpret_cast<int32*>(realloc(editor.free_nodes, editor.free_nodes_capacity * sizeof(int32)));
+		assert(editor.free_nodes);
+	}
+	editor.free_nodes[editor.num_free_nodes++] = node_index;
+}
+
+static void _rl_dawgeditor_unregister(rl_dawgeditor& editor, int32 node_index)
+{
+	const rl_node& node = editor.nodearray.items[node_index];
+	const bool removed = rl_nodelookup_remove(editor.minimized_lookup, rl_node_signature(node), node_index);
+	assert(removed);
+	(void)removed;
+}
+
+static void _rl_dawgeditor_detach_path(rl_dawgeditor& editor, const uint8* word, int32* path, int32 path_len)
+{
+	// Prepare the nodes at path[1..path_len] to be modified: up to the first node that's shared with other paths, each
+	// node is unregistered (since its signature is about to change); from that node on, each node is replaced by a
+	// fresh, unregistered clone that only this path leads to
+	bool is_cloning = false;
+	for (int32 depth = 1; depth <= path_len; depth++)
+	{
+		const int32 node_index = path[depth];
+		if (!is_cloning && editor.in_degrees[node_index] > 1)
+		{
+			is_cloning = true;
+		}
+
+		if (!is_cloning)
+		{
+			_rl_dawgeditor_unregister(editor, node_index);
+			continue;
+		}
+
+		const int32 clone_index = _rl_dawgeditor_new_node(editor, editor.nodearray.items[node_index].is_word);
+		const rl_edgemap& edgemap = editor.nodearray.items[node_index].next_by_letter;
+		for (int32 item_index = 0; item_index < edgemap.size; item_index++)
+		{
+			const rl_edgemap_item& item = edgemap.items[item_index];
+			rl_nodearray_insert_edge(editor.nodearray, clone_index, static_cast<uint8>(item.letter), item.node_index);
+			editor.in_degrees[item.node_index]++;
+		}
+
+		rl_edgemap_replace(editor.nodearray.items[path[depth - 1]].next_by_letter, word[depth - 1], clone_index);
+		editor.in_degrees[node_index]--;
+		editor.in_degrees[clone_index] = 1;
+		path[depth] = clone_index;
+	}
+}
+
+static void _rl_dawgeditor_minimize_path(rl_dawgeditor& editor, const uint8* word, const int32* path, int32 path_len)
+{
+	// Working back toward the root, merge each node on the path into an equivalent registered node if there is one,
+	// or register it if not
+	for (int32 depth = path_len; depth > 0; depth--)
+	{
+		const int32 node_index = path[depth];
+		const rl_node& node = editor.nodearray.items[node_index];
+		const uint64 signature = rl_node_signature(node);
+		const int32 equivalent_node_index = rl_nodelookup_find(editor.minimized_lookup, editor.nodearray, node, signature);
+		if (equivalent_node_index >= 0)
+		{
+			assert(equivalent_node_index != node_index);
+			rl_edgemap_replace(editor.nodearray.items[path[depth - 1]].next_by_letter, word[depth - 1], equivalent_node_index);
+			editor.in_degrees[equivalent_node_index]++;
+			editor.in_degrees[node_index]--;
+			_rl_dawgeditor_delete_node(editor, node_index);
+		}
+		else
+		{
+			rl_nodelookup_insert(editor.minimized_lookup, signature, node_index);
+		}
+	}
+}
+
+void rl_dawgeditor_init(rl_dawgeditor& editor, const rl_dawg& dawg)
+{
+	assert(dawg.data);
+	assert(!dawg.packed);
+	assert(dawg.num_nodes > 0);
+	assert(!dawg.is_gaddag);
+
+	// Leave some headroom so that a batch of edits is unlikely to need to grow any of our arrays
+	const int32 num_nodes = dawg.num_nodes;
+	const int32 capacity = num_nodes + num_nodes / 8 + 64;
+	const size_t edge_slab_size = static_cast<size_t>(dawg.num_edges + num_nodes) * sizeof(rl_edgemap_item) * 2;
+	rl_nodearray_init_pooled(editor.nodearray, capacity, edge_slab_size);
+	rl_nodelookup_init(editor.minimized_lookup, capacity * 2);
+	editor.in_degrees_capacity = editor.nodearray.capacity;
+	editor.in_degrees = reinterpret_cast<int32*>(calloc(editor.in_degrees_capacity, sizeof(int32)));
+	assert(editor.in_degrees);
+	editor.free_nodes = nullptr;
+	editor.num_free_nodes = 0;
+	editor.free_nodes_capacity = 0;
+	editor.num_words = dawg.num_words;
+
+	// Thaw the frozen DAWG back into a nodearray: a node terminates a word if the edges leading into it say so
+	for (int32 node_index = 0; node_index < num_nodes; node_index++)
+	{
+		rl_nodearray_push(editor.nodearray, false);
+	}
+	for (int32 node_index = 0; node_index < num_nodes; node_index++)
+	{
+		const rl_edge* end = rl_dawg_edges_end(dawg, node_index);
+		for (const rl_edge* edge = rl_dawg_edges_begin(dawg, node_index); edge != end; edge++)
+		{
+			const int32 child_index = rl_edge_node_index(*edge);
+			rl_nodearray_insert_edge(editor.nodearray, node_index, rl_edge_letter(*edge), child_index);
+			editor.nodearray.items[child_index].is_word = rl_edge_is_word(*edge);
+			editor.in_degrees[child_index]++;
+		}
+	}
+
+	// The DAWG is already minimal, so every node other than the root can be registered as-is
+	for (int32 node_index = 1; node_index < num_nodes; node_index++)
+	{
+		rl_nodelookup_insert(editor.minimized_lookup, rl_node_signature(editor.nodearray.items[node_index]), node_index);
+	}
+}
+
+void rl_dawgeditor_free(rl_dawgeditor& editor)
+{
+	rl_nodearray_free(editor.nodearray);
+	rl_nodelookup_free(editor.minimized_lookup);
+	free(editor.in_degrees);
+	free(editor.free_nodes);
+}
+
+bool rl_dawgeditor_contains(const rl_dawgeditor& editor, const uint8* word, int32 word_len)
+{
+	if (!_rl_dawgeditor_is_valid_word(word, word_len))
+	{
+		return false;
+	}
+	int32 path[RL_MAX_WORD_LEN + 1];
+	if (_rl_dawgeditor_walk(editor, word, word_len, path) < word_len)
+	{
+		return false;
+	}
+	return editor.nodearray.items[path[word_len]].is_word;
+}
+
+bool rl_dawgeditor_add(rl_dawgeditor& editor, const uint8* word, int32 word_len)
+{
+	if (!_rl_dawgeditor_is_valid_word(word, word_len))
+	{
+		return false;
+	}
+
+	// Find the longest prefix of the word that's already in the DAWG, and bail out if the whole word is already there
+	int32 path[RL_MAX_WORD_LEN + 1];
+	const int32 prefix_len = _rl_dawgeditor_walk(editor, word, word_len, path);
+	if (prefix_len == word_len && editor.nodearray.items[path[word_len]].is_word)
+	{
+		return false;
+	}
+
+	// Make the prefix's path private to this word, then either mark its last node as a word, or extend it with a chain
+	// of new nodes for the rest of the word
+	_rl_dawgeditor_detach_path(editor, word, path, prefix_len);
+	if (prefix_len == word_len)
+	{
+		editor.nodearray.items[path[word_len]].is_word = true;
+	}
+	for (int32 depth = prefix_len; depth < word_len; depth++)
+	{
+		const int32 new_index = _rl_dawgeditor_new_node(editor, depth + 1 == word_len);
+		rl_nodearray_insert_edge(editor.nodearray, path[depth], word[depth], new_index);
+		editor.in_degrees[new_index] = 1;
+		path[depth + 1] = new_index;
+	}
+
+	_rl_dawgeditor_minimize_path(editor, word, path, word_len);
+	editor.num_words++;
+	return true;
+}
+
+bool rl_dawgeditor_remove(rl_dawgeditor& editor, const uint8* word, int32 word_len)
+{
+	if (!rl_dawgeditor_contains(editor, word, word_len))
+	{
+		return false;
+	}
+
+	// Make the word's path private, then unmark its last node as a word
+	int32 path[RL_MAX_WORD_LEN + 1];
+	_rl_dawgeditor_walk(editor, word, word_len, path);
+	_rl_dawgeditor_detach_path(editor, word, path, word_len);
+	editor.nodearray.items[path[word_len]].is_word = false;
+
+	// Trim off any nodes at the end of the path that no longer lead to any words
+	int32 path_len = word_len;
+	while (path_len > 0)
+	{
+		const int32 node_index = path[path_len];
+		const rl_node& node = editor.nodearray.items[node_index];
+		if (node.is_word || node.next_by_letter.size > 0)
+		{
+			break;
+		}
+		rl_edgemap_remove(editor.nodearray.items[path[path_len - 1]].next_by_letter, word[path_len - 1]);
+		editor.in_degrees[node_index]--;
+		_rl_dawgeditor_delete_node(editor, node_index);
+		path_len--;
+	}
+
+	_rl_dawgeditor_minimize_path(editor, word, path, path_len);
+	editor.num_words--;
+	return true;
+}
+
+int32 rl_dawgeditor_commit(const rl_dawgeditor& editor, rl_dawg& dawg)
+{
+	// Number the live nodes in post-order (every node after all of its children), skipping any deleted nodes: listing
+	// them in reverse then gives a topological order that starts with the root
+	const int32 num_slots = editor.nodearray.size;
+	int32* post_order = reinterpret_cast<int32*>(malloc(num_slots * sizeof(int32)));
+	int32* new_indices = reinterpret_cast<int32*>(malloc(num_slots * sizeof(int32)));
+	assert(post_order && new_indices);
+	for (int32 node_index = 0; node_index < num_slots; node_index++)
+	{
+		new_indices[node_index] = -1;
+	}
+
+	int32 num_live_nodes = 0;
+	{
+		int32 stack_nodes[RL_MAX_WORD_LEN + 1];
+		int32 stack_edges[RL_MAX_WORD_LEN + 1];
+		int32 stack_size = 1;
+		stack_nodes[0] = 0;
+		stack_edges[0] = 0;
+		new_indices[0] = 0;
+		while (stack_size > 0)
+		{
+			const rl_edgemap& edgemap = editor.nodearray.items[stack_nodes[stack_size - 1]].next_by_letter;
+			int32& edge_pos = stack_edges[stack_size - 1];
+			if (edge_pos < edgemap.size)
+			{
+				const int32 child_index = edgemap.items[edge_pos].node_index;
+				edge_pos++;
+				if (new_indices[child_index] < 0)
+				{
+					assert(stack_size < COUNT_OF(stack_nodes));
+					new_indices[child_index] = 0;
+					stack_nodes[stack_size] = child_index;
+					stack_edges[stack_size] = 0;
+					stack_size++;
+				}
+				continue;
+			}
+			post_order[num_live_nodes++] = stack_nodes[--stack_size];
+		}
+	}
+	for (int32 order = 0; order < num_live_nodes; order++)
+	{
+		new_indices[post_order[order]] = num_live_nodes - 1 - order;
+	}
+
+	// Count the words reachable from each node (children first), then the number of paths leading into each node from
+	// the root (parents first): every edge contributes its letter once for each word that passes through it
+	uint64* words_below = reinterpret_cast<uint64*>(malloc(num_slots * sizeof(uint64)));
+	uint64* paths_above = reinterpret_cast<uint64*>(calloc(num_slots, sizeof(uint64)));
+	assert(words_below && paths_above);
+	for (int32 order = 0; order < num_live_nodes; order++)
+	{
+		const rl_node& node = editor.nodearray.items[post_order[order]];
+		uint64 num_words = node.is_word ? 1 : 0;
+		for (int32 item_index = 0; item_index < node.next_by_letter.size; item_index++)
+		{
+			num_words += words_below[node.next_by_letter.items[item_index].node_index];
+		}
+		words_below[post_order[order]] = num_words;
+	}
+
+	uint32 letter_counts[26] = { 0 };
+	uint32 letter_counts_sum = 0;
+	paths_above[0] = 1;
+	for (int32 order = num_live_nodes - 1; order >= 0; order--)
+	{
+		const int32 node_index = post_order[order];
+		const rl_edgemap& edgemap = editor.nodearray.items[node_index].next_by_letter;
+		for (int32 item_index = 0; item_index < edgemap.size; item_index++)
+		{
+			const rl_edgemap_item& item = edgemap.items[item_index];
+			paths_above[item.node_index] += paths_above[node_index];
+			const uint32 count = static_cast<uint32>(paths_above[node_index] * words_below[item.node_index]);
+			letter_counts[item.letter - 'a'] += count;
+			letter_counts_sum += count;
+		}
+	}
+	free(words_below);
+	free(paths_above);
+
+	// Copy the live nodes into a fresh nodearray under their new indices, then replace the DAWG with a frozen copy
+	rl_dawg_free(dawg);
+	rl_dawg_init(dawg);
+	rl_nodearray_init(dawg.nodearray, num_live_nodes);
+	for (int32 node_index = 0; node_index < num_live_nodes; node_index++)
+	{
+		rl_nodearray_push(dawg.nodearray, false);
+	}
+	for (int32 order = 0; order < num_live_nodes; order++)
+	{
+		const rl_node& node = editor.nodearray.items[post_order[order]];
+		const int32 new_index = new_indices[post_order[order]];
+		dawg.nodearray.items[new_index].is_word = node.is_word;
+		for (int32 item_index = 0; item_index < node.next_by_letter.size; item_index++)
+		{
+			const rl_edgemap_item& item = node.next_by_letter.items[item_index];
+			rl_nodearray_insert_edge(dawg.nodearray, new_index, static_cast<uint8>(item.letter), new_indices[item.node_index]);
+		}
+	}
+	free(post_order);
+	free(new_indices);
+
+	rl_distribution_init(dawg.distribution, letter_counts, letter_counts_sum);
+	rl_dawg_freeze(dawg);
+	dawg.num_words = editor.num_words;
+	return dawg.num_words;
+}
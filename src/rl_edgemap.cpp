@@ -4,6 +4,8 @@
 #include <cstring>
 #include <cassert>
 
+#include "rl_edgepool.h"
+
 static rl_edgemap_item* _rl_edgemap_bsearch(const rl_edgemap& edgemap, uint8 letter)
 {
 	rl_edgemap_item* base = edgemap.items;
@@ -36,22 +38,58 @@ void rl_edgemap_free(rl_edgemap& edgemap)
 	free(edgemap.items);
 }
 
+static void _rl_edgemap_place(rl_edgemap& edgemap, uint8 letter, int32 node_index)
+{
+	// Items are kept sorted by letter: words are added in order, so a new edge almost always goes at the end
+	assert(edgemap.size < edgemap.capacity);
+	int32 new_index = edgemap.size;
+	while (new_index > 0 && edgemap.items[new_index - 1].letter > letter)
+	{
+		edgemap.items[new_index] = edgemap.items[new_index - 1];
+		new_index--;
+	}
+	assert(new_index == 0 || letter != edgemap.items[new_index - 1].letter);
+	rl_edgemap_item& item = edgemap.items[new_index];
+	item.letter = letter;
+	item.node_index = node_index;
+	edgemap.size++;
+}
+
 void rl_edgemap_insert(rl_edgemap& edgemap, uint8 letter, int32 node_index)
 {
 	if (edgemap.size == edgemap.capacity)
 	{
-		edgemap.capacity += 4;
+		edgemap.capacity += RL_EDGEMAP_CAPACITY_STEP;
 		rl_edgemap_item* new_items = reinterpret_cast<rl_edgemap_item*>(realloc(edgemap.items, edgemap.capacity * sizeof(rl_edgemap_item)));
 		assert(new_items);
 		edgemap.items = new_items;
 	}
+	_rl_edgemap_place(edgemap, letter, node_index);
+}
 
-	const int32 new_index = edgemap.size;
-	assert(new_index == 0 || letter > edgemap.items[new_index - 1].letter);
-	rl_edgemap_item& item = edgemap.items[new_index];
-	item.letter = letter;
-	item.node_index = node_index;
-	edgemap.size++;
+void rl_edgemap_insert_pooled(rl_edgemap& edgemap, rl_edgepool& edgepool, uint8 letter, int32 node_index)
+{
+	if (edgemap.size == edgemap.capacity)
+	{
+		rl_edgemap_item* new_items = rl_edgepool_alloc(edgepool, edgemap.capacity + RL_EDGEMAP_CAPACITY_STEP);
+		if (edgemap.items)
+		{
+			memcpy(new_items, edgemap.items, edgemap.size * sizeof(rl_edgemap_item));
+			rl_edgepool_release(edgepool, edgemap.items, edgemap.capacity);
+		}
+		edgemap.capacity += RL_EDGEMAP_CAPACITY_STEP;
+		edgemap.items = new_items;
+	}
+	_rl_edgemap_place(edgemap, letter, node_index);
+}
+
+void rl_edgemap_release(rl_edgemap& edgemap, rl_edgepool& edgepool)
+{
+	if (edgemap.items)
+	{
+		rl_edgepool_release(edgepool, edgemap.items, edgemap.capacity);
+	}
+	rl_edgemap_init(edgemap);
 }
 
 int32 rl_edgemap_find(const rl_edgemap& edgemap, uint8 letter)
@@ -70,3 +108,12 @@ void rl_edgemap_replace(rl_edgemap& edgemap, uint8 letter, int32 node_index)
 	assert(found);
 	found->node_index = node_index;
 }
+
+void rl_edgemap_remove(rl_edgemap& edgemap, uint8 letter)
+{
+	rl_edgemap_item* found = _rl_edgemap_bsearch(edgemap, letter);
+	assert(found);
+	const rl_edgemap_item* end = edgemap.items + edgemap.size;
+	memmove(found, found + 1, (end - (found + 1)) * sizeof(rl_edgemap_item));
+	edgemap.size--;
+}
@@ -0,0 +1,90 @@
+#include "rl_edgepool.h"
+
+#include <cstdlib>
+#include <cassert>
+
+#include "rl_edgemap.h"
+
+static const size_t _RL_EDGEPOOL_MIN_SLAB_SIZE = 64 * 1024;
+
+static int32 _rl_edgepool_class(int32 capacity)
+{
+	assert(capacity > 0 && capacity % RL_EDGEMAP_CAPACITY_STEP == 0);
+	const int32 size_class = capacity / RL_EDGEMAP_CAPACITY_STEP - 1;
+	assert(size_class < RL_EDGEPOOL_NUM_CLASSES);
+	return size_class;
+}
+
+static void _rl_edgepool_add_slab(rl_edgepool& edgepool, size_t min_size)
+{
+	while (edgepool.next_slab_size < min_size + sizeof(rl_edgepool_slab))
+	{
+		edgepool.next_slab_size *= 2;
+	}
+
+	rl_edgepool_slab* slab = reinterpret_cast<rl_edgepool_slab*>(malloc(edgepool.next_slab_size));
+	assert(slab);
+	slab->prev = edgepool.slabs;
+	edgepool.slabs = slab;
+
+	edgepool.bump = reinterpret_cast<uint8*>(slab) + sizeof(rl_edgepool_slab);
+	edgepool.bump_end = reinterpret_cast<uint8*>(slab) + edgepool.next_slab_size;
+	edgepool.next_slab_size *= 2;
+}
+
+void rl_edgepool_init(rl_edgepool& edgepool, size_t initial_slab_size)
+{
+	for (int32 size_class = 0; size_class < RL_EDGEPOOL_NUM_CLASSES; size_class++)
+	{
+		edgepool.free_lists[size_class] = nullptr;
+	}
+	edgepool.slabs = nullptr;
+	edgepool.bump = nullptr;
+	edgepool.bump_end = nullptr;
+	edgepool.next_slab_size = initial_slab_size > _RL_EDGEPOOL_MIN_SLAB_SIZE ? initial_slab_size : _RL_EDGEPOOL_MIN_SLAB_SIZE;
+	_rl_edgepool_add_slab(edgepool, 0);
+}
+
+void rl_edgepool_free(rl_edgepool& edgepool)
+{
+	rl_edgepool_slab* slab = edgepool.slabs;
+	while (slab)
+	{
+		rl_edgepool_slab* prev = slab->prev;
+		free(slab);
+		slab = prev;
+	}
+	edgepool.slabs = nullptr;
+}
+
+rl_edgemap_item* rl_edgepool_alloc(rl_edgepool& edgepool, int32 capacity)
+{
+	// Prefer recycling a block of the same size class
+	const int32 size_class = _rl_edgepool_class(capacity);
+	void* block = edgepool.free_lists[size_class];
+	if (block)
+	{
+		edgepool.free_lists[size_class] = *reinterpret_cast<void**>(block);
+		return reinterpret_cast<rl_edgemap_item*>(block);
+	}
+
+	// Otherwise bump-allocate from the current slab, starting a new slab if this one is exhausted
+	const size_t size = capacity * sizeof(rl_edgemap_item);
+	if (static_cast<size_t>(edgepool.bump_end - edgepool.bump) < size)
+	{
+		_rl_edgepool_add_slab(edgepool, size);
+	}
+	rl_edgemap_item* items = reinterpret_cast<rl_edgemap_item*>(edgepool.bump);
+	edgepool.bump += size;
+	return items;
+}
+
+void rl_edgepool_release(rl_edgepool& edgepool, rl_edgemap_item* items, int32 capacity)
+{
+	static_assert(RL_EDGEMAP_CAPACITY_STEP * sizeof(rl_edgemap_item) >= sizeof(void*), "free blocks must fit a pointer");
+
+	const int32 size_class = _rl_edgepool_class(capacity);
+	void* block = items;
+	*reinterpret_cast<void**>(block) = edgepool.free_lists[size_class];
+	edgepool.free_lists[size_class] = block;
+}
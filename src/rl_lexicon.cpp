@@ -0,0 +1,167 @@
+#include "rl_lexicon.h"
+
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+
+#include <mutex>
+#include <condition_variable>
+
+// Every lexicon in the process, guarded by a single lock that's held only while the list or a lexicon's bookkeeping
+// is being changed: loading and unloading happen outside the lock
+static std::mutex _rl_lexicon_mutex;
+static std::condition_variable _rl_lexicon_loaded_cond;
+static rl_lexicon* _rl_lexicon_head = nullptr;
+
+static bool _rl_lexicon_unref_locked(rl_lexicon* lexicon)
+{
+	// Drop a reference, unlinking the lexicon from the registry if that was the last one: returns true if the caller
+	// should then free it
+	assert(lexicon->ref_count > 0);
+	if (--lexicon->ref_count > 0)
+	{
+		return false;
+	}
+	rl_lexicon** link = &_rl_lexicon_head;
+	while (*link != lexicon)
+	{
+		link = &(*link)->next;
+	}
+	*link = lexicon->next;
+	return true;
+}
+
+static void _rl_lexicon_free(rl_lexicon* lexicon)
+{
+	rl_dawg_free(lexicon->dawg);
+	free(lexicon->path);
+	free(lexicon);
+}
+
+static bool _rl_lexicon_load(rl_lexicon* lexicon)
+{
+	rl_dawg& dawg = lexicon->dawg;
+	if (lexicon->flags & RL_LEXICON_MAPPED)
+	{
+		rl_dawg_load_mapped(dawg, lexicon->path);
+	}
+	else if (lexicon->flags & RL_LEXICON_GADDAG)
+	{
+		rl_dawg_build_gaddag(dawg, lexicon->path);
+	}
+	else
+	{
+		rl_dawg_build(dawg, lexicon->path);
+	}
+	if (!dawg.data)
+	{
+		return false;
+	}
+
+	if (lexicon->flags & RL_LEXICON_PACKED)
+	{
+		rl_dawg packed;
+		rl_dawg_init(packed);
+		rl_dawg_pack(dawg, packed);
+		rl_dawg_free(dawg);
+		dawg = packed;
+	}
+	return true;
+}
+
+const rl_lexicon* rl_lexicon_acquire(const char* path, uint32 flags)
+{
+	std::unique_lock<std::mutex> lock(_rl_lexicon_mutex);
+
+	// If someone else already holds this lexicon, share it, waiting for it to finish loading if need be
+	for (rl_lexicon* lexicon = _rl_lexicon_head; lexicon; lexicon = lexicon->next)
+	{
+		if (lexicon->flags == flags && strcmp(lexicon->path, path) == 0)
+		{
+			lexicon->ref_count++;
+			while (lexicon->loading)
+			{
+				_rl_lexicon_loaded_cond.wait(lock);
+			}
+			if (lexicon->loaded)
+			{
+				return lexicon;
+			}
+			const bool should_free = _rl_lexicon_unref_locked(lexicon);
+			lock.unlock();
+			if (should_free)
+			{
+				_rl_lexicon_free(lexicon);
+			}
+			return nullptr;
+		}
+	}
+
+	// Otherwise, register it right away so that anyone else asking for it waits for us, then load it without holding
+	// the lock
+	rl_lexicon* lexicon = reinterpret_cast<rl_lexicon*>(malloc(sizeof(rl_lexicon)));
+	assert(lexicon);
+	rl_dawg_init(lexicon->dawg);
+	const size_t path_size = strlen(path) + 1;
+	lexicon->path = reinterpret_cast<char*>(malloc(path_size));
+	assert(lexicon->path);
+	memcpy(lexicon->path, path, path_size);
+	lexicon->flags = flags;
+	lexicon->ref_count = 1;
+	lexicon->loading = true;
+	lexicon->loaded = false;
+	lexicon->next = _rl_lexicon_head;
+	_rl_lexicon_head = lexicon;
+	lock.unlock();
+
+	const bool loaded = _rl_lexicon_load(lexicon);
+
+	lock.lock();
+	lexicon->loading = false;
+	lexicon->loaded = loaded;
+	_rl_lexicon_loaded_cond.notify_all();
+	if (loaded)
+	{
+		return lexicon;
+	}
+	const bool should_free = _rl_lexicon_unref_locked(lexicon);
+	lock.unlock();
+	if (should_free)
+	{
+		_rl_lexicon_free(lexicon);
+	}
+	return nullptr;
+}
+
+const rl_lexicon* rl_lexicon_retain(const rl_lexicon* lexicon)
+{
+	std::lock_guard<std::mutex> lock(_rl_lexicon_mutex);
+	assert(lexicon->loaded && lexicon->ref_count > 0);
+	const_cast<rl_lexicon*>(lexicon)->ref_count++;
+	return lexicon;
+}
+
+void rl_lexicon_release(const rl_lexicon* lexicon)
+{
+	rl_lexicon* mutable_lexicon = const_cast<rl_lexicon*>(lexicon);
+	bool should_free;
+	{
+		std::lock_guard<std::mutex> lock(_rl_lexicon_mutex);
+		should_free = _rl_lexicon_unref_locked(mutable_lexicon);
+	}
+	if (should_free)
+	{
+		_rl_lexicon_free(mutable_lexicon);
+	}
+}
+
+int32 rl_lexicon_num_loaded()
+{
+	std::lock_guard<std::mutex> lock(_rl_lexicon_mutex);
+	int32 num_loaded = 0;
+	for (const rl_lexicon* lexicon = _rl_lexicon_head; lexicon; lexicon = lexicon->next)
+	{
+		num_loaded++;
+	}
+	return num_loaded;
+}
@@ -2,6 +2,8 @@
 
 #include <cstring>
 
+#include "rl_board.h"
+
 void rl_move_init(rl_move& move)
 {
 	memset(move.word, 0, sizeof(move.word));
@@ -9,3 +11,22 @@ void rl_move_init(rl_move& move)
 
 	rl_rack_init(move.letters_used);
 }
+
+void rl_move_set(rl_move& move, const rl_board& board, int32 index, int32 offset, const uint8* word, int32 word_len)
+{
+	move.index = index;
+	move.offset = offset;
+	memcpy(move.word, word, word_len);
+	move.word_len = word_len;
+
+	rl_rack_init(move.letters_used);
+	int32 square_index = index;
+	for (int32 letter_index = 0; letter_index < word_len; letter_index++)
+	{
+		if (word[letter_index] != board.letters[square_index])
+		{
+			rl_rack_push(move.letters_used, word[letter_index]);
+		}
+		square_index += offset;
+	}
+}
@@ -3,6 +3,7 @@
 #include "rl_util.h"
 
 #include <cassert>
+#include <cstring>
 
 static const uint64 _FNV_PRIME = 0x100000001b3;
 static const uint64 _FNV_OFFSET_BASIS = 0xcbf29ce484222325;
@@ -49,3 +50,13 @@ uint64 rl_node_signature(const rl_node& node)
 	const int32 edgemap_bytes_size = node.next_by_letter.size * sizeof(rl_edgemap_item);
 	return _fnv1a(start, edgemap_bytes, edgemap_bytes_size);
 }
+
+bool rl_node_equals(const rl_node& lhs, const rl_node& rhs)
+{
+	if (lhs.is_word != rhs.is_word || lhs.next_by_letter.size != rhs.next_by_letter.size)
+	{
+		return false;
+	}
+	const size_t edgemap_bytes_size = lhs.next_by_letter.size * sizeof(rl_edgemap_item);
+	return edgemap_bytes_size == 0 || memcmp(lhs.next_by_letter.items, rhs.next_by_letter.items, edgemap_bytes_size) == 0;
+}
@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "rl_node.h"
+#include "rl_edgepool.h"
 
 void rl_nodearray_init(rl_nodearray& nodearray, int32 capacity)
 {
@@ -12,16 +13,35 @@ void rl_nodearray_init(rl_nodearray& nodearray, int32 capacity)
 	nodearray.capacity = capacity;
 	nodearray.size = 0;
 	nodearray.items = reinterpret_cast<rl_node*>(malloc(nodearray.capacity * sizeof(rl_node)));
+	nodearray.edgepool = nullptr;
 
 	assert(nodearray.items);
 }
 
+void rl_nodearray_init_pooled(rl_nodearray& nodearray, int32 capacity, size_t edge_slab_size)
+{
+	rl_nodearray_init(nodearray, capacity);
+
+	nodearray.edgepool = reinterpret_cast<rl_edgepool*>(malloc(sizeof(rl_edgepool)));
+	assert(nodearray.edgepool);
+	rl_edgepool_init(*nodearray.edgepool, edge_slab_size);
+}
+
 void rl_nodearray_free(rl_nodearray& nodearray)
 {
-	for (int32 node_index = 0; node_index < nodearray.size; node_index++)
+	if (nodearray.edgepool)
 	{
-		rl_node& node = nodearray.items[node_index];
-		rl_node_free(node);
+		// All edgemaps live in the pool's slabs, so they're released together
+		rl_edgepool_free(*nodearray.edgepool);
+		free(nodearray.edgepool);
+	}
+	else
+	{
+		for (int32 node_index = 0; node_index < nodearray.size; node_index++)
+		{
+			rl_node& node = nodearray.items[node_index];
+			rl_node_free(node);
+		}
 	}
 	free(nodearray.items);
 }
@@ -46,6 +66,29 @@ int32 rl_nodearray_push(rl_nodearray& nodearray, bool is_word)
 void rl_nodearray_pop(rl_nodearray& nodearray, int32 back_index)
 {
 	assert(back_index == nodearray.size - 1);
-	rl_node_reset(nodearray.items[nodearray.size - 1]);
+	rl_node& node = nodearray.items[nodearray.size - 1];
+	if (nodearray.edgepool)
+	{
+		node.is_word = false;
+		rl_edgemap_release(node.next_by_letter, *nodearray.edgepool);
+	}
+	else
+	{
+		rl_node_reset(node);
+	}
 	nodearray.size--;
 }
+
+void rl_nodearray_insert_edge(rl_nodearray& nodearray, int32 node_index, uint8 letter, int32 to_index)
+{
+	assert(node_index >= 0 && node_index < nodearray.size);
+	rl_edgemap& edgemap = nodearray.items[node_index].next_by_letter;
+	if (nodearray.edgepool)
+	{
+		rl_edgemap_insert_pooled(edgemap, *nodearray.edgepool, letter, to_index);
+	}
+	else
+	{
+		rl_edgemap_insert(edgemap, letter, to_index);
+	}
+}
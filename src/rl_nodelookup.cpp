@@ -2,79 +2,139 @@
 
 #include <cstdlib>
 #include <cassert>
-#include <cstring>
-#include <cstdio>
 
-void rl_nodelookup_init(rl_nodelookup& nodelookup, int32 capacity)
+#include "rl_node.h"
+#include "rl_nodearray.h"
+
+static int32 _rl_nodelookup_start_slot(const rl_nodelookup& nodelookup, uint64 signature)
 {
-	assert(capacity > 0);
+	// Fold the high bits of the signature into the low bits before masking, so every bit of the hash contributes
+	return static_cast<int32>((signature ^ (signature >> 32)) & static_cast<uint64>(nodelookup.capacity - 1));
+}
+
+static void _rl_nodelookup_place(rl_nodelookup& nodelookup, uint64 signature, int32 node_index)
+{
+	const int32 mask = nodelookup.capacity - 1;
+	int32 slot = _rl_nodelookup_start_slot(nodelookup, signature);
+	while (nodelookup.items[slot].node_index >= 0)
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	rl_nodelookup_item& item = nodelookup.items[slot];
+	item.signature = signature;
+	item.node_index = node_index;
+	nodelookup.size++;
+}
 
+static void _rl_nodelookup_alloc(rl_nodelookup& nodelookup, int32 capacity)
+{
 	nodelookup.capacity = capacity;
-	nodelookup.buckets = reinterpret_cast<rl_nodelookup_item**>(malloc(nodelookup.capacity * sizeof(rl_nodelookup_item*)));
-	assert(nodelookup.buckets);
+	nodelookup.size = 0;
+	nodelookup.items = reinterpret_cast<rl_nodelookup_item*>(malloc(capacity * sizeof(rl_nodelookup_item)));
+	assert(nodelookup.items);
 
-	memset(nodelookup.buckets, 0, nodelookup.capacity * sizeof(rl_nodelookup_item*));
-	assert(!nodelookup.buckets[0]);
+	for (int32 slot = 0; slot < capacity; slot++)
+	{
+		nodelookup.items[slot].signature = 0;
+		nodelookup.items[slot].node_index = -1;
+	}
 }
 
-void rl_nodelookup_free(rl_nodelookup& nodelookup)
+void rl_nodelookup_init(rl_nodelookup& nodelookup, int32 capacity)
 {
-	for (int32 bucket_index = 0; bucket_index < nodelookup.capacity; bucket_index++)
+	assert(capacity > 0);
+
+	int32 pow2_capacity = 1;
+	while (pow2_capacity < capacity)
 	{
-		rl_nodelookup_item* item = nodelookup.buckets[bucket_index];
-		while (item)
-		{
-			rl_nodelookup_item* temp = item;
-			item = item->next;
-			free(temp);
-		}
+		pow2_capacity <<= 1;
 	}
-	free(nodelookup.buckets);
+	_rl_nodelookup_alloc(nodelookup, pow2_capacity);
+}
+
+void rl_nodelookup_free(rl_nodelookup& nodelookup)
+{
+	free(nodelookup.items);
 }
 
 void rl_nodelookup_insert(rl_nodelookup& nodelookup, uint64 signature, int32 node_index)
 {
-	const int32 bucket_index = signature % nodelookup.capacity;
-	rl_nodelookup_item* item = nodelookup.buckets[bucket_index];
+	assert(node_index >= 0);
 
-	rl_nodelookup_item* base = nullptr;
-	while (item)
+	// Keep the load factor at or below 70%, doubling the table and re-placing every item once we'd exceed it
+	if ((static_cast<uint64>(nodelookup.size) + 1) * 10 > static_cast<uint64>(nodelookup.capacity) * 7)
 	{
-		if (item->signature == signature)
+		const rl_nodelookup_item* old_items = nodelookup.items;
+		const int32 old_capacity = nodelookup.capacity;
+		_rl_nodelookup_alloc(nodelookup, old_capacity * 2);
+		for (int32 slot = 0; slot < old_capacity; slot++)
 		{
-			printf("WARNING: Duplicate node with signature %" PRIu64 "\n", signature);
-			return;
+			if (old_items[slot].node_index >= 0)
+			{
+				_rl_nodelookup_place(nodelookup, old_items[slot].signature, old_items[slot].node_index);
+			}
 		}
-		base = item;
-		item = item->next;
+		free(const_cast<rl_nodelookup_item*>(old_items));
 	}
 
-	item = reinterpret_cast<rl_nodelookup_item*>(malloc(sizeof(rl_nodelookup_item)));
-	item->next = nullptr;
-	item->signature = signature;
-	item->node_index = node_index;
-	if (base)
-	{
-		assert(!base->next);
-		base->next = item;
-	}
-	else
+	_rl_nodelookup_place(nodelookup, signature, node_index);
+}
+
+int32 rl_nodelookup_find(const rl_nodelookup& nodelookup, const rl_nodearray& nodearray, const rl_node& node, uint64 signature)
+{
+	const int32 mask = nodelookup.capacity - 1;
+	int32 slot = _rl_nodelookup_start_slot(nodelookup, signature);
+	while (true)
 	{
-		nodelookup.buckets[bucket_index] = item;
+		const rl_nodelookup_item& item = nodelookup.items[slot];
+		if (item.node_index < 0)
+		{
+			return -1;
+		}
+		if (item.signature == signature)
+		{
+			assert(item.node_index < nodearray.size);
+			if (rl_node_equals(nodearray.items[item.node_index], node))
+			{
+				return item.node_index;
+			}
+		}
+		slot = (slot + 1) & mask;
 	}
 }
 
-int32 rl_nodelookup_find(const rl_nodelookup& nodelookup, uint64 signature)
+bool rl_nodelookup_remove(rl_nodelookup& nodelookup, uint64 signature, int32 node_index)
 {
-	const int32 bucket_index = signature % nodelookup.capacity;
-	rl_nodelookup_item* item = nodelookup.buckets[bucket_index];
-	while (item)
+	// Find the slot holding this exact node
+	const int32 mask = nodelookup.capacity - 1;
+	int32 slot = _rl_nodelookup_start_slot(nodelookup, signature);
+	while (nodelookup.items[slot].node_index != node_index)
+	{
+		if (nodelookup.items[slot].node_index < 0)
+		{
+			return false;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	// Empty it, then shift back any later items in the same cluster that could no longer be reached by probing from
+	// their start slot, so that lookups never stop early at the hole we've left
+	int32 hole = slot;
+	int32 next = (hole + 1) & mask;
+	while (nodelookup.items[next].node_index >= 0)
 	{
-		if (item->signature == signature)
+		const int32 start = _rl_nodelookup_start_slot(nodelookup, nodelookup.items[next].signature);
+		const bool start_is_after_hole = ((next - start) & mask) < ((next - hole) & mask);
+		if (!start_is_after_hole)
 		{
-			return item->node_index;
+			nodelookup.items[hole] = nodelookup.items[next];
+			hole = next;
 		}
-		item = item->next;
+		next = (next + 1) & mask;
 	}
-	return -1;
+	nodelookup.items[hole].signature = 0;
+	nodelookup.items[hole].node_index = -1;
+	nodelookup.size--;
+	return true;
 }
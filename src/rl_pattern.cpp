@@ -0,0 +1,450 @@
+#include "rl_pattern.h"
+
+#include <cstring>
+#include <cassert>
+
+#include "rl_util.h"
+#include "rl_dawg.h"
+#include "rl_rack.h"
+#include "rl_board.h"
+#include "rl_search.h"
+
+struct rl_pattern_ctx
+{
+	const rl_dawg* dawg;
+	const rl_pattern* pattern;
+
+	// Letters that words may still use, if the query has a rack: the rack plus the letters fixed by the pattern
+	bool use_pool;
+	uint8 pool_counts[26];
+	int32 pool_sum;
+	uint32 pool_letters;
+
+	// Whether we're matching the pattern backward through a GADDAG's reversed words, rather than forward
+	bool backward;
+
+	// The word so far, and when going backward, a buffer to spell it back out in the right order
+	uint8 s[RL_MAX_WORD_LEN];
+	uint8 reversed[RL_MAX_WORD_LEN];
+
+	rl_pattern_visit_fn visit;
+	void* user_data;
+	int32 num_matches;
+	bool stopped;
+
+	uint64 num_nodes_visited;
+	uint64 num_nodes_pruned;
+	uint32* node_visits;
+};
+
+static void _rl_pattern_reset(rl_pattern& pattern)
+{
+	memset(&pattern, 0, sizeof(pattern));
+}
+
+static void _rl_pattern_push(rl_pattern& pattern, uint32 letters, bool is_gap)
+{
+	assert(pattern.num_elements < RL_PATTERN_MAX_ELEMENTS);
+	if (is_gap)
+	{
+		pattern.gaps |= static_cast<uint64>(1) << pattern.num_elements;
+	}
+	pattern.element_letters[pattern.num_elements++] = letters;
+}
+
+static void _rl_pattern_finish(rl_pattern& pattern)
+{
+	// Tabulate, for each letter, which elements it lets us step past and which gaps it lets us stay in
+	memset(pattern.advance, 0, sizeof(pattern.advance));
+	memset(pattern.stay, 0, sizeof(pattern.stay));
+	memset(pattern.fixed_counts, 0, sizeof(pattern.fixed_counts));
+	for (int32 element_index = 0; element_index < pattern.num_elements; element_index++)
+	{
+		const uint64 bit = static_cast<uint64>(1) << element_index;
+		const uint32 letters = pattern.element_letters[element_index];
+		for (int32 ordinal = 0; ordinal < 26; ordinal++)
+		{
+			if (letters & (1u << ordinal))
+			{
+				if (pattern.gaps & bit)
+				{
+					pattern.stay[ordinal] |= bit;
+				}
+				else
+				{
+					pattern.advance[ordinal] |= bit;
+				}
+			}
+		}
+		if ((pattern.gaps & bit) == 0 && rl_popcount(letters) == 1)
+		{
+			pattern.fixed_counts[rl_ctz(letters)]++;
+		}
+	}
+
+	// Working back from the end, total up what the rest of the pattern demands of any word that matches it
+	pattern.min_remaining[pattern.num_elements] = 0;
+	pattern.gap_remaining[pattern.num_elements] = false;
+	pattern.required_letters[pattern.num_elements] = 0;
+	for (int32 element_index = pattern.num_elements - 1; element_index >= 0; element_index--)
+	{
+		const bool is_gap = (pattern.gaps & (static_cast<uint64>(1) << element_index)) != 0;
+		const uint32 letters = pattern.element_letters[element_index];
+		pattern.min_remaining[element_index] = pattern.min_remaining[element_index + 1] + (is_gap ? 0 : 1);
+		pattern.gap_remaining[element_index] = pattern.gap_remaining[element_index + 1] || is_gap;
+		pattern.required_letters[element_index] = pattern.required_letters[element_index + 1];
+		if (!is_gap && rl_popcount(letters) == 1)
+		{
+			pattern.required_letters[element_index] |= letters;
+		}
+	}
+}
+
+static void _rl_pattern_reverse(const rl_pattern& pattern, rl_pattern& out_reversed)
+{
+	_rl_pattern_reset(out_reversed);
+	for (int32 element_index = pattern.num_elements - 1; element_index >= 0; element_index--)
+	{
+		const bool is_gap = (pattern.gaps & (static_cast<uint64>(1) << element_index)) != 0;
+		_rl_pattern_push(out_reversed, pattern.element_letters[element_index], is_gap);
+	}
+	_rl_pattern_finish(out_reversed);
+}
+
+static uint64 _rl_pattern_closure(const rl_pattern& pattern, uint64 states)
+{
+	// A gap can match nothing at all, so being at a gap also puts us at the element after it
+	while (true)
+	{
+		const uint64 skipped = (states & pattern.gaps) << 1;
+		if ((skipped & ~states) == 0)
+		{
+			return states;
+		}
+		states |= skipped;
+	}
+}
+
+static uint64 _rl_pattern_step(const rl_pattern& pattern, uint64 states, uint32 ordinal)
+{
+	// Each state is an element we could be at: matching a letter moves us past a single-letter element, or keeps us in
+	// a gap
+	const uint64 next = ((states & pattern.advance[ordinal]) << 1) | (states & pattern.stay[ordinal]);
+	return _rl_pattern_closure(pattern, next);
+}
+
+static int32 _rl_pattern_lowest_state(uint64 states)
+{
+	assert(states != 0);
+	const uint32 low = static_cast<uint32>(states);
+	return low != 0 ? rl_ctz(low) : 32 + rl_ctz(static_cast<uint32>(states >> 32));
+}
+
+static int32 _rl_pattern_highest_state(uint64 states)
+{
+	assert(states != 0);
+	int32 element_index = 63;
+	while ((states & (static_cast<uint64>(1) << element_index)) == 0)
+	{
+		element_index--;
+	}
+	return element_index;
+}
+
+static uint32 _rl_pattern_state_letters(const rl_pattern& pattern, uint64 states)
+{
+	// Union of the letters that could come next from any of the given states
+	uint32 letters = 0;
+	while (states != 0)
+	{
+		letters |= pattern.element_letters[_rl_pattern_lowest_state(states)];
+		states &= states - 1;
+	}
+	return letters;
+}
+
+static bool _rl_pattern_can_prune(const rl_pattern_ctx& ctx, int32 node_index, uint64 states)
+{
+	// Whichever state we end up matching from, the rest of the word needs at least as many letters as the furthest
+	// state demands, and at most as many as the nearest one allows, along with the letters that all of them require.
+	// If no word below this node fits, or could be spelled from what's left of the pool, there's nothing to find.
+	const rl_pattern& pattern = *ctx.pattern;
+	const int32 nearest = _rl_pattern_lowest_state(states);
+	const int32 furthest = _rl_pattern_highest_state(states);
+	const int32 min_needed = MAX(pattern.min_remaining[furthest], 1);
+	const uint32 required_letters = pattern.required_letters[furthest];
+	if (!pattern.gap_remaining[nearest] && pattern.min_remaining[nearest] < min_needed)
+	{
+		return true;
+	}
+	if (ctx.use_pool && (min_needed > ctx.pool_sum || (required_letters & ~ctx.pool_letters) != 0))
+	{
+		return true;
+	}
+
+	// A packed DAWG keeps no summaries, so there's nothing more to go on
+	if (!ctx.dawg->node_summaries)
+	{
+		return false;
+	}
+	const rl_node_summary& summary = ctx.dawg->node_summaries[node_index];
+	if (summary.max_len < min_needed || (required_letters & ~summary.letters) != 0)
+	{
+		return true;
+	}
+	return !pattern.gap_remaining[nearest] && summary.min_len > pattern.min_remaining[nearest];
+}
+
+static void _rl_pattern_emit(rl_pattern_ctx& ctx, int32 word_len)
+{
+	// Words found backward are spelled in reverse, so spell them back out forward for the caller
+	const uint8* word = ctx.s;
+	if (ctx.backward)
+	{
+		for (int32 letter_index = 0; letter_index < word_len; letter_index++)
+		{
+			ctx.reversed[letter_index] = ctx.s[word_len - 1 - letter_index];
+		}
+		word = ctx.reversed;
+	}
+	ctx.num_matches++;
+	if (!ctx.visit(word, word_len, ctx.user_data))
+	{
+		ctx.stopped = true;
+	}
+}
+
+static void _rl_pattern_walk(rl_pattern_ctx& ctx, int32 s_len, int32 node_index, uint64 states)
+{
+	// states holds every element of the pattern that the s_len letters so far could have brought us to, and node_index
+	// is the DAWG node those letters lead to: only letters that can come next from one of those elements, and that
+	// label an edge out of the node, can lead to a match
+	const rl_pattern& pattern = *ctx.pattern;
+	if (s_len == static_cast<int32>(RL_MAX_WORD_LEN) || _rl_pattern_can_prune(ctx, node_index, states))
+	{
+		ctx.num_nodes_pruned++;
+		return;
+	}
+	ctx.num_nodes_visited++;
+	if (ctx.node_visits)
+	{
+		ctx.node_visits[node_index]++;
+	}
+
+	const uint32 node_mask = rl_dawg_node_mask(*ctx.dawg, node_index);
+	uint32 playable = node_mask & _rl_pattern_state_letters(pattern, states);
+	if (ctx.use_pool)
+	{
+		playable &= ctx.pool_letters;
+	}
+	const uint64 accept = static_cast<uint64>(1) << pattern.num_elements;
+	while (playable != 0 && !ctx.stopped)
+	{
+		const uint32 ordinal = static_cast<uint32>(rl_ctz(playable));
+		playable &= playable - 1;
+		const uint64 next_states = _rl_pattern_step(pattern, states, ordinal);
+		assert(next_states != 0);
+
+		if (ctx.use_pool)
+		{
+			ctx.pool_sum--;
+			if (--ctx.pool_counts[ordinal] == 0)
+			{
+				ctx.pool_letters &= ~(1u << ordinal);
+			}
+		}
+
+		const rl_edge edge = rl_dawg_node_edge(*ctx.dawg, node_index, node_mask, ordinal);
+		ctx.s[s_len] = rl_edge_letter(edge);
+		if (rl_edge_is_word(edge) && (next_states & accept) != 0)
+		{
+			_rl_pattern_emit(ctx, s_len + 1);
+		}
+		if (next_states != accept && !ctx.stopped)
+		{
+			// Going forward through a GADDAG, every word longer than one letter continues past the separator after
+			// its first letter
+			int32 next_node_index = rl_edge_node_index(edge);
+			if (ctx.dawg->is_gaddag && !ctx.backward && s_len == 0)
+			{
+				const rl_edge separator_edge = rl_dawg_find_edge(*ctx.dawg, next_node_index, RL_GADDAG_SEPARATOR);
+				next_node_index = separator_edge != RL_EDGE_NONE ? rl_edge_node_index(separator_edge) : -1;
+			}
+			if (next_node_index >= 0)
+			{
+				_rl_pattern_walk(ctx, s_len + 1, next_node_index, next_states & ~accept);
+			}
+		}
+
+		if (ctx.use_pool)
+		{
+			ctx.pool_sum++;
+			ctx.pool_counts[ordinal]++;
+			ctx.pool_letters |= 1u << ordinal;
+		}
+	}
+}
+
+static const char* _rl_pattern_parse_set(const char* s, uint32& out_letters)
+{
+	// Parses the body of a letter set, just past its opening bracket: returns a pointer past its closing bracket, or
+	// nullptr if it's malformed
+	bool negate = false;
+	if (*s == '^')
+	{
+		negate = true;
+		s++;
+	}
+	uint32 letters = 0;
+	while (*s != ']')
+	{
+		const char first = *s;
+		char last = first;
+		if (first < 'a' || first > 'z')
+		{
+			return nullptr;
+		}
+		if (s[1] == '-' && s[2] != ']')
+		{
+			last = s[2];
+			if (last < first || last > 'z')
+			{
+				return nullptr;
+			}
+			s += 3;
+		}
+		else
+		{
+			s++;
+		}
+		for (char c = first; c <= last; c++)
+		{
+			letters |= 1u << (c - 'a');
+		}
+	}
+	out_letters = negate ? (RL_CHECKBITS_ANY & ~letters) : letters;
+	return s + 1;
+}
+
+bool rl_pattern_compile(rl_pattern& pattern, const char* s)
+{
+	_rl_pattern_reset(pattern);
+	while (*s != '\0')
+	{
+		uint32 letters = 0;
+		bool is_gap = false;
+		if (*s >= 'a' && *s <= 'z')
+		{
+			letters = 1u << (*s - 'a');
+			s++;
+		}
+		else if (*s == '?')
+		{
+			letters = RL_CHECKBITS_ANY;
+			s++;
+		}
+		else if (*s == '*')
+		{
+			letters = RL_CHECKBITS_ANY;
+			is_gap = true;
+			s++;
+
+			// Consecutive gaps match nothing more than one gap does
+			if (pattern.num_elements > 0 && (pattern.gaps & (static_cast<uint64>(1) << (pattern.num_elements - 1))))
+			{
+				continue;
+			}
+		}
+		else if (*s == '[')
+		{
+			s = _rl_pattern_parse_set(s + 1, letters);
+		}
+		else
+		{
+			s = nullptr;
+		}
+
+		if (!s || letters == 0 || pattern.num_elements == RL_PATTERN_MAX_ELEMENTS)
+		{
+			_rl_pattern_reset(pattern);
+			return false;
+		}
+		_rl_pattern_push(pattern, letters, is_gap);
+	}
+	_rl_pattern_finish(pattern);
+	return true;
+}
+
+bool rl_pattern_test(const rl_pattern& pattern, const uint8* word, int32 word_len)
+{
+	uint64 states = _rl_pattern_closure(pattern, 1);
+	for (int32 letter_index = 0; letter_index < word_len && states != 0; letter_index++)
+	{
+		const uint32 ordinal = static_cast<uint32>(word[letter_index] - 'a');
+		if (ordinal >= 26)
+		{
+			return false;
+		}
+		states = _rl_pattern_step(pattern, states, ordinal);
+	}
+	return (states & (static_cast<uint64>(1) << pattern.num_elements)) != 0;
+}
+
+int32 rl_pattern_match(const rl_dawg& dawg, const rl_pattern& pattern, const rl_rack* rack, rl_pattern_visit_fn visit, void* user_data, rl_search_stats* stats)
+{
+	assert(dawg.data);
+	assert(visit);
+
+	// A GADDAG holds every word both as its first letter, the separator, and the rest of the word, and reversed in full
+	// (with no separator), so we can match the pattern in either direction. The walk is cheapest when it's constrained
+	// from the start, so we go backward if only the end of the pattern is constrained.
+	rl_pattern reversed;
+	const rl_pattern* walk_pattern = &pattern;
+	const bool starts_with_gap = pattern.num_elements > 0 && (pattern.gaps & 1) != 0;
+	const bool ends_with_gap = pattern.num_elements > 0 && (pattern.gaps & (static_cast<uint64>(1) << (pattern.num_elements - 1))) != 0;
+	const bool backward = dawg.is_gaddag && starts_with_gap && !ends_with_gap;
+	if (backward)
+	{
+		_rl_pattern_reverse(pattern, reversed);
+		walk_pattern = &reversed;
+	}
+
+	rl_pattern_ctx ctx;
+	ctx.dawg = &dawg;
+	ctx.pattern = walk_pattern;
+	ctx.backward = backward;
+	ctx.use_pool = rack != nullptr;
+	ctx.pool_sum = 0;
+	ctx.pool_letters = 0;
+	for (int32 ordinal = 0; ordinal < 26; ordinal++)
+	{
+		const int32 count = rack ? MIN(rack->counts[ordinal] + pattern.fixed_counts[ordinal], UINT8_MAX) : 0;
+		ctx.pool_counts[ordinal] = static_cast<uint8>(count);
+		ctx.pool_sum += count;
+		if (count > 0)
+		{
+			ctx.pool_letters |= 1u << ordinal;
+		}
+	}
+	ctx.visit = visit;
+	ctx.user_data = user_data;
+	ctx.num_matches = 0;
+	ctx.stopped = false;
+	ctx.num_nodes_visited = 0;
+	ctx.num_nodes_pruned = 0;
+	ctx.node_visits = stats ? stats->node_visits : nullptr;
+
+	// An empty pattern matches only the empty word, which no DAWG holds
+	const uint64 states = _rl_pattern_closure(*walk_pattern, 1);
+	if (states != (static_cast<uint64>(1) << walk_pattern->num_elements))
+	{
+		_rl_pattern_walk(ctx, 0, 0, states & ~(static_cast<uint64>(1) << walk_pattern->num_elements));
+	}
+
+	if (stats)
+	{
+		stats->num_nodes_visited += ctx.num_nodes_visited;
+		stats->num_nodes_pruned += ctx.num_nodes_pruned;
+	}
+	return ctx.num_matches;
+}
@@ -4,11 +4,11 @@
 #include <cstring>
 #include <cstdio>
 #include <cassert>
+#include <thread>
+#include <mutex>
 
 #include "rl_util.h"
 #include "rl_dawg.h"
-#include "rl_node.h"
-#include "rl_edgemap.h"
 #include "rl_rack.h"
 #include "rl_board.h"
 #include "rl_move.h"
@@ -16,20 +16,51 @@
 // Quick-and-dirty randomness for testing; temporary
 #define WITH_FAVORITE_LETTERS
 
+// Skip DAWG branches whose rl_node_summary rules out every word below them; undefine to compare
+#define WITH_SUBTREE_PRUNING
+
+// Running score of the word being built by a best-score search: the value of its letters (with letter multipliers
+// applied), the product of its word multipliers, the score of the cross words it forms, and the face value of the
+// tiles it takes from the rack
+struct _rl_score_state
+{
+	int32 word_sum;
+	int32 word_multiplier;
+	int32 cross_score;
+	int32 placed_value;
+};
+
+/*
+	The search's own copy of the rack, packed for the inner loop: the set of letters held at least once, as a mask that
+	can be intersected with a node's edge mask and a square's checkbits in one step, alongside the number of each
+	letter and the total number of tiles. Taking or returning a tile updates all three in place.
+*/
+struct _rl_packed_rack
+{
+	uint32 letters;
+	int32 sum;
+	uint8 counts[26];
+};
+
 struct rl_search_ctx
 {
 	const rl_dawg* dawg;
 	const rl_board* board;
-	rl_rack rack;
+	_rl_packed_rack rack;
 	uint8 pattern[RL_MAX_WORD_LEN];
 	uint8 s[RL_MAX_WORD_LEN];
+	uint8 left[RL_MAX_WORD_LEN];
 	int32 offset;
 	uint8 blockflag_next;
 	uint8 blockflag_prev;
 	uint32* checkbits_array;
+	const int32* cross_sums_array;
 	int32 anchor_index;
+	int32 anchor_pos;
 	int32 required_prefix_len;
 	int32 required_suffix_len;
+	int32 max_suffix_len;
+	uint8 num_empty_squares[RL_MAX_WORD_LEN + 1];
 #ifdef WITH_FAVORITE_LETTERS
 	uint8 favorite_letters[4];
 	bool use_favorite_letters;
@@ -38,16 +69,129 @@ struct rl_search_ctx
 
 	int32 num_legal_moves;
 	rl_move* move;
+	int32 move_anchor_index;
+	rl_search_visit_fn visit;
+	void* visit_data;
+	bool stopped;
+
+	bool scoring;
+	_rl_score_state score;
+	int32 best_score;
+	int32 rack_value;
+	int32 max_rack_value;
+	int32 bound_existing_sum[RL_MAX_WORD_LEN + 1];
+	int32 bound_letter_multiplier[RL_MAX_WORD_LEN + 1];
+	int32 bound_word_multiplier[RL_MAX_WORD_LEN + 1];
+	int32 bound_cross_score[RL_MAX_WORD_LEN + 1];
+
+	uint64 num_nodes_visited;
+	uint64 num_nodes_pruned;
+	uint64 num_nodes_bounded;
+	uint32* node_visits;
 };
 
+static void _rl_packed_rack_init(_rl_packed_rack& packed, const rl_rack& rack)
+{
+	packed.letters = 0;
+	packed.sum = rack.sum;
+	for (int32 ordinal = 0; ordinal < 26; ordinal++)
+	{
+		packed.counts[ordinal] = rack.counts[ordinal];
+		if (packed.counts[ordinal] > 0)
+		{
+			packed.letters |= 1u << ordinal;
+		}
+	}
+}
+
+static void _rl_packed_rack_take(_rl_packed_rack& rack, uint32 ordinal)
+{
+	// Keep the mask in sync with the counts, clearing the letter's bit once we've taken the last of it
+	assert(rack.counts[ordinal] > 0);
+	rack.sum--;
+	rack.counts[ordinal]--;
+	rack.letters &= ~(static_cast<uint32>(rack.counts[ordinal] == 0) << ordinal);
+}
+
+static void _rl_packed_rack_return(_rl_packed_rack& rack, uint32 ordinal)
+{
+	rack.sum++;
+	rack.counts[ordinal]++;
+	rack.letters |= 1u << ordinal;
+}
+
+static uint32 _rl_pattern_letters(const rl_search_ctx& ctx, int32 pattern_index)
+{
+	// Returns the set of letters permitted by the pattern at the given position: any letter, if unconstrained
+	if (pattern_index < 0 || ctx.pattern[pattern_index] < 'a')
+	{
+		return RL_CHECKBITS_ANY;
+	}
+	return 1u << (ctx.pattern[pattern_index] - 'a');
+}
+
+static bool _rl_precedes_move(const rl_search_ctx& ctx, int32 s_len, int32 start_index)
+{
+	// Moves of the same length from the same anchor are ordered by their prefix (the letters before the anchor), then
+	// by the rest of the word: this is the order in which a DAWG search finds them, so by preferring the earliest
+	// move in this order, a GADDAG search adopts exactly the same move, despite visiting moves in a different order
+	const rl_move& move = *ctx.move;
+	if (s_len != move.word_len || ctx.anchor_index != ctx.move_anchor_index || ctx.offset != move.offset)
+	{
+		return false;
+	}
+
+	const int32 prefix_len = (ctx.anchor_index - start_index) / ctx.offset;
+	const int32 move_prefix_len = (ctx.move_anchor_index - move.index) / move.offset;
+	const int32 cmp = memcmp(ctx.s, move.word, MIN(prefix_len, move_prefix_len));
+	if (cmp != 0 || prefix_len != move_prefix_len)
+	{
+		return cmp < 0 || (cmp == 0 && prefix_len < move_prefix_len);
+	}
+	return memcmp(ctx.s + prefix_len, move.word + prefix_len, s_len - prefix_len) < 0;
+}
+
 static void _rl_accept_move(rl_search_ctx& ctx, int32 s_len, int32 start_index)
 {
+	// When visiting moves, hand each one straight to the caller instead of keeping the best, until we're told to stop
+	if (ctx.visit)
+	{
+		if (!ctx.stopped)
+		{
+			ctx.num_legal_moves++;
+			rl_move_candidate candidate;
+			candidate.index = start_index;
+			candidate.offset = ctx.offset;
+			candidate.word = ctx.s;
+			candidate.word_len = s_len;
+			ctx.stopped = !ctx.visit(candidate, ctx.visit_data);
+		}
+		return;
+	}
+
 	ctx.num_legal_moves++;
 
+	// In a best-score search, only a move that outscores every move found so far is kept
+	if (ctx.scoring)
+	{
+		const int32 score = ctx.score.word_sum * ctx.score.word_multiplier + ctx.score.cross_score;
+		if (score > ctx.best_score)
+		{
+			ctx.best_score = score;
+			rl_move_set(*ctx.move, *ctx.board, start_index, ctx.offset, ctx.s, s_len);
+			ctx.move_anchor_index = ctx.anchor_index;
+		}
+		return;
+	}
+
 	rl_move& move = *ctx.move;
 
 #ifdef WITH_FAVORITE_LETTERS
 	bool should_adopt = s_len > move.word_len;
+	if (!ctx.use_favorite_letters && _rl_precedes_move(ctx, s_len, start_index))
+	{
+		should_adopt = true;
+	}
 	if (ctx.use_favorite_letters)
 	{
 		int32 favorite_score = 0;
@@ -67,46 +211,210 @@ static void _rl_accept_move(rl_search_ctx& ctx, int32 s_len, int32 start_index)
 			ctx.prev_favorite_score = favorite_score;
 			should_adopt = true;
 		}
+		else if (favorite_score == ctx.prev_favorite_score && _rl_precedes_move(ctx, s_len, start_index))
+		{
+			should_adopt = true;
+		}
 	}
 
 	if (should_adopt)
 #endif
 	{
-		move.index = start_index;
-		move.offset = ctx.offset;
-		memcpy(move.word, ctx.s, s_len);
-		move.word_len = s_len;
+		rl_move_set(move, *ctx.board, start_index, ctx.offset, ctx.s, s_len);
+		ctx.move_anchor_index = ctx.anchor_index;
+	}
+}
+
+static void _rl_consider_word(rl_search_ctx& ctx, int32 s_len, int32 square_index, int32 suffix_len)
+{
+	if (ctx.required_suffix_len < 0 || suffix_len == ctx.required_suffix_len)
+	{
+		const int32 start_index = square_index - s_len * ctx.offset;
+		_rl_accept_move(ctx, s_len, start_index);
+	}
+}
 
-		rl_rack_init(move.letters_used);
-		int32 square_index = start_index;
-		for (int32 letter_index = 0; letter_index < move.word_len; letter_index++)
+static void _rl_score_placed_tile(rl_search_ctx& ctx, int32 square_index, int32 value)
+{
+	// A tile played into an empty square picks up that square's premiums, and completes a cross word if there are
+	// letters beside it in the perpendicular direction
+	const rl_board& board = *ctx.board;
+	const int32 letter_multiplier = board.letter_multipliers ? board.letter_multipliers[square_index] : 1;
+	const int32 word_multiplier = board.word_multipliers ? board.word_multipliers[square_index] : 1;
+	const int32 cross_sum = ctx.cross_sums_array[square_index];
+	ctx.score.word_sum += value * letter_multiplier;
+	ctx.score.word_multiplier *= word_multiplier;
+	ctx.score.placed_value += value;
+	if (cross_sum >= 0)
+	{
+		ctx.score.cross_score += (cross_sum + value * letter_multiplier) * word_multiplier;
+	}
+}
+
+static void _rl_score_prefix(rl_search_ctx& ctx, int32 s_len, int32 square_index)
+{
+	// Score the first s_len letters of the word from scratch, given that they end just before square_index: from there,
+	// _rl_build_suffix keeps the score up to date one letter at a time
+	const rl_board& board = *ctx.board;
+	ctx.score.word_sum = 0;
+	ctx.score.word_multiplier = 1;
+	ctx.score.cross_score = 0;
+	ctx.score.placed_value = 0;
+	int32 index = square_index - s_len * ctx.offset;
+	for (int32 letter_index = 0; letter_index < s_len; letter_index++)
+	{
+		const int32 value = board.letter_values[ctx.s[letter_index] - 'a'];
+		const uint8 existing_letter = board.letters[index];
+		if (existing_letter != RL_BLANK && existing_letter != RL_ANCHOR)
+		{
+			ctx.score.word_sum += value;
+		}
+		else
+		{
+			_rl_score_placed_tile(ctx, index, value);
+		}
+		index += ctx.offset;
+	}
+}
+
+static void _rl_scan_score_bounds(rl_search_ctx& ctx)
+{
+	// For each position in the suffix, work out the most that the squares from there onward could add to a move's
+	// score: the letters already on the board at face value, plus what's left of the rack on the best letter multiplier
+	// within reach, all times every word multiplier within reach; plus every cross word within reach, completed with
+	// the most valuable tile in the rack. The suffix can reach as far as in _rl_scan_suffix_squares.
+	const rl_board& board = *ctx.board;
+	int32 square_indices[RL_MAX_WORD_LEN];
+	int32 num_squares = 0;
+	int32 num_empty = 0;
+	int32 square_index = ctx.anchor_index;
+	while (num_squares < static_cast<int32>(RL_MAX_WORD_LEN))
+	{
+		const uint8 letter = board.letters[square_index];
+		if (letter == RL_BLANK || letter == RL_ANCHOR)
 		{
-			if (move.word[letter_index] != ctx.board->letters[square_index])
+			if (num_empty == ctx.rack.sum)
 			{
-				rl_rack_push(move.letters_used, move.word[letter_index]);
+				break;
 			}
-			square_index += ctx.offset;
+			num_empty++;
+		}
+		square_indices[num_squares++] = square_index;
+		if (board.blockflags[square_index] & ctx.blockflag_next)
+		{
+			break;
+		}
+		square_index += ctx.offset;
+	}
+
+	for (int32 pos = RL_MAX_WORD_LEN; pos >= num_squares; pos--)
+	{
+		ctx.bound_existing_sum[pos] = 0;
+		ctx.bound_letter_multiplier[pos] = 0;
+		ctx.bound_word_multiplier[pos] = 1;
+		ctx.bound_cross_score[pos] = 0;
+	}
+	for (int32 pos = num_squares - 1; pos >= 0; pos--)
+	{
+		const int32 index = square_indices[pos];
+		ctx.bound_existing_sum[pos] = ctx.bound_existing_sum[pos + 1];
+		ctx.bound_letter_multiplier[pos] = ctx.bound_letter_multiplier[pos + 1];
+		ctx.bound_word_multiplier[pos] = ctx.bound_word_multiplier[pos + 1];
+		ctx.bound_cross_score[pos] = ctx.bound_cross_score[pos + 1];
+		const uint8 letter = board.letters[index];
+		if (letter != RL_BLANK && letter != RL_ANCHOR)
+		{
+			ctx.bound_existing_sum[pos] += board.letter_values[letter - 'a'];
+			continue;
+		}
+
+		// The product of word multipliers is capped well short of overflowing: no real board comes anywhere near it
+		const int32 letter_multiplier = board.letter_multipliers ? board.letter_multipliers[index] : 1;
+		const int32 word_multiplier = board.word_multipliers ? board.word_multipliers[index] : 1;
+		ctx.bound_letter_multiplier[pos] = MAX(ctx.bound_letter_multiplier[pos], letter_multiplier);
+		ctx.bound_word_multiplier[pos] = MIN(ctx.bound_word_multiplier[pos] * word_multiplier, 1 << 16);
+		if (ctx.cross_sums_array[index] >= 0)
+		{
+			ctx.bound_cross_score[pos] += (ctx.cross_sums_array[index] + ctx.max_rack_value * letter_multiplier) * word_multiplier;
 		}
 	}
 }
 
-static void _rl_consider_word(rl_search_ctx& ctx, int32 s_len, int32 square_index, int32 suffix_len)
+static bool _rl_can_bound_suffix(const rl_search_ctx& ctx, int32 suffix_len)
 {
-	if (ctx.required_suffix_len < 0 || suffix_len == ctx.required_suffix_len)
+	// If even the best case for the rest of the word can't beat the best move found so far, there's nothing to gain
+	// from looking any further
+	const uint64 remaining_value = static_cast<uint64>(ctx.rack_value - ctx.score.placed_value);
+	const uint64 word_sum = ctx.score.word_sum + ctx.bound_existing_sum[suffix_len] + remaining_value * ctx.bound_letter_multiplier[suffix_len];
+	const uint64 word_multiplier = static_cast<uint64>(ctx.score.word_multiplier) * ctx.bound_word_multiplier[suffix_len];
+	const uint64 bound = word_sum * word_multiplier + ctx.score.cross_score + ctx.bound_cross_score[suffix_len];
+	return ctx.best_score >= 0 && bound <= static_cast<uint64>(ctx.best_score);
+}
+
+static void _rl_scan_suffix_squares(rl_search_ctx& ctx)
+{
+	// When searching for a suffix of a specific length, note how many of the squares it will cover are empty (and so
+	// must be filled from the rack). The suffix can't run past a block or the edge of the board, nor past the point
+	// where it would cover more empty squares than we have letters in our rack: max_suffix_len is how far it can reach.
+	assert(ctx.required_suffix_len >= 0);
+	const int32 limit = MIN(ctx.required_suffix_len, static_cast<int32>(RL_MAX_WORD_LEN));
+	int32 square_index = ctx.anchor_index;
+	int32 num_empty = 0;
+	ctx.num_empty_squares[0] = 0;
+	ctx.max_suffix_len = 0;
+	while (ctx.max_suffix_len < limit)
 	{
-		const int32 start_index = square_index - s_len * ctx.offset;
-		_rl_accept_move(ctx, s_len, start_index);
+		const uint8 letter = ctx.board->letters[square_index];
+		if (letter == RL_BLANK || letter == RL_ANCHOR)
+		{
+			if (num_empty == ctx.rack.sum)
+			{
+				break;
+			}
+			num_empty++;
+		}
+		ctx.num_empty_squares[++ctx.max_suffix_len] = static_cast<uint8>(num_empty);
+		if (ctx.board->blockflags[square_index] & ctx.blockflag_next)
+		{
+			break;
+		}
+		square_index += ctx.offset;
 	}
 }
 
+static bool _rl_can_prune_suffix(const rl_search_ctx& ctx, int32 node_index, int32 suffix_len)
+{
+	// Every word below this node needs between min_len and max_len more letters, the first of which goes in the
+	// current square: if the suffix must end at a square outside that range, or one we can't reach, there's nothing
+	// to find here. A packed DAWG keeps no summaries, so there's nothing to go on.
+	if (!ctx.dawg->node_summaries)
+	{
+		return false;
+	}
+	const rl_node_summary& summary = ctx.dawg->node_summaries[node_index];
+	const int32 num_remaining = ctx.required_suffix_len - suffix_len;
+	if (num_remaining < summary.min_len || num_remaining > summary.max_len || num_remaining == 0 || ctx.required_suffix_len > ctx.max_suffix_len)
+	{
+		return true;
+	}
+
+	// The empty squares that remain must be filled from the rack, using letters that appear somewhere below this node
+	const int32 num_empty = ctx.num_empty_squares[ctx.required_suffix_len] - ctx.num_empty_squares[suffix_len];
+	return num_empty > ctx.rack.sum || (num_empty > 0 && (summary.letters & ctx.rack.letters) == 0);
+}
+
 static void _rl_build_suffix(rl_search_ctx& ctx, int32 s_len, int32 node_index, int32 square_index)
 {
 	assert(s_len < COUNT_OF(ctx.s));
+	if (ctx.stopped)
+	{
+		return;
+	}
 
 	// We know that we have a valid prefix (even if zero-length), and from that prefix, we're trying to build a suffix
 	// which gives us a word that meets the criteria for our current search. The prefix is represented by node_index:
 	// this is the DAWG node that's positioned along the sequence of edges that spells out our prefix.
-	const rl_node& node = ctx.dawg->nodearray.items[node_index];
+	const rl_dawg& dawg = *ctx.dawg;
 
 	// square_index points to the square on the board that our suffix will start at. We know that this cell has a
 	// valid prefix and is within the bounds of the board. If that cell already has a letter in it, we're trying to
@@ -114,6 +422,28 @@ static void _rl_build_suffix(rl_search_ctx& ctx, int32 s_len, int32 node_index,
 	// blank, we're checking the edges against our rack to see which letters we could play in this cell.
 	assert(square_index >= 0 && square_index < ctx.board->size_x * ctx.board->size_y);
 
+	// If we're trying to find a suffix of a specific length, we can first consult the summary of the words below this
+	// node: if none of them could possibly be played from here, we can abandon this whole branch of the DAWG. (When
+	// the length is open, the rack itself already cuts off dead branches a level further down, at less cost.)
+	const int32 suffix_len = (square_index - ctx.anchor_index) / ctx.offset;
+#ifdef WITH_SUBTREE_PRUNING
+	if (ctx.required_suffix_len >= 0 && _rl_can_prune_suffix(ctx, node_index, suffix_len))
+	{
+		ctx.num_nodes_pruned++;
+		return;
+	}
+#endif
+	if (ctx.scoring && _rl_can_bound_suffix(ctx, suffix_len))
+	{
+		ctx.num_nodes_bounded++;
+		return;
+	}
+	ctx.num_nodes_visited++;
+	if (ctx.node_visits)
+	{
+		ctx.node_visits[node_index]++;
+	}
+
 	// It's the edges *between* nodes, not the nodes themselves, that correspond to letters in a word. So the current
 	// node represents our prefix, the edges leading out from that node represent the possible letters we could play in
 	// the current square, and the destination nodes at the end of each of those edges represent the new prefixes that
@@ -130,7 +460,6 @@ static void _rl_build_suffix(rl_search_ctx& ctx, int32 s_len, int32 node_index,
 
 	// Another reason would be if we're trying to find a suffix of a specific length: if we're currently at that
 	// length, we don't want to continue any further.
-	const int32 suffix_len = (square_index - ctx.anchor_index) / ctx.offset;
 	if (ctx.required_suffix_len >= 0 && suffix_len > ctx.required_suffix_len)
 	{
 		can_continue = false;
@@ -146,15 +475,20 @@ static void _rl_build_suffix(rl_search_ctx& ctx, int32 s_len, int32 node_index,
 		// If the square has a letter in it already, then our suffix *must* start with that letter: see if there's an
 		// edge leading out of our current DAWG node that's labeled with that letter
 		assert(existing_letter >= 'a' && existing_letter <= 'z');
-		const int32 next_node_index = rl_edgemap_find(node.next_by_letter, existing_letter);
-		if (next_node_index >= 0)
+		const rl_edge edge = rl_dawg_find_edge(dawg, node_index, existing_letter);
+		if (edge != RL_EDGE_NONE)
 		{
 			// If there's a valid edge for that letter, write it into our temporary buffer at the current offset
 			ctx.s[s_len] = existing_letter;
+			const _rl_score_state saved_score = ctx.score;
+			if (ctx.scoring)
+			{
+				ctx.score.word_sum += ctx.board->letter_values[existing_letter - 'a'];
+			}
 
 			// If the node it leads to is terminal, (prefix + suffix) gives us a valid word: check to see if we want
 			// to accept it as a valid move for this search
-			if (ctx.dawg->nodearray.items[next_node_index].is_word)
+			if (rl_edge_is_word(edge))
 			{
 				_rl_consider_word(ctx, s_len + 1, square_index + ctx.offset, suffix_len + 1);
 			}
@@ -162,48 +496,53 @@ static void _rl_build_suffix(rl_search_ctx& ctx, int32 s_len, int32 node_index,
 			// Continue traversing the DAWG, by making another recursive call, only if we're clear to do so
 			if (can_continue)
 			{
-				_rl_build_suffix(ctx, s_len + 1, next_node_index, square_index + ctx.offset);
+				_rl_build_suffix(ctx, s_len + 1, rl_edge_node_index(edge), square_index + ctx.offset);
 			}
+			ctx.score = saved_score;
 		}
 	}
 	else
 	{
 		// If the square doesn't have a letter in it, we can play any letter from our rack, so long as it's permitted
-		// by the relevant set of cross-check bits (meaning that any cross-words it forms are valid)
-		const uint32 checkbits = ctx.checkbits_array[square_index];
-		for (int32 edge_index = 0; edge_index < node.next_by_letter.size; edge_index++)
-		{
-			// Check each outgoing edge from the current node: this tells us what letters we can add to our current
-			// prefix while still having a chance of ending up with a valid word. If we've been supplied with a pattern
-			// that we must match, enforce that constraint here as well.
-			const rl_edgemap_item& edge = node.next_by_letter.items[edge_index];
-			if (ctx.pattern[s_len] < 'a' || ctx.pattern[s_len] == edge.letter)
+		// by the relevant set of cross-check bits (meaning that any cross-words it forms are valid). The outgoing
+		// edges from the current node tell us what letters we can add to our current prefix while still having a
+		// chance of ending up with a valid word: intersecting those with the letters in our rack, the cross-check
+		// bits, and the pattern we must match (if any) leaves us with exactly the set of letters we can play here.
+		const uint32 node_mask = rl_dawg_node_mask(dawg, node_index);
+		uint32 playable = node_mask & ctx.checkbits_array[square_index] & ctx.rack.letters & _rl_pattern_letters(ctx, s_len);
+		while (playable != 0)
+		{
+			// For each such letter, temporarily remove the letter from the rack and push a new stack frame where our
+			// prefix is extended by that letter, and we're trying to find a new suffix (one character smaller) for
+			// *that* prefix.
+			const uint32 ordinal = static_cast<uint32>(rl_ctz(playable));
+			playable &= playable - 1;
+			const rl_edge edge = rl_dawg_node_edge(dawg, node_index, node_mask, ordinal);
+			_rl_packed_rack_take(ctx.rack, ordinal);
+
+			// Write the letter we're currently testing into our temporary buffer at the current offset
+			ctx.s[s_len] = rl_edge_letter(edge);
+			const _rl_score_state saved_score = ctx.score;
+			if (ctx.scoring)
 			{
-				// If the letter satisfies our cross-check bits and we have that letter in our rack, temporarily remove
-				// the letter from the rack and push a new stack frame where our prefix is extended by that letter, and
-				// we're trying to find a new suffix (one character smaller) for *that* prefix.
-				const uint32 letter_bit = 1 << (edge.letter - 'a');
-				if ((letter_bit & checkbits) && rl_rack_pop(ctx.rack, edge.letter))
-				{
-					// Write the letter we're currently testing into our temporary buffer at the current offset
-					ctx.s[s_len] = edge.letter;
-
-					// If the node it leads to is terminal, (prefix + suffix) gives us a valid word: check to see if we want
-					// to accept it as a valid move for this search
-					if (ctx.dawg->nodearray.items[edge.node_index].is_word)
-					{
-						_rl_consider_word(ctx, s_len + 1, square_index + ctx.offset, suffix_len + 1);
-					}
-
-					if (can_continue)
-					{
-						_rl_build_suffix(ctx, s_len + 1, edge.node_index, square_index + ctx.offset);
-					}
-
-					// Make sure the letter gets added back to the rack at the end of the stack frame
-					rl_rack_push(ctx.rack, edge.letter);
-				}
+				_rl_score_placed_tile(ctx, square_index, ctx.board->letter_values[ordinal]);
 			}
+
+			// If the node it leads to is terminal, (prefix + suffix) gives us a valid word: check to see if we want
+			// to accept it as a valid move for this search
+			if (rl_edge_is_word(edge))
+			{
+				_rl_consider_word(ctx, s_len + 1, square_index + ctx.offset, suffix_len + 1);
+			}
+
+			if (can_continue)
+			{
+				_rl_build_suffix(ctx, s_len + 1, rl_edge_node_index(edge), square_index + ctx.offset);
+			}
+
+			// Make sure the letter (and the score before it) gets added back to the rack at the end of the stack frame
+			ctx.score = saved_score;
+			_rl_packed_rack_return(ctx.rack, ordinal);
 		}
 	}
 }
@@ -212,25 +551,153 @@ static void _rl_build_prefix(rl_search_ctx& ctx, int32 s_len, int32 node_index,
 {
 	if (ctx.required_prefix_len < 0 || s_len == ctx.required_prefix_len)
 	{
+		if (ctx.scoring)
+		{
+			_rl_score_prefix(ctx, s_len, ctx.anchor_index);
+		}
 		_rl_build_suffix(ctx, s_len, node_index, ctx.anchor_index);
 	}
 
 	if (limit > 0)
 	{
-		const rl_node& node = ctx.dawg->nodearray.items[node_index];
-		for (int32 edge_index = 0; edge_index < node.next_by_letter.size; edge_index++)
+		if (ctx.node_visits)
+		{
+			ctx.node_visits[node_index]++;
+		}
+		const uint32 node_mask = rl_dawg_node_mask(*ctx.dawg, node_index);
+		uint32 playable = node_mask & ctx.rack.letters & _rl_pattern_letters(ctx, s_len);
+		while (playable != 0 && !ctx.stopped)
 		{
-			const rl_edgemap_item& edge = node.next_by_letter.items[edge_index];
-			if (ctx.pattern[s_len] < 'a' || ctx.pattern[s_len] == edge.letter)
+			const uint32 ordinal = static_cast<uint32>(rl_ctz(playable));
+			playable &= playable - 1;
+			const rl_edge edge = rl_dawg_node_edge(*ctx.dawg, node_index, node_mask, ordinal);
+			_rl_packed_rack_take(ctx.rack, ordinal);
+			ctx.s[s_len] = rl_edge_letter(edge);
+			_rl_build_prefix(ctx, s_len + 1, rl_edge_node_index(edge), limit - 1);
+			_rl_packed_rack_return(ctx.rack, ordinal);
+		}
+	}
+}
+
+static void _rl_gaddag_split(rl_search_ctx& ctx, int32 prefix_len, rl_edge edge)
+{
+	// We've placed the anchor letter and prefix_len letters before it, in reverse: now that the length of the prefix
+	// is settled, spell out the word so far in order
+	for (int32 letter_index = 0; letter_index <= prefix_len; letter_index++)
+	{
+		ctx.s[letter_index] = ctx.left[prefix_len - letter_index];
+	}
+
+	// If the reversed prefix is a complete GADDAG entry on its own, the word ends at the anchor
+	const int32 next_index = ctx.anchor_index + ctx.offset;
+	if (ctx.scoring)
+	{
+		_rl_score_prefix(ctx, prefix_len + 1, next_index);
+	}
+	if (rl_edge_is_word(edge))
+	{
+		_rl_consider_word(ctx, prefix_len + 1, next_index, 1);
+	}
+
+	// Otherwise, the separator leads to every suffix that can follow: from there, the search proceeds exactly as it
+	// would in a DAWG from the square after the anchor
+	if ((ctx.board->blockflags[ctx.anchor_index] & ctx.blockflag_next) == 0)
+	{
+		const rl_edge separator_edge = rl_dawg_find_edge(*ctx.dawg, rl_edge_node_index(edge), RL_GADDAG_SEPARATOR);
+		if (separator_edge != RL_EDGE_NONE)
+		{
+			_rl_build_suffix(ctx, prefix_len + 1, rl_edge_node_index(separator_edge), next_index);
+		}
+	}
+}
+
+static void _rl_gaddag_build_prefix(rl_search_ctx& ctx, int32 prefix_len, rl_edge edge, int32 limit)
+{
+	if (ctx.required_prefix_len < 0 || prefix_len == ctx.required_prefix_len)
+	{
+		_rl_gaddag_split(ctx, prefix_len, edge);
+	}
+
+	// Extend the prefix by one more letter from the rack, working backward from the anchor
+	if (prefix_len < limit)
+	{
+		// The rack never holds the separator, so it's excluded here along with any letters we don't have
+		const int32 pattern_index = ctx.anchor_pos >= 0 ? ctx.anchor_pos - (prefix_len + 1) : -1;
+		const int32 node_index = rl_edge_node_index(edge);
+		if (ctx.node_visits)
+		{
+			ctx.node_visits[node_index]++;
+		}
+		const uint32 node_mask = rl_dawg_node_mask(*ctx.dawg, node_index);
+		uint32 playable = node_mask & ctx.rack.letters & _rl_pattern_letters(ctx, pattern_index);
+		while (playable != 0 && !ctx.stopped)
+		{
+			const uint32 ordinal = static_cast<uint32>(rl_ctz(playable));
+			playable &= playable - 1;
+			const rl_edge next_edge = rl_dawg_node_edge(*ctx.dawg, node_index, node_mask, ordinal);
+			_rl_packed_rack_take(ctx.rack, ordinal);
+			ctx.left[prefix_len + 1] = rl_edge_letter(next_edge);
+			_rl_gaddag_build_prefix(ctx, prefix_len + 1, next_edge, limit);
+			_rl_packed_rack_return(ctx.rack, ordinal);
+		}
+	}
+}
+
+static void _rl_gaddag_search_anchor(rl_search_ctx& ctx, int32 num_preceding_blanks, int32 num_preceding_letters)
+{
+	// In a GADDAG, we start from the letter played on the anchor square and work outward. We can only check letters
+	// against the pattern if we know their position in the word, which is the case whenever the prefix length is fixed
+	// (the only case in which we're given a pattern).
+	if (num_preceding_letters > 0)
+	{
+		ctx.anchor_pos = num_preceding_letters;
+	}
+	else if (ctx.required_prefix_len >= 0)
+	{
+		ctx.anchor_pos = ctx.required_prefix_len;
+	}
+	else
+	{
+		ctx.anchor_pos = num_preceding_blanks == 0 ? 0 : -1;
+	}
+	if (ctx.anchor_pos >= static_cast<int32>(RL_MAX_WORD_LEN))
+	{
+		return;
+	}
+
+	const rl_dawg& dawg = *ctx.dawg;
+	const uint32 root_mask = rl_dawg_node_mask(dawg, 0);
+	uint32 playable = root_mask & ctx.checkbits_array[ctx.anchor_index] & ctx.rack.letters & _rl_pattern_letters(ctx, ctx.anchor_pos);
+	while (playable != 0 && !ctx.stopped)
+	{
+		const uint32 ordinal = static_cast<uint32>(rl_ctz(playable));
+		playable &= playable - 1;
+		const rl_edge edge = rl_dawg_node_edge(dawg, 0, root_mask, ordinal);
+		_rl_packed_rack_take(ctx.rack, ordinal);
+		ctx.left[0] = rl_edge_letter(edge);
+
+		if (num_preceding_letters > 0)
+		{
+			// If the anchor is preceded by letters, they must form the prefix: follow them backward from the anchor
+			rl_edge prefix_edge = edge;
+			for (int32 depth = 1; depth <= num_preceding_letters && prefix_edge != RL_EDGE_NONE; depth++)
 			{
-				if (rl_rack_pop(ctx.rack, edge.letter))
-				{
-					ctx.s[s_len] = edge.letter;
-					_rl_build_prefix(ctx, s_len + 1, edge.node_index, limit - 1);
-					rl_rack_push(ctx.rack, edge.letter);
-				}
+				const uint8 prefix_letter = ctx.board->letters[ctx.anchor_index - (depth * ctx.offset)];
+				ctx.left[depth] = prefix_letter;
+				prefix_edge = rl_dawg_find_edge(dawg, rl_edge_node_index(prefix_edge), prefix_letter);
+			}
+			if (prefix_edge != RL_EDGE_NONE)
+			{
+				_rl_gaddag_split(ctx, num_preceding_letters, prefix_edge);
 			}
 		}
+		else
+		{
+			// Otherwise, try every prefix we can form from our rack in the blank squares before the anchor
+			_rl_gaddag_build_prefix(ctx, 0, edge, num_preceding_blanks);
+		}
+
+		_rl_packed_rack_return(ctx.rack, ordinal);
 	}
 }
 
@@ -238,6 +705,21 @@ static void _rl_search_anchor(rl_search_ctx& ctx, int32 num_preceding_blanks, in
 {
 	// If our anchor is preceded by one or more letters, those letters form the prefix
 	assert(num_preceding_letters <= RL_MAX_WORD_LEN);
+#ifdef WITH_SUBTREE_PRUNING
+	if (ctx.required_suffix_len >= 0)
+	{
+		_rl_scan_suffix_squares(ctx);
+	}
+#endif
+	if (ctx.scoring)
+	{
+		_rl_scan_score_bounds(ctx);
+	}
+	if (ctx.dawg->is_gaddag)
+	{
+		_rl_gaddag_search_anchor(ctx, num_preceding_blanks, num_preceding_letters);
+		return;
+	}
 	if (num_preceding_letters > 0)
 	{
 		// Copy that existing prefix into our buffer (letter-by-letter, since down words aren't stored contiguously), and traverse the DAWG to the corresponding node
@@ -247,16 +729,21 @@ static void _rl_search_anchor(rl_search_ctx& ctx, int32 num_preceding_blanks, in
 		while (s_len < num_preceding_letters)
 		{
 			ctx.s[s_len] = ctx.board->letters[square_index];
-			node_index = rl_edgemap_find(ctx.dawg->nodearray.items[node_index].next_by_letter, ctx.s[s_len]);
-			if (node_index < 0)
+			const rl_edge edge = rl_dawg_find_edge(*ctx.dawg, node_index, ctx.s[s_len]);
+			if (edge == RL_EDGE_NONE)
 			{
 				return;
 			}
+			node_index = rl_edge_node_index(edge);
 			s_len++;
 			square_index += ctx.offset;
 		}
 
 		// Now find all valid suffixes for that prefix
+		if (ctx.scoring)
+		{
+			_rl_score_prefix(ctx, s_len, ctx.anchor_index);
+		}
 		_rl_build_suffix(ctx, s_len, node_index, ctx.anchor_index);
 	}
 	else
@@ -266,95 +753,247 @@ static void _rl_search_anchor(rl_search_ctx& ctx, int32 num_preceding_blanks, in
 	}
 }
 
-static void _rl_search_line(rl_search_ctx& ctx, int32 start_index, int32 end_index)
+static void _rl_count_preceding_squares(const rl_search_ctx& ctx, int32 anchor_index, int32& out_num_preceding_blanks, int32& out_num_preceding_letters)
 {
-	// Iterate across the line, counting the contiguous blanks/letters along the way so we don't have to backtrack
-	int32 num_contiguous_blanks = 0;
-	int32 num_contiguous_letters = 0;
-	for (int32 index = start_index; index < end_index; index += ctx.offset)
+	// Walk backward from the anchor over the run of blanks or letters leading up to it, stopping at the edge of the
+	// board, a block, or the previous anchor: no prefix can be as long as a word, so there's no need to count any
+	// further back than that
+	out_num_preceding_blanks = 0;
+	out_num_preceding_letters = 0;
+	int32 index = anchor_index;
+	while ((ctx.board->blockflags[index] & ctx.blockflag_prev) == 0 && out_num_preceding_blanks < static_cast<int32>(RL_MAX_WORD_LEN))
 	{
-		// If moves can't be played contiguously across the previous cell and this cell, make a clean break
-		if ((ctx.board->blockflags[index] & ctx.blockflag_prev) != 0)
-		{
-			num_contiguous_blanks = 0;
-			num_contiguous_letters = 0;
-		}
-
-		// When we hit an anchor, start searching for valid moves that can be built from that anchor
-		const uint8 letter = ctx.board->letters[index];
+		const uint8 letter = ctx.board->letters[index - ctx.offset];
 		if (letter == RL_ANCHOR)
 		{
-			ctx.anchor_index = index;
-			_rl_search_anchor(ctx, num_contiguous_blanks, num_contiguous_letters);
-			num_contiguous_blanks = 0;
-			num_contiguous_letters = 0;
+			break;
 		}
 		else if (letter == RL_BLANK)
 		{
-			num_contiguous_blanks++;
-			num_contiguous_letters = 0;
+			if (out_num_preceding_letters > 0)
+			{
+				break;
+			}
+			out_num_preceding_blanks++;
 		}
 		else
 		{
 			assert(letter >= 'a' && letter <= 'z');
-			num_contiguous_blanks = 0;
-			num_contiguous_letters++;
+			if (out_num_preceding_blanks > 0)
+			{
+				break;
+			}
+			out_num_preceding_letters++;
+		}
+		index -= ctx.offset;
+	}
+}
+
+/*
+	Iterates over the anchors on a board in the same order as a scan of every line would reach them: row by row for
+	across moves, or column by column for down moves. Lines are found from the board's occupancy summary and anchors
+	from each line's bitmap, so the cost of a full scan grows with the number of anchors rather than with the area of
+	the board.
+*/
+struct _rl_anchor_scan
+{
+	const uint64* summary;
+	const uint64* line_bits;
+	int32 num_lines;
+	int32 line_words;
+	bool across;
+
+	int32 line_index;
+	int32 word_index;
+	uint64 bits;
+};
+
+static void _rl_anchor_scan_init_lines(_rl_anchor_scan& scan, const rl_board& board, bool across, int32 first_line_index, int32 end_line_index)
+{
+	// Only the lines from first_line_index up to (but not including) end_line_index are scanned
+	scan.summary = across ? board.anchor_row_summary : board.anchor_column_summary;
+	scan.line_bits = across ? board.anchor_rows : board.anchor_columns;
+	scan.num_lines = end_line_index;
+	scan.line_words = across ? board.anchor_row_words : board.anchor_column_words;
+	scan.across = across;
+	scan.line_index = first_line_index - 1;
+	scan.word_index = scan.line_words - 1;
+	scan.bits = 0;
+}
+
+static void _rl_anchor_scan_init(_rl_anchor_scan& scan, const rl_board& board, bool across)
+{
+	_rl_anchor_scan_init_lines(scan, board, across, 0, across ? board.size_y : board.size_x);
+}
+
+static bool _rl_anchor_scan_next_line(_rl_anchor_scan& scan)
+{
+	// Find the next line whose bit is set in the summary, if there is one
+	for (int32 line_index = scan.line_index + 1; line_index < scan.num_lines; line_index = (line_index / 64 + 1) * 64)
+	{
+		const uint64 remaining = scan.summary[line_index / 64] & (~0ULL << (line_index % 64));
+		if (remaining != 0)
+		{
+			scan.line_index = (line_index / 64) * 64 + rl_ctz64(remaining);
+			scan.word_index = 0;
+			return scan.line_index < scan.num_lines;
+		}
+	}
+	scan.line_index = scan.num_lines;
+	return false;
+}
+
+static bool _rl_anchor_scan_next_anchor(const rl_search_ctx& ctx, _rl_anchor_scan& scan, int32& out_anchor_index, int32& out_num_preceding_blanks, int32& out_num_preceding_letters)
+{
+	while (scan.bits == 0)
+	{
+		if (scan.word_index + 1 < scan.line_words)
+		{
+			scan.word_index++;
+		}
+		else if (!_rl_anchor_scan_next_line(scan))
+		{
+			return false;
 		}
+		scan.bits = scan.line_bits[scan.line_index * scan.line_words + scan.word_index];
+	}
+
+	// Take the lowest remaining anchor in the line, then count the squares before it that a move could build on
+	const int32 bit_index = scan.word_index * 64 + rl_ctz64(scan.bits);
+	scan.bits &= scan.bits - 1;
+	out_anchor_index = scan.across ? rl_board_index(*ctx.board, bit_index, scan.line_index) : rl_board_index(*ctx.board, scan.line_index, bit_index);
+	assert(ctx.board->letters[out_anchor_index] == RL_ANCHOR);
+	_rl_count_preceding_squares(ctx, out_anchor_index, out_num_preceding_blanks, out_num_preceding_letters);
+	return true;
+}
+
+static int32 _rl_search_finish(const rl_search_ctx& ctx, rl_search_stats* stats)
+{
+	if (stats)
+	{
+		stats->num_nodes_visited += ctx.num_nodes_visited;
+		stats->num_nodes_pruned += ctx.num_nodes_pruned;
+		stats->num_nodes_bounded += ctx.num_nodes_bounded;
 	}
+	return ctx.num_legal_moves;
+}
+
+void rl_search_stats_init(rl_search_stats& stats)
+{
+	stats.num_nodes_visited = 0;
+	stats.num_nodes_pruned = 0;
+	stats.num_nodes_bounded = 0;
+	stats.node_visits = nullptr;
 }
 
-int32 rl_search_board(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move)
+static void _rl_search_init(rl_search_ctx& ctx, const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, rl_search_stats* stats)
 {
 	// Establish a context struct to wrap up the data describing our search, and to hold a string buffer and a mutable copy of the rack
-	rl_search_ctx ctx;
 	ctx.dawg = &dawg;
 	ctx.board = &board;
-	memcpy(&ctx.rack, &rack, sizeof(rl_rack));
+	_rl_packed_rack_init(ctx.rack, rack);
 	memset(ctx.pattern, 0, sizeof(ctx.pattern));
 	memset(ctx.s, 0, sizeof(ctx.s));
 	ctx.offset = 0;
 	ctx.blockflag_next = 0;
 	ctx.blockflag_prev = 0;
 	ctx.checkbits_array = nullptr;
+	ctx.cross_sums_array = nullptr;
 	ctx.anchor_index = -1;
+	ctx.anchor_pos = -1;
 	ctx.required_prefix_len = -1;
 	ctx.required_suffix_len = -1;
+	ctx.max_suffix_len = 0;
 	ctx.num_legal_moves = 0;
 	rl_move_init(move);
 	ctx.move = &move;
+	ctx.move_anchor_index = -1;
+	ctx.visit = nullptr;
+	ctx.visit_data = nullptr;
+	ctx.stopped = false;
+	ctx.scoring = false;
+	ctx.score.word_sum = 0;
+	ctx.score.word_multiplier = 1;
+	ctx.score.cross_score = 0;
+	ctx.score.placed_value = 0;
+	ctx.best_score = -1;
+	ctx.rack_value = 0;
+	ctx.max_rack_value = 0;
+	ctx.num_nodes_visited = 0;
+	ctx.num_nodes_pruned = 0;
+	ctx.num_nodes_bounded = 0;
+	ctx.node_visits = stats ? stats->node_visits : nullptr;
 #ifdef WITH_FAVORITE_LETTERS
 	ctx.use_favorite_letters = false;
 	ctx.prev_favorite_score = -1;
 #endif
+}
 
-	// Start at the top and go down the board to search each row for across moves
-	ctx.offset = rl_board_offset(*ctx.board, true);
-	ctx.blockflag_next = RL_BLOCKFLAG_NEXT_ACROSS;
-	ctx.blockflag_prev = RL_BLOCKFLAG_PREV_ACROSS;
-	ctx.checkbits_array = ctx.board->checkbits_y;
-	for (int32 playable_y = 0; playable_y < ctx.board->size_y; playable_y++)
+static void _rl_search_set_direction(rl_search_ctx& ctx, bool across)
+{
+	ctx.offset = rl_board_offset(*ctx.board, across);
+	ctx.blockflag_next = across ? RL_BLOCKFLAG_NEXT_ACROSS : RL_BLOCKFLAG_NEXT_DOWN;
+	ctx.blockflag_prev = across ? RL_BLOCKFLAG_PREV_ACROSS : RL_BLOCKFLAG_PREV_DOWN;
+	ctx.checkbits_array = across ? ctx.board->checkbits_y : ctx.board->checkbits_x;
+	ctx.cross_sums_array = across ? ctx.board->cross_sums_y : ctx.board->cross_sums_x;
+}
+
+static int32 _rl_search_board(rl_search_ctx& ctx, rl_search_stats* stats)
+{
+	// Start at the top and go down the board to search each row for across moves, then start at the left edge and go
+	// across the board to search each column for down moves, visiting only the anchors in each
+	for (int32 direction = 0; direction < 2 && !ctx.stopped; direction++)
 	{
-		const int32 start_index = rl_board_index(*ctx.board, 0, playable_y);
-		const int32 upper_bound = start_index + ctx.board->size_x * ctx.offset;
-		_rl_search_line(ctx, start_index, upper_bound);
+		const bool across = direction == 0;
+		_rl_search_set_direction(ctx, across);
+		_rl_anchor_scan scan;
+		_rl_anchor_scan_init(scan, *ctx.board, across);
+		int32 num_preceding_blanks;
+		int32 num_preceding_letters;
+		while (!ctx.stopped && _rl_anchor_scan_next_anchor(ctx, scan, ctx.anchor_index, num_preceding_blanks, num_preceding_letters))
+		{
+			_rl_search_anchor(ctx, num_preceding_blanks, num_preceding_letters);
+		}
 	}
 
-	// Start at the left edge and go across the board to search each column for down moves
-	ctx.offset = rl_board_offset(*ctx.board, false);
-	ctx.blockflag_next = RL_BLOCKFLAG_NEXT_DOWN;
-	ctx.blockflag_prev = RL_BLOCKFLAG_PREV_DOWN;
-	ctx.checkbits_array = ctx.board->checkbits_x;
-	for (int32 playable_x = 0; playable_x < ctx.board->size_x; playable_x++)
+	return _rl_search_finish(ctx, stats);
+}
+
+int32 rl_search_board(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, rl_search_stats* stats)
+{
+	rl_search_ctx ctx;
+	_rl_search_init(ctx, dawg, board, rack, move, stats);
+	return _rl_search_board(ctx, stats);
+}
+
+int32 rl_search_board_best_score(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, rl_search_stats* stats)
+{
+	rl_search_ctx ctx;
+	_rl_search_init(ctx, dawg, board, rack, move, stats);
+	ctx.scoring = true;
+	for (int32 ordinal = 0; ordinal < 26; ordinal++)
 	{
-		const int32 start_index = rl_board_index(*ctx.board, playable_x, 0);
-		const int32 upper_bound = start_index + ctx.board->size_y * ctx.offset;
-		_rl_search_line(ctx, start_index, upper_bound);
+		if (rack.counts[ordinal] > 0)
+		{
+			ctx.rack_value += rack.counts[ordinal] * board.letter_values[ordinal];
+			ctx.max_rack_value = MAX(ctx.max_rack_value, static_cast<int32>(board.letter_values[ordinal]));
+		}
 	}
+	_rl_search_board(ctx, stats);
+	return ctx.best_score;
+}
 
-	return ctx.num_legal_moves;
+int32 rl_search_board_visit(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_search_visit_fn visit, void* user_data, rl_search_stats* stats)
+{
+	rl_search_ctx ctx;
+	rl_move unused_move;
+	_rl_search_init(ctx, dawg, board, rack, unused_move, stats);
+	ctx.visit = visit;
+	ctx.visit_data = user_data;
+	return _rl_search_board(ctx, stats);
 }
 
-int32 rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_move& move)
+static int32 _rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_move& move, rl_search_visit_fn visit, void* visit_data, rl_search_stats* stats)
 {
 	// Get the relevant details for the segment of the row/column we're searching
 	const int32 offset = rl_board_offset(board, across);
@@ -406,27 +1045,19 @@ int32 rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rac
 
 	// Initialize our search context
 	rl_search_ctx ctx;
-	ctx.dawg = &dawg;
-	ctx.board = &board;
-	memcpy(&ctx.rack, &rack, sizeof(rl_rack));
-	memset(ctx.pattern, 0, sizeof(ctx.pattern));
-	ctx.offset = offset;
-	ctx.blockflag_next = blockflag_next;
-	ctx.blockflag_prev = across ? RL_BLOCKFLAG_PREV_ACROSS : RL_BLOCKFLAG_PREV_DOWN;
-	ctx.checkbits_array = across ? board.checkbits_y : board.checkbits_x;
-	ctx.anchor_index = -1;
-	ctx.required_prefix_len = -1;
-	ctx.required_suffix_len = -1;
-	ctx.num_legal_moves = 0;
-	rl_move_init(move);
-	ctx.move = &move;
+	_rl_search_init(ctx, dawg, board, rack, move, stats);
+	_rl_search_set_direction(ctx, across);
+	ctx.visit = visit;
+	ctx.visit_data = visit_data;
 #ifdef WITH_FAVORITE_LETTERS
-	for (int32 i = 0; i < COUNT_OF(ctx.favorite_letters); i++)
+	if (!visit)
 	{
-		ctx.favorite_letters[i] = 'a' + rand() % 26;
+		for (int32 i = 0; i < COUNT_OF(ctx.favorite_letters); i++)
+		{
+			ctx.favorite_letters[i] = 'a' + rand() % 26;
+		}
+		ctx.use_favorite_letters = true;
 	}
-	ctx.use_favorite_letters = true;
-	ctx.prev_favorite_score = -1;
 #endif
 
 	// If at least one square does not contain a letter, then one of two things is true:
@@ -439,31 +1070,9 @@ int32 rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rac
 	if (segment_first_anchor_index >= 0)
 	{
 		// If there are any letters behind the anchor, they should form our word's prefix; otherwise we want a prefix whose length is exactly the number of blanks from the start of the segment to the anchor
-		int32 num_preceding_letters = 0;
-		{
-			int32 index = segment_first_anchor_index;
-			while (true)
-			{
-				// If we're blocked from iterating backward, we have no more cells to consider for our prefix
-				if ((board.blockflags[index] & ctx.blockflag_prev) != 0)
-				{
-					break;
-				}
-
-				// If we've hit a blank letter, there are no more letters in the prefix
-				const int32 prev_index = index - offset;
-				const uint8 prev_letter = board.letters[prev_index];
-				if (prev_letter == RL_BLANK || prev_letter == RL_ANCHOR)
-				{
-					break;
-				}
-
-				// Otherwise, this preceding cell should contain a letter which forms part of the prefix for our move at this anchor
-				assert(prev_letter >= 'a' && prev_letter <= 'z');
-				num_preceding_letters++;
-				index = prev_index;
-			}
-		}
+		int32 num_preceding_blanks;
+		int32 num_preceding_letters;
+		_rl_count_preceding_squares(ctx, segment_first_anchor_index, num_preceding_blanks, num_preceding_letters);
 
 		// If the final square in the segment is blank (and not an anchor, meaning it's not adjacent to a letter), then our suffix length should be exactly the distance from (and including) the anchor to that square
 		const int32 end_index = start_index + offset * length;
@@ -502,7 +1111,7 @@ int32 rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rac
 			memcpy(ctx.pattern + num_preceding_letters, pattern, length);
 		}
 		_rl_search_anchor(ctx, ctx.required_prefix_len, num_preceding_letters);
-		return ctx.num_legal_moves;
+		return _rl_search_finish(ctx, stats);
 	}
 
 	// Otherwise, the square is entirely blank with no anchors
@@ -517,5 +1126,508 @@ int32 rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rac
 		memcpy(ctx.pattern, pattern, length);
 	}
 	_rl_search_anchor(ctx, 0, 0);
-	return ctx.num_legal_moves;
+	return _rl_search_finish(ctx, stats);
+}
+
+int32 rl_search_segment(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_move& move, rl_search_stats* stats)
+{
+	return _rl_search_segment(dawg, board, rack, start_index, pattern, length, across, move, nullptr, nullptr, stats);
+}
+
+int32 rl_search_segment_visit(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_search_visit_fn visit, void* user_data, rl_search_stats* stats)
+{
+	rl_move unused_move;
+	return _rl_search_segment(dawg, board, rack, start_index, pattern, length, across, unused_move, visit, user_data, stats);
+}
+
+/*
+	Caller-provided buffer filled in by rl_search_board_moves and rl_search_segment_moves: every move is counted, but
+	only the first max_moves are copied out.
+*/
+struct _rl_move_buffer
+{
+	const rl_board* board;
+	rl_move* moves;
+	int32 max_moves;
+	int32 num_moves;
+};
+
+static bool _rl_move_buffer_append(const rl_move_candidate& candidate, void* user_data)
+{
+	_rl_move_buffer& buffer = *reinterpret_cast<_rl_move_buffer*>(user_data);
+	if (buffer.num_moves < buffer.max_moves)
+	{
+		rl_move_set(buffer.moves[buffer.num_moves], *buffer.board, candidate.index, candidate.offset, candidate.word, candidate.word_len);
+	}
+	buffer.num_moves++;
+	return true;
+}
+
+int32 rl_search_board_moves(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move* moves, int32 max_moves, rl_search_stats* stats)
+{
+	_rl_move_buffer buffer = { &board, moves, max_moves, 0 };
+	return rl_search_board_visit(dawg, board, rack, _rl_move_buffer_append, &buffer, stats);
+}
+
+int32 rl_search_segment_moves(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 start_index, const uint8* pattern, int32 length, bool across, rl_move* moves, int32 max_moves, rl_search_stats* stats)
+{
+	_rl_move_buffer buffer = { &board, moves, max_moves, 0 };
+	return rl_search_segment_visit(dawg, board, rack, start_index, pattern, length, across, _rl_move_buffer_append, &buffer, stats);
+}
+
+int32 rl_rank_word_len(const rl_move_candidate& candidate, void*)
+{
+	return candidate.word_len;
+}
+
+/*
+	The best moves found so far by rl_search_board_topk, held in the caller's array of k moves. heap is a min-heap of
+	indices into that array, ordered so that the move at the root is the one we'd drop first: the lowest-ranked, and
+	of equally ranked moves, the one found last.
+*/
+struct _rl_topk
+{
+	const rl_board* board;
+	rl_rank_fn rank_fn;
+	void* rank_data;
+	rl_move* moves;
+	int32 k;
+	int32 num_moves;
+	uint32 num_found;
+	int32* heap;
+	int32* scores;
+	uint32* found_order;
+};
+
+static bool _rl_topk_below(const _rl_topk& topk, int32 lhs, int32 rhs)
+{
+	// True if the move in slot lhs would be dropped before the move in slot rhs
+	return topk.scores[lhs] < topk.scores[rhs] || (topk.scores[lhs] == topk.scores[rhs] && topk.found_order[lhs] > topk.found_order[rhs]);
+}
+
+static void _rl_topk_sift_down(_rl_topk& topk, int32 heap_index, int32 heap_size)
+{
+	while (true)
+	{
+		const int32 left = heap_index * 2 + 1;
+		if (left >= heap_size)
+		{
+			break;
+		}
+		const int32 right = left + 1;
+		const int32 child = right < heap_size && _rl_topk_below(topk, topk.heap[right], topk.heap[left]) ? right : left;
+		if (!_rl_topk_below(topk, topk.heap[child], topk.heap[heap_index]))
+		{
+			break;
+		}
+		const int32 slot = topk.heap[heap_index];
+		topk.heap[heap_index] = topk.heap[child];
+		topk.heap[child] = slot;
+		heap_index = child;
+	}
+}
+
+static bool _rl_topk_consider(const rl_move_candidate& candidate, void* user_data)
+{
+	_rl_topk& topk = *reinterpret_cast<_rl_topk*>(user_data);
+	const int32 score = topk.rank_fn(candidate, topk.rank_data);
+	const uint32 found_order = topk.num_found++;
+
+	// Once we have k moves, anything that doesn't outrank the worst of them can be turned away on its score alone,
+	// without copying it; anything that does takes the worst move's place
+	if (topk.num_moves == topk.k)
+	{
+		const int32 slot = topk.heap[0];
+		if (score <= topk.scores[slot])
+		{
+			return true;
+		}
+		rl_move_set(topk.moves[slot], *topk.board, candidate.index, candidate.offset, candidate.word, candidate.word_len);
+		topk.scores[slot] = score;
+		topk.found_order[slot] = found_order;
+		_rl_topk_sift_down(topk, 0, topk.k);
+		return true;
+	}
+
+	// Until then, every move goes into the next free slot, and is sifted up from the bottom of the heap
+	const int32 slot = topk.num_moves++;
+	rl_move_set(topk.moves[slot], *topk.board, candidate.index, candidate.offset, candidate.word, candidate.word_len);
+	topk.scores[slot] = score;
+	topk.found_order[slot] = found_order;
+	int32 heap_index = slot;
+	topk.heap[heap_index] = slot;
+	while (heap_index > 0)
+	{
+		const int32 parent = (heap_index - 1) / 2;
+		if (!_rl_topk_below(topk, topk.heap[heap_index], topk.heap[parent]))
+		{
+			break;
+		}
+		topk.heap[heap_index] = topk.heap[parent];
+		topk.heap[parent] = slot;
+		heap_index = parent;
+	}
+	return true;
+}
+
+int32 rl_search_board_topk(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, int32 k, rl_rank_fn rank_fn, rl_move* out_moves, void* rank_data, rl_search_stats* stats)
+{
+	if (k <= 0)
+	{
+		return 0;
+	}
+
+	_rl_topk topk;
+	topk.board = &board;
+	topk.rank_fn = rank_fn ? rank_fn : rl_rank_word_len;
+	topk.rank_data = rank_data;
+	topk.moves = out_moves;
+	topk.k = k;
+	topk.num_moves = 0;
+	topk.num_found = 0;
+	int32* data = reinterpret_cast<int32*>(malloc(k * (sizeof(int32) * 2 + sizeof(uint32))));
+	assert(data);
+	topk.heap = data;
+	topk.scores = data + k;
+	topk.found_order = reinterpret_cast<uint32*>(data + k * 2);
+	rl_search_board_visit(dawg, board, rack, _rl_topk_consider, &topk, stats);
+
+	// Pop the heap from the worst move up, to find the slot each move should end up in, best first
+	int32* order = reinterpret_cast<int32*>(malloc(MAX(topk.num_moves, 1) * sizeof(int32)));
+	assert(order);
+	for (int32 heap_size = topk.num_moves; heap_size > 0; heap_size--)
+	{
+		order[heap_size - 1] = topk.heap[0];
+		topk.heap[0] = topk.heap[heap_size - 1];
+		_rl_topk_sift_down(topk, 0, heap_size - 1);
+	}
+
+	// Then move each one into place, following each cycle of the permutation around with a single spare move; the
+	// heap array is free to track which slots have been placed
+	int32* placed = topk.heap;
+	memset(placed, 0, topk.num_moves * sizeof(int32));
+	for (int32 start = 0; start < topk.num_moves; start++)
+	{
+		if (placed[start] || order[start] == start)
+		{
+			continue;
+		}
+		rl_move spare;
+		memcpy(&spare, &out_moves[start], sizeof(rl_move));
+		int32 dest = start;
+		while (order[dest] != start)
+		{
+			memcpy(&out_moves[dest], &out_moves[order[dest]], sizeof(rl_move));
+			placed[dest] = 1;
+			dest = order[dest];
+		}
+		memcpy(&out_moves[dest], &spare, sizeof(rl_move));
+		placed[dest] = 1;
+	}
+	free(order);
+	free(data);
+	return topk.num_moves;
+}
+
+/*
+	A single anchor to be searched by rl_search_board_parallel. Tasks are numbered in the order that rl_search_board
+	reaches their anchors, so that the moves found by each task can be merged into the same result.
+*/
+struct _rl_anchor_task
+{
+	int32 anchor_index;
+	int32 num_preceding_blanks;
+	int32 num_preceding_letters;
+	bool across;
+};
+
+/*
+	State for one thread of a parallel search. Each worker searches with its own context (and so its own copy of the
+	rack), taking tasks from the front of its own range of task indices; once that range is empty, it steals the back
+	half of the largest range remaining among the other workers.
+*/
+struct _rl_search_worker
+{
+	std::mutex mutex;
+	int32 next_task;
+	int32 end_task;
+
+	rl_search_ctx ctx;
+	rl_move task_move;
+	rl_move move;
+	int32 move_task;
+
+	const _rl_anchor_task* tasks;
+	_rl_search_worker* workers;
+	int32 num_workers;
+};
+
+static bool _rl_task_move_preferred(const rl_move& move, int32 task_index, const rl_move& best, int32 best_task_index)
+{
+	// Determines which of two moves rl_search_board would end up with, given the tasks that found them: it keeps the
+	// first of the longest moves it finds (see _rl_accept_move), and it reaches anchors in order of their tasks
+#ifdef WITH_FAVORITE_LETTERS
+	return best_task_index < 0 || move.word_len > best.word_len || (move.word_len == best.word_len && task_index < best_task_index);
+#else
+	return task_index > best_task_index;
+#endif
+}
+
+static bool _rl_search_worker_take(_rl_search_worker& worker, int32& out_task_index)
+{
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.next_task < worker.end_task)
+	{
+		out_task_index = worker.next_task++;
+		return true;
+	}
+	return false;
+}
+
+static bool _rl_search_worker_steal(_rl_search_worker& worker)
+{
+	// Pick the worker with the most tasks left, then take half of them: by the time we come back to lock the victim,
+	// another thread may have got there first, in which case we simply look again
+	while (true)
+	{
+		_rl_search_worker* victim = nullptr;
+		int32 victim_num_tasks = 0;
+		for (int32 worker_index = 0; worker_index < worker.num_workers; worker_index++)
+		{
+			_rl_search_worker& other = worker.workers[worker_index];
+			std::lock_guard<std::mutex> lock(other.mutex);
+			if (other.end_task - other.next_task > victim_num_tasks)
+			{
+				victim = &other;
+				victim_num_tasks = other.end_task - other.next_task;
+			}
+		}
+		if (!victim)
+		{
+			return false;
+		}
+
+		int32 first_task;
+		int32 end_task;
+		{
+			std::lock_guard<std::mutex> lock(victim->mutex);
+			const int32 num_tasks = victim->end_task - victim->next_task;
+			if (num_tasks <= 0)
+			{
+				continue;
+			}
+			end_task = victim->end_task;
+			first_task = victim->end_task - (num_tasks + 1) / 2;
+			victim->end_task = first_task;
+		}
+
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.next_task = first_task;
+		worker.end_task = end_task;
+		return true;
+	}
+}
+
+static void _rl_search_worker_run(_rl_search_worker* worker)
+{
+	rl_search_ctx& ctx = worker->ctx;
+	do
+	{
+		int32 task_index;
+		while (_rl_search_worker_take(*worker, task_index))
+		{
+			// Search the task's anchor for its own best move, starting from scratch so that the result doesn't depend
+			// on which tasks this worker happened to search before it
+			const _rl_anchor_task& task = worker->tasks[task_index];
+			_rl_search_set_direction(ctx, task.across);
+			ctx.anchor_index = task.anchor_index;
+			rl_move_init(worker->task_move);
+			ctx.move = &worker->task_move;
+			ctx.move_anchor_index = -1;
+			_rl_search_anchor(ctx, task.num_preceding_blanks, task.num_preceding_letters);
+
+			if (worker->task_move.word_len > 0 && _rl_task_move_preferred(worker->task_move, task_index, worker->move, worker->move_task))
+			{
+				memcpy(&worker->move, &worker->task_move, sizeof(rl_move));
+				worker->move_task = task_index;
+			}
+		}
+	} while (_rl_search_worker_steal(*worker));
+}
+
+int32 rl_search_board_parallel(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, int32 num_threads, rl_search_stats* stats)
+{
+	// Per-node visit counts are kept in a single array shared by the whole search, so they can only be gathered from
+	// one thread
+	if (stats && stats->node_visits)
+	{
+		num_threads = 1;
+	}
+	num_threads = MAX(1, MIN(num_threads, RL_SEARCH_MAX_THREADS));
+
+	_rl_search_worker workers[RL_SEARCH_MAX_THREADS];
+	for (int32 worker_index = 0; worker_index < num_threads; worker_index++)
+	{
+		_rl_search_worker& worker = workers[worker_index];
+		_rl_search_init(worker.ctx, dawg, board, rack, worker.move, stats);
+		worker.move_task = -1;
+		worker.workers = workers;
+		worker.num_workers = num_threads;
+	}
+
+	// Gather every anchor on the board up front, in the order rl_search_board would search them: each anchor square
+	// is reached once per direction
+	_rl_anchor_task* tasks = reinterpret_cast<_rl_anchor_task*>(malloc(MAX(board.num_anchors * 2, 1) * sizeof(_rl_anchor_task)));
+	assert(tasks);
+	int32 num_tasks = 0;
+	rl_search_ctx& scan_ctx = workers[0].ctx;
+	for (int32 direction = 0; direction < 2; direction++)
+	{
+		const bool across = direction == 0;
+		_rl_search_set_direction(scan_ctx, across);
+		_rl_anchor_scan scan;
+		_rl_anchor_scan_init(scan, board, across);
+		_rl_anchor_task task;
+		task.across = across;
+		while (_rl_anchor_scan_next_anchor(scan_ctx, scan, task.anchor_index, task.num_preceding_blanks, task.num_preceding_letters))
+		{
+			assert(num_tasks < board.num_anchors * 2);
+			tasks[num_tasks++] = task;
+		}
+	}
+
+	// Give each worker an even share of the tasks to start with, then search them all (reusing the calling thread
+	// for the first worker)
+	for (int32 worker_index = 0; worker_index < num_threads; worker_index++)
+	{
+		workers[worker_index].tasks = tasks;
+		workers[worker_index].next_task = num_tasks * worker_index / num_threads;
+		workers[worker_index].end_task = num_tasks * (worker_index + 1) / num_threads;
+	}
+	std::thread threads[RL_SEARCH_MAX_THREADS];
+	for (int32 worker_index = 1; worker_index < num_threads; worker_index++)
+	{
+		threads[worker_index] = std::thread(_rl_search_worker_run, &workers[worker_index]);
+	}
+	_rl_search_worker_run(&workers[0]);
+	for (int32 worker_index = 1; worker_index < num_threads; worker_index++)
+	{
+		threads[worker_index].join();
+	}
+	free(tasks);
+
+	// Merge the workers' results: the best move comes out the same regardless of how the tasks were divided up
+	rl_move_init(move);
+	int32 move_task = -1;
+	int32 num_legal_moves = 0;
+	for (int32 worker_index = 0; worker_index < num_threads; worker_index++)
+	{
+		const _rl_search_worker& worker = workers[worker_index];
+		if (worker.move_task >= 0 && _rl_task_move_preferred(worker.move, worker.move_task, move, move_task))
+		{
+			memcpy(&move, &worker.move, sizeof(rl_move));
+			move_task = worker.move_task;
+		}
+		num_legal_moves += _rl_search_finish(worker.ctx, stats);
+	}
+	return num_legal_moves;
+}
+
+void rl_search_cache_init(rl_search_cache& cache)
+{
+	cache.dawg_generation = 0;
+	cache.board_generation = 0;
+	rl_rack_init(cache.rack);
+	cache.num_lines = 0;
+	cache.lines = nullptr;
+	cache.num_lines_searched = 0;
+}
+
+void rl_search_cache_free(rl_search_cache& cache)
+{
+	free(cache.lines);
+	rl_search_cache_init(cache);
+}
+
+static void _rl_search_cache_prepare(rl_search_cache& cache, const rl_dawg& dawg, const rl_board& board, const rl_rack& rack)
+{
+	// The cached results only hold for the lexicon, board and rack they were found with: if any of those has changed,
+	// forget every line, so that each is searched again. Lexicons and boards are told apart by their generation ids
+	// rather than their addresses, since either may be freed and rebuilt in the same place.
+	const int32 num_lines = board.size_y + board.size_x;
+	if (cache.num_lines != num_lines)
+	{
+		free(cache.lines);
+		cache.lines = reinterpret_cast<rl_search_cache_line*>(malloc(num_lines * sizeof(rl_search_cache_line)));
+		assert(cache.lines);
+		cache.num_lines = num_lines;
+		cache.board_generation = 0;
+	}
+	if (cache.dawg_generation != dawg.generation || cache.board_generation != board.generation || memcmp(cache.rack.counts, rack.counts, sizeof(rack.counts)) != 0)
+	{
+		for (int32 line_index = 0; line_index < num_lines; line_index++)
+		{
+			cache.lines[line_index].version = 0;
+		}
+		cache.dawg_generation = dawg.generation;
+		cache.board_generation = board.generation;
+		memcpy(&cache.rack, &rack, sizeof(rl_rack));
+	}
+}
+
+int32 rl_search_board_cached(const rl_dawg& dawg, const rl_board& board, const rl_rack& rack, rl_move& move, rl_search_cache& cache, rl_search_stats* stats)
+{
+	_rl_search_cache_prepare(cache, dawg, board, rack);
+	cache.num_lines_searched = 0;
+
+	rl_search_ctx ctx;
+	_rl_search_init(ctx, dawg, board, rack, move, stats);
+
+	// Visit every row and then every column, as rl_search_board does, searching only the lines that have changed since
+	// their results were cached; the moves found in each line are then merged in order, exactly as the moves found by
+	// each anchor are in a parallel search
+	int32 num_legal_moves = 0;
+	int32 move_line_index = -1;
+	for (int32 direction = 0; direction < 2; direction++)
+	{
+		const bool across = direction == 0;
+		_rl_search_set_direction(ctx, across);
+		const int32 num_lines = across ? board.size_y : board.size_x;
+		const uint32* line_versions = across ? board.row_versions : board.column_versions;
+		for (int32 line_index = 0; line_index < num_lines; line_index++)
+		{
+			const int32 cache_line_index = across ? line_index : board.size_y + line_index;
+			rl_search_cache_line& line = cache.lines[cache_line_index];
+			if (line.version != line_versions[line_index])
+			{
+				rl_move_init(line.move);
+				ctx.move = &line.move;
+				ctx.move_anchor_index = -1;
+				ctx.num_legal_moves = 0;
+
+				_rl_anchor_scan scan;
+				_rl_anchor_scan_init_lines(scan, board, across, line_index, line_index + 1);
+				int32 num_preceding_blanks;
+				int32 num_preceding_letters;
+				while (_rl_anchor_scan_next_anchor(ctx, scan, ctx.anchor_index, num_preceding_blanks, num_preceding_letters))
+				{
+					_rl_search_anchor(ctx, num_preceding_blanks, num_preceding_letters);
+				}
+
+				line.num_legal_moves = ctx.num_legal_moves;
+				line.version = line_versions[line_index];
+				cache.num_lines_searched++;
+			}
+
+			num_legal_moves += line.num_legal_moves;
+			if (line.num_legal_moves > 0 && _rl_task_move_preferred(line.move, cache_line_index, move, move_line_index))
+			{
+				memcpy(&move, &line.move, sizeof(rl_move));
+				move_line_index = cache_line_index;
+			}
+		}
+	}
+
+	_rl_search_finish(ctx, stats);
+	return num_legal_moves;
 }
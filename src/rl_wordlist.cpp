@@ -0,0 +1,169 @@
+#include "rl_wordlist.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include "rl_util.h"
+
+// Buckets smaller than this are sorted by insertion sort instead of being distributed further
+static const int32 _RL_WORDLIST_INSERTION_SORT_THRESHOLD = 32;
+
+// Bucket 0 holds words that end at the current depth; buckets 1 through 26 hold 'a' through 'z', and bucket 27 holds
+// the GADDAG separator, which sorts after 'z'
+static const int32 _RL_WORDLIST_NUM_BUCKETS = 28;
+
+static int32 _rl_wordlist_bucket(const uint8* buf, const rl_wordlist_entry& entry, int32 depth)
+{
+	return depth < entry.len ? buf[entry.offset + depth] - 'a' + 1 : 0;
+}
+
+static bool _rl_wordlist_less(const uint8* buf, const rl_wordlist_entry& lhs, const rl_wordlist_entry& rhs, int32 depth)
+{
+	// Both words are known to share their first depth letters
+	const int32 min_len = MIN(lhs.len, rhs.len);
+	if (min_len > depth)
+	{
+		const int cmp = memcmp(buf + lhs.offset + depth, buf + rhs.offset + depth, min_len - depth);
+		if (cmp != 0)
+		{
+			return cmp < 0;
+		}
+	}
+	return lhs.len < rhs.len;
+}
+
+static void _rl_wordlist_insertion_sort(const uint8* buf, rl_wordlist_entry* entries, int32 num_entries, int32 depth)
+{
+	for (int32 i = 1; i < num_entries; i++)
+	{
+		const rl_wordlist_entry entry = entries[i];
+		int32 j = i;
+		while (j > 0 && _rl_wordlist_less(buf, entry, entries[j - 1], depth))
+		{
+			entries[j] = entries[j - 1];
+			j--;
+		}
+		entries[j] = entry;
+	}
+}
+
+static void _rl_wordlist_radix_sort(const uint8* buf, rl_wordlist_entry* entries, rl_wordlist_entry* scratch, int32 num_entries, int32 depth)
+{
+	if (num_entries < _RL_WORDLIST_INSERTION_SORT_THRESHOLD)
+	{
+		_rl_wordlist_insertion_sort(buf, entries, num_entries, depth);
+		return;
+	}
+
+	// Count the number of words that fall into each bucket, based on their letter at the current depth
+	int32 bucket_starts[_RL_WORDLIST_NUM_BUCKETS + 1] = { 0 };
+	for (int32 i = 0; i < num_entries; i++)
+	{
+		bucket_starts[_rl_wordlist_bucket(buf, entries[i], depth) + 1]++;
+	}
+	for (int32 bucket = 0; bucket < _RL_WORDLIST_NUM_BUCKETS; bucket++)
+	{
+		bucket_starts[bucket + 1] += bucket_starts[bucket];
+	}
+
+	// Distribute the entries into scratch space by bucket (stably), then copy them back
+	int32 bucket_positions[_RL_WORDLIST_NUM_BUCKETS];
+	memcpy(bucket_positions, bucket_starts, sizeof(bucket_positions));
+	for (int32 i = 0; i < num_entries; i++)
+	{
+		scratch[bucket_positions[_rl_wordlist_bucket(buf, entries[i], depth)]++] = entries[i];
+	}
+	memcpy(entries, scratch, num_entries * sizeof(rl_wordlist_entry));
+
+	// Words in bucket 0 all end here, so they're identical and already in place: recurse into each letter's bucket
+	for (int32 bucket = 1; bucket < _RL_WORDLIST_NUM_BUCKETS; bucket++)
+	{
+		const int32 bucket_size = bucket_starts[bucket + 1] - bucket_starts[bucket];
+		if (bucket_size > 1)
+		{
+			_rl_wordlist_radix_sort(buf, entries + bucket_starts[bucket], scratch, bucket_size, depth + 1);
+		}
+	}
+}
+
+void rl_wordlist_init(rl_wordlist& wordlist, size_t buf_capacity)
+{
+	wordlist.buf_capacity = MAX(buf_capacity, static_cast<size_t>(4096));
+	wordlist.buf = reinterpret_cast<uint8*>(malloc(wordlist.buf_capacity));
+	assert(wordlist.buf);
+	wordlist.buf_size = 0;
+
+	// Guess at a typical word length to pre-size the entries array
+	wordlist.entries_capacity = static_cast<int32>(MAX(wordlist.buf_capacity / 8, static_cast<size_t>(1024)));
+	wordlist.entries = reinterpret_cast<rl_wordlist_entry*>(malloc(wordlist.entries_capacity * sizeof(rl_wordlist_entry)));
+	assert(wordlist.entries);
+	wordlist.num_entries = 0;
+}
+
+void rl_wordlist_free(rl_wordlist& wordlist)
+{
+	free(wordlist.buf);
+	free(wordlist.entries);
+	memset(&wordlist, 0, sizeof(wordlist));
+}
+
+void rl_wordlist_clear(rl_wordlist& wordlist)
+{
+	wordlist.buf_size = 0;
+	wordlist.num_entries = 0;
+}
+
+void rl_wordlist_append(rl_wordlist& wordlist, const uint8* word, int32 word_len)
+{
+	if (wordlist.buf_size + word_len > wordlist.buf_capacity)
+	{
+		wordlist.buf_capacity = MAX(wordlist.buf_capacity * 2, wordlist.buf_size + word_len);
+		wordlist.buf = reinterpret_cast<uint8*>(realloc(wordlist.buf, wordlist.buf_capacity));
+		assert(wordlist.buf);
+	}
+	if (wordlist.num_entries == wordlist.entries_capacity)
+	{
+		wordlist.entries_capacity *= 2;
+		wordlist.entries = reinterpret_cast<rl_wordlist_entry*>(realloc(wordlist.entries, wordlist.entries_capacity * sizeof(rl_wordlist_entry)));
+		assert(wordlist.entries);
+	}
+	assert(wordlist.buf_size + word_len <= UINT32_MAX);
+
+	memcpy(wordlist.buf + wordlist.buf_size, word, word_len);
+	rl_wordlist_entry& entry = wordlist.entries[wordlist.num_entries++];
+	entry.offset = static_cast<uint32>(wordlist.buf_size);
+	entry.len = word_len;
+	wordlist.buf_size += word_len;
+}
+
+size_t rl_wordlist_sort_size(const rl_wordlist& wordlist)
+{
+	return wordlist.buf_size + 2 * static_cast<size_t>(wordlist.num_entries) * sizeof(rl_wordlist_entry);
+}
+
+void rl_wordlist_sort(rl_wordlist& wordlist)
+{
+	if (wordlist.num_entries < 2)
+	{
+		return;
+	}
+
+	rl_wordlist_entry* scratch = reinterpret_cast<rl_wordlist_entry*>(malloc(wordlist.num_entries * sizeof(rl_wordlist_entry)));
+	assert(scratch);
+	_rl_wordlist_radix_sort(wordlist.buf, wordlist.entries, scratch, wordlist.num_entries, 0);
+	free(scratch);
+
+	// Identical words are now adjacent: keep only the first of each run
+	int32 num_unique = 1;
+	for (int32 i = 1; i < wordlist.num_entries; i++)
+	{
+		const rl_wordlist_entry& prev = wordlist.entries[num_unique - 1];
+		const rl_wordlist_entry& entry = wordlist.entries[i];
+		if (entry.len != prev.len || memcmp(wordlist.buf + entry.offset, wordlist.buf + prev.offset, entry.len) != 0)
+		{
+			wordlist.entries[num_unique++] = entry;
+		}
+	}
+	wordlist.num_entries = num_unique;
+}
@@ -0,0 +1,283 @@
+#include "rl_wordreader.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RL_WORDREADER_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cassert>
+
+#include "rl_util.h"
+
+// The buffer is followed by this much whitespace padding, so that a full 64-byte chunk can always be classified
+static const int32 _RL_WORDREADER_PADDING = 64;
+
+static int32 _rl_wordreader_read_fd(int fd, uint8* buf, int32 size)
+{
+#ifdef _WIN32
+	return _read(fd, buf, static_cast<unsigned int>(size));
+#else
+	return static_cast<int32>(read(fd, buf, size));
+#endif
+}
+
+#ifndef RL_WORDREADER_SSE2
+static bool _rl_is_space(uint8 c)
+{
+	// Matches the set of characters that isspace (and therefore fscanf) treats as whitespace
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+#endif
+
+static void _rl_wordreader_classify(const uint8* p, uint64& out_space_bits, uint64& out_invalid_bits)
+{
+#ifdef RL_WORDREADER_SSE2
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i four = _mm_set1_epi8('\r' - '\t');
+	const __m128i a = _mm_set1_epi8('a');
+	const __m128i twenty_five = _mm_set1_epi8('z' - 'a');
+	uint64 space_bits = 0;
+	uint64 letter_bits = 0;
+	for (int32 i = 0; i < 4; i++)
+	{
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+
+		// Unsigned range checks: (x - lo) <= (hi - lo) iff min(x - lo, hi - lo) == x - lo
+		const __m128i from_tab = _mm_sub_epi8(bytes, tab);
+		const __m128i is_control_space = _mm_cmpeq_epi8(_mm_min_epu8(from_tab, four), from_tab);
+		const __m128i is_space = _mm_or_si128(_mm_cmpeq_epi8(bytes, space), is_control_space);
+		const __m128i from_a = _mm_sub_epi8(bytes, a);
+		const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(from_a, twenty_five), from_a);
+
+		space_bits |= static_cast<uint64>(static_cast<uint32>(_mm_movemask_epi8(is_space))) << (i * 16);
+		letter_bits |= static_cast<uint64>(static_cast<uint32>(_mm_movemask_epi8(is_letter))) << (i * 16);
+	}
+	out_space_bits = space_bits;
+	out_invalid_bits = ~(space_bits | letter_bits);
+#else
+	uint64 space_bits = 0;
+	uint64 invalid_bits = 0;
+	for (int32 i = 0; i < 64; i++)
+	{
+		const uint8 c = p[i];
+		if (_rl_is_space(c))
+		{
+			space_bits |= static_cast<uint64>(1) << i;
+		}
+		else if (c < 'a' || c > 'z')
+		{
+			invalid_bits |= static_cast<uint64>(1) << i;
+		}
+	}
+	out_space_bits = space_bits;
+	out_invalid_bits = invalid_bits;
+#endif
+}
+
+static void _rl_wordreader_load_chunk(rl_wordreader& reader, int32 offset)
+{
+	// Chunks are aligned to multiples of 64 bytes from the start of the buffer
+	const int32 chunk_start = offset & ~63;
+	if (chunk_start != reader.chunk_start)
+	{
+		_rl_wordreader_classify(reader.buf + chunk_start, reader.chunk_space_bits, reader.chunk_invalid_bits);
+		reader.chunk_start = chunk_start;
+	}
+}
+
+static bool _rl_wordreader_refill(rl_wordreader& reader)
+{
+	// Discard everything before the current position, shifting any partial word to the front of the buffer
+	if (reader.eof)
+	{
+		return false;
+	}
+	const int32 num_kept = reader.buf_size - reader.pos;
+	memmove(reader.buf, reader.buf + reader.pos, num_kept);
+	reader.buf_size = num_kept;
+	reader.pos = 0;
+	reader.chunk_start = -1;
+
+	// Make room to read a full block after any partial word that was kept, growing the buffer if needed: this only
+	// happens until the buffer holds two blocks, unless a single word is longer than a whole block
+	if (reader.buf_capacity - reader.buf_size < RL_WORDREADER_BLOCK_SIZE)
+	{
+		reader.buf_capacity += RL_WORDREADER_BLOCK_SIZE;
+		uint8* new_buf = reinterpret_cast<uint8*>(realloc(reader.buf, reader.buf_capacity + _RL_WORDREADER_PADDING));
+		assert(new_buf);
+		reader.buf = new_buf;
+	}
+
+	const int32 num_read = _rl_wordreader_read_fd(reader.fd, reader.buf + reader.buf_size, RL_WORDREADER_BLOCK_SIZE);
+	if (num_read < 0)
+	{
+		printf("WARNING: Could not read word list from fd %d\n", reader.fd);
+		reader.eof = true;
+		reader.error = true;
+	}
+	else if (num_read == 0)
+	{
+		reader.eof = true;
+	}
+	else
+	{
+		reader.buf_size += num_read;
+	}
+
+	// Pad the valid bytes with whitespace, so that classifying a chunk never looks at stale data
+	memset(reader.buf + reader.buf_size, ' ', _RL_WORDREADER_PADDING);
+	return num_read > 0;
+}
+
+void rl_wordreader_init(rl_wordreader& reader, int fd)
+{
+	reader.fd = fd;
+	reader.owns_fd = false;
+	reader.eof = false;
+	reader.error = false;
+	reader.buf_capacity = RL_WORDREADER_BLOCK_SIZE;
+	reader.buf = reinterpret_cast<uint8*>(malloc(reader.buf_capacity + _RL_WORDREADER_PADDING));
+	assert(reader.buf);
+	reader.buf_size = 0;
+	reader.pos = 0;
+	reader.chunk_start = -1;
+	reader.chunk_space_bits = 0;
+	reader.chunk_invalid_bits = 0;
+	memset(reader.buf, ' ', _RL_WORDREADER_PADDING);
+}
+
+bool rl_wordreader_open(rl_wordreader& reader, const char* path)
+{
+#ifdef _WIN32
+	const int fd = _open(path, _O_RDONLY | _O_BINARY);
+#else
+	const int fd = open(path, O_RDONLY);
+#endif
+	if (fd < 0)
+	{
+		return false;
+	}
+	rl_wordreader_init(reader, fd);
+	reader.owns_fd = true;
+	return true;
+}
+
+void rl_wordreader_free(rl_wordreader& reader)
+{
+	if (reader.owns_fd)
+	{
+#ifdef _WIN32
+		_close(reader.fd);
+#else
+		close(reader.fd);
+#endif
+	}
+	free(reader.buf);
+}
+
+bool rl_wordreader_next(rl_wordreader& reader, const uint8*& out_word, int32& out_word_len, bool& out_valid)
+{
+	// Skip over whitespace to find the first byte of the next word, reading more input as needed
+	while (true)
+	{
+		if (reader.pos >= reader.buf_size)
+		{
+			reader.pos = reader.buf_size;
+			if (!_rl_wordreader_refill(reader))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		_rl_wordreader_load_chunk(reader, reader.pos);
+		const int32 bit = reader.pos - reader.chunk_start;
+		const uint64 non_space_bits = ~reader.chunk_space_bits >> bit;
+		if (non_space_bits != 0)
+		{
+			reader.pos += rl_ctz64(non_space_bits);
+			if (reader.pos < reader.buf_size)
+			{
+				break;
+			}
+		}
+		else
+		{
+			reader.pos = reader.chunk_start + 64;
+		}
+	}
+
+	// Scan forward from the start of the word to the next whitespace byte, accumulating invalid bits along the way
+	while (true)
+	{
+		const int32 start = reader.pos;
+		int32 end = start;
+		uint64 invalid_bits = 0;
+		while (true)
+		{
+			_rl_wordreader_load_chunk(reader, end);
+			const int32 bit = end - reader.chunk_start;
+			const uint64 space_bits = reader.chunk_space_bits >> bit;
+			if (space_bits != 0)
+			{
+				const int32 len = rl_ctz64(space_bits);
+				const uint64 span_bits = len < 64 ? (static_cast<uint64>(1) << len) - 1 : ~static_cast<uint64>(0);
+				invalid_bits |= (reader.chunk_invalid_bits >> bit) & span_bits;
+				end += len;
+				break;
+			}
+			invalid_bits |= reader.chunk_invalid_bits >> bit;
+			end = reader.chunk_start + 64;
+		}
+
+		// If the word runs into the padding at the end of the buffer, it may continue in the next block
+		if (end >= reader.buf_size && !reader.eof)
+		{
+			// A failed read leaves the word incomplete, so it mustn't be returned
+			if (!_rl_wordreader_refill(reader) && reader.error)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		end = end < reader.buf_size ? end : reader.buf_size;
+		out_word = reader.buf + start;
+		out_word_len = end - start;
+		out_valid = invalid_bits == 0;
+		reader.pos = end;
+		return true;
+	}
+}
+
+size_t rl_wordreader_file_size(int fd)
+{
+#ifdef _WIN32
+	struct _stat64 st;
+	if (_fstat64(fd, &st) == 0 && (st.st_mode & _S_IFREG) != 0)
+	{
+		return static_cast<size_t>(st.st_size);
+	}
+#else
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+	{
+		return static_cast<size_t>(st.st_size);
+	}
+#endif
+	return 0;
+}
@@ -3,13 +3,22 @@
 #include "testing.h"
 #include "rl_types_tests.h"
 #include "rl_edgemap_tests.h"
+#include "rl_edgepool_tests.h"
 #include "rl_node_tests.h"
 #include "rl_nodearray_tests.h"
 #include "rl_nodelookup_tests.h"
+#include "rl_wordreader_tests.h"
+#include "rl_wordlist_tests.h"
 #include "rl_dawg_tests.h"
+#include "rl_dawgeditor_tests.h"
 #include "rl_distribution_tests.h"
 #include "rl_rack_tests.h"
 #include "rl_bag_tests.h"
+#include "rl_board_tests.h"
+#include "rl_search_tests.h"
+#include "rl_lexicon_tests.h"
+#include "rl_pattern_tests.h"
+#include "rl_anagram_tests.h"
 
 /*
 	Runs all tests in the roselexlib library. This is a good entry point for
@@ -34,34 +43,73 @@ int main(int argc, char* argv[])
 	t_run(test_edgemap_insert);
 	t_run(test_edgemap_find);
 	t_run(test_edgemap_replace);
+	t_run(test_edgemap_remove);
+
+	// rl_edgepool is a slab allocator that provides storage for edgemaps while the
+	// DAWG is being built, recycling storage from nodes that are merged away
+	t_run(test_edgepool_init);
+	t_run(test_edgepool_alloc);
+	t_run(test_edgepool_edgemap);
 
 	// rl_node represents a single node in the DAWG, with each containing its own
 	// edgemap
 	t_run(test_node_init);
 	t_run(test_node_reset);
 	t_run(test_node_signature);
+	t_run(test_node_equals);
 
 	// rl_nodearray stores all the nodes in the DAWG in a flat array
 	t_run(test_nodearray_init);
 	t_run(test_nodearray_push);
 	t_run(test_nodearray_pop);
+	t_run(test_nodearray_pooled);
 
 	// rl_nodelookup is a hash map that allows us to register the association between
-	// an rl_node's unique signature (i.e. hash) and its index in the nodearray,
-	// facilitating fast lookups when building and finalizing the DAWG
+	// an rl_node's signature (i.e. hash) and its index in the nodearray, facilitating
+	// fast lookups of structurally identical nodes when building and finalizing the
+	// DAWG
 	t_run(test_nodelookup_init);
 	t_run(test_nodelookup_insert);
 	t_run(test_nodelookup_find);
+	t_run(test_nodelookup_remove);
+
+	// rl_wordreader splits a word list into individual words as it's read from disk,
+	// flagging any words that contain invalid characters
+	t_run(test_wordreader_next);
+	t_run(test_wordreader_blocks);
+	t_run(test_wordreader_read_error);
+
+	// rl_wordlist holds a list of words in memory, so that they can be sorted and
+	// deduplicated before being added to a DAWG
+	t_run(test_wordlist_append);
+	t_run(test_wordlist_sort);
 
 	// rl_dawg represents a "directed acyclic word graph", or DAWG. The DAWG is built
 	// from a (potentially very large) list of legal words - it's a space-efficient
 	// representation of those words that can be efficiently traversed to find legal
 	// moves. rl_dawg_ctx is a helper struct used during the building of the DAWG.
 	t_run(test_dawg_ctx_init);
+	t_run(test_dawg_ctx_init_arena);
 	t_run(test_dawg_ctx_add);
 	t_run(test_dawg_ctx_finalize);
 	t_run(test_dawg_ctx_move_nodes);
+	t_run(test_dawg_freeze);
 	t_run(test_dawg_build);
+	t_run(test_dawg_build_fd);
+	t_run(test_dawg_save_load);
+	t_run(test_dawg_build_parallel);
+	t_run(test_dawg_build_unsorted);
+	t_run(test_dawg_build_gaddag);
+	t_run(test_dawg_word_ids);
+	t_run(test_dawg_reorder);
+	t_run(test_dawg_pack);
+	t_run(test_dawg_contains_batch);
+
+	// rl_dawgeditor allows words to be added to and removed from a finished DAWG, keeping
+	// it minimal without rebuilding it from scratch
+	t_run(test_dawgeditor_add);
+	t_run(test_dawgeditor_remove);
+	t_run(test_dawgeditor_random);
 
 	// rl_distribution is a set of weights recording how prevalent any given letter is
 	// within a set of letters (e.g. words in an input word list, letter tiles in a rack)
@@ -82,6 +130,39 @@ int main(int argc, char* argv[])
 	t_run(test_bag_init);
 	t_run(test_bag_draw);
 
+	// rl_board scores moves by the value of their letters, with premium squares multiplying
+	// the value of a letter or a whole word
+	t_run(test_board_premiums);
+	t_run(test_board_score_move);
+	t_run(test_board_anchor_index);
+
+	// rl_search finds legal moves on an rl_board, using a DAWG or a GADDAG: either one
+	// should yield exactly the same moves
+	t_run(test_search_board_gaddag);
+	t_run(test_search_segment_gaddag);
+	t_run(test_search_segment_pruning);
+	t_run(test_search_board_packed);
+	t_run(test_search_board_parallel);
+	t_run(test_search_board_cached);
+	t_run(test_search_board_visit);
+	t_run(test_search_board_topk);
+	t_run(test_search_board_best_score);
+
+	// rl_pattern queries a DAWG for every word matching a wildcard pattern, optionally
+	// limited to the words that can be played from a rack
+	t_run(test_pattern_compile);
+	t_run(test_pattern_match);
+
+	// rl_anagram_index groups the words of a DAWG by their letters, to find anagrams and
+	// every word that can be formed from a rack without a board
+	t_run(test_anagram_build);
+	t_run(test_anagram_find);
+
+	// rl_lexicon shares one copy of each DAWG between every user in the process, loading
+	// it on first use and unloading it once the last user releases it
+	t_run(test_lexicon_acquire_release);
+	t_run(test_lexicon_threads);
+
 	t_end();
 
 	return 0;
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstring>
+
+#include "testing.h"
+#include "rl_testing.h"
+#include "rl_anagram.h"
+
+#include "rl_types.h"
+#include "rl_dawg.h"
+#include "rl_rack.h"
+
+static const char* _test_anagram_words =
+	"act\nacts\nal\narts\nas\nat\ncat\ncats\nqat\nquiz\nrats\nscat\nstar\nta\ntact\ntacts\ntars\ntsar\n";
+
+// Collects every word reported by an anagram query, spelled out from its ID, as a newline-separated string
+struct _test_anagram_results
+{
+	const rl_dawg* dawg;
+	char text[512];
+	int32 text_len;
+	int32 max_words;
+	int32 num_words;
+	bool lengths_match;
+};
+
+static bool _test_anagram_collect(int32 word_id, int32 word_len, void* user_data)
+{
+	_test_anagram_results& results = *reinterpret_cast<_test_anagram_results*>(user_data);
+	uint8 word[RL_MAX_WORD_LEN];
+	const int32 actual_len = rl_dawg_word_at(*results.dawg, word_id, word);
+	results.lengths_match = results.lengths_match && actual_len == word_len;
+	if (results.text_len + actual_len + 1 < static_cast<int32>(sizeof(results.text)))
+	{
+		memcpy(results.text + results.text_len, word, actual_len);
+		results.text_len += actual_len;
+		results.text[results.text_len++] = '\n';
+		results.text[results.text_len] = '\0';
+	}
+	return ++results.num_words < results.max_words;
+}
+
+static void _test_anagram_reset(_test_anagram_results& results, const rl_dawg& dawg, int32 max_words = 1000)
+{
+	results.dawg = &dawg;
+	results.text[0] = '\0';
+	results.text_len = 0;
+	results.max_words = max_words;
+	results.num_words = 0;
+	results.lengths_match = true;
+}
+
+static int32 _test_anagram_find(const rl_anagram_index& index, const rl_dawg& dawg, const char* letters, _test_anagram_results& results)
+{
+	_test_anagram_reset(results, dawg);
+	return rl_anagram_find(index, reinterpret_cast<const uint8*>(letters), static_cast<int32>(strlen(letters)), _test_anagram_collect, &results);
+}
+
+static int32 _test_anagram_find_sub(const rl_anagram_index& index, const rl_dawg& dawg, const char* rack_letters, _test_anagram_results& results, int32 max_words = 1000)
+{
+	_test_anagram_reset(results, dawg, max_words);
+	rl_rack rack;
+	rl_test_rack_init(rack, rack_letters);
+	return rl_anagram_find_sub(index, rack, _test_anagram_collect, &results);
+}
+
+static int32 _test_anagram_count_sub(const char* rack_letters)
+{
+	// Counts the words in the list that can be spelled from the rack, by checking each in turn
+	int32 num_words = 0;
+	for (const char* word = _test_anagram_words; *word != '\0'; word = strchr(word, '\n') + 1)
+	{
+		int32 counts[26];
+		memset(counts, 0, sizeof(counts));
+		for (const char* c = rack_letters; *c != '\0'; c++)
+		{
+			counts[*c - 'a']++;
+		}
+		bool playable = true;
+		for (const char* c = word; *c != '\n'; c++)
+		{
+			playable = playable && --counts[*c - 'a'] >= 0;
+		}
+		num_words += playable ? 1 : 0;
+	}
+	return num_words;
+}
+
+const char* test_anagram_build()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_anagram_words) == 18);
+
+	rl_anagram_index index;
+	rl_anagram_init(index);
+	t_assert(rl_anagram_build(index, dawg) == 18);
+	t_assert(index.num_words == 18);
+	t_assert(index.num_signatures == 10);
+	t_assert(rl_anagram_num_bytes(index) == index.num_nodes * 12 + 4 + 18 * 4);
+
+	// Rare letters come first in signature order: few words use 'q' or 'z', and most use 'a' or 't'
+	t_assert(index.letter_ranks['q' - 'a'] < index.letter_ranks['t' - 'a']);
+	t_assert(index.letter_ranks['z' - 'a'] < index.letter_ranks['a' - 'a']);
+	for (int32 rank = 0; rank < 26; rank++)
+	{
+		t_assert(index.letter_ranks[index.rank_letters[rank]] == rank);
+	}
+
+	// Every word appears in exactly one group
+	bool seen[18];
+	memset(seen, 0, sizeof(seen));
+	for (int32 i = 0; i < index.num_words; i++)
+	{
+		t_assert(!seen[index.word_ids[i]]);
+		seen[index.word_ids[i]] = true;
+	}
+
+	// Rebuilding replaces the old contents, and a packed DAWG gives the same index
+	rl_dawg packed;
+	rl_dawg_init(packed);
+	rl_dawg_pack(dawg, packed);
+	rl_anagram_index packed_index;
+	rl_anagram_init(packed_index);
+	t_assert(rl_anagram_build(packed_index, packed) == 18);
+	t_assert(rl_anagram_build(packed_index, packed) == 18);
+	t_assert(packed_index.num_nodes == index.num_nodes);
+	t_assert(memcmp(packed_index.word_ids, index.word_ids, index.num_words * sizeof(int32)) == 0);
+
+	rl_anagram_free(packed_index);
+	t_assert(!packed_index.data);
+	rl_anagram_free(index);
+	rl_dawg_free(packed);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_anagram_find()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_anagram_words) == 18);
+	rl_anagram_index index;
+	rl_anagram_init(index);
+	rl_anagram_build(index, dawg);
+
+	// Exact anagrams come from a single lookup, in order of their IDs
+	_test_anagram_results results;
+	t_assert(_test_anagram_find(index, dawg, "tca", results) == 2);
+	t_assert(strcmp(results.text, "act\ncat\n") == 0);
+	t_assert(_test_anagram_find(index, dawg, "rats", results) == 5);
+	t_assert(strcmp(results.text, "arts\nrats\nstar\ntars\ntsar\n") == 0);
+	t_assert(results.lengths_match);
+	t_assert(_test_anagram_find(index, dawg, "cts", results) == 0);
+	t_assert(_test_anagram_find(index, dawg, "tacks", results) == 0);
+	t_assert(_test_anagram_find(index, dawg, "", results) == 0);
+	t_assert(_test_anagram_find(index, dawg, "Cat", results) == 0);
+
+	// Sub-anagrams include every word that some or all of the rack spells
+	t_assert(_test_anagram_find_sub(index, dawg, "acst", results) == 8);
+	t_assert(strstr(results.text, "scat\n") && strstr(results.text, "ta\n") && !strstr(results.text, "tact\n"));
+	t_assert(results.lengths_match);
+	t_assert(_test_anagram_find_sub(index, dawg, "acstt", results) == 10);
+	t_assert(_test_anagram_find_sub(index, dawg, "qz", results) == 0);
+	t_assert(_test_anagram_find_sub(index, dawg, "", results) == 0);
+	const char* racks[] = { "a", "at", "tas", "quiztar", "acsttl", "aaccssttqrlz", "ttttttt" };
+	for (int32 rack_index = 0; rack_index < COUNT_OF(racks); rack_index++)
+	{
+		t_assert(_test_anagram_find_sub(index, dawg, racks[rack_index], results) == _test_anagram_count_sub(racks[rack_index]));
+	}
+
+	// The query stops as soon as the callback asks it to
+	t_assert(_test_anagram_find_sub(index, dawg, "acst", results, 3) == 3);
+	t_assert(results.num_words == 3);
+
+	rl_anagram_free(index);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
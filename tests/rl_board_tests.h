@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstring>
+
+#include "testing.h"
+#include "rl_testing.h"
+#include "rl_board.h"
+
+#include "rl_types.h"
+#include "rl_dawg.h"
+
+static int32 _test_board_score(const rl_board& board, int32 x, int32 y, bool across, const char* word)
+{
+	return rl_board_score_move(board, rl_board_index(board, x, y), rl_board_offset(board, across), reinterpret_cast<const uint8*>(word), static_cast<int32>(strlen(word)));
+}
+
+const char* test_board_premiums()
+{
+	rl_board board;
+	rl_board_init(board, 20, 16);
+
+	// A new board scores letters at their standard values, with no premium squares
+	t_assert(board.letter_values['a' - 'a'] == 1 && board.letter_values['q' - 'a'] == 10);
+	t_assert(!board.letter_multipliers && !board.word_multipliers);
+	t_assert(_test_board_score(board, 0, 0, true, "quiz") == 22);
+
+	// Setting one premium square leaves every other square without a multiplier
+	rl_board_set_premium(board, rl_board_index(board, 1, 0), 3, 1);
+	t_assert(board.letter_multipliers[rl_board_index(board, 1, 0)] == 3);
+	t_assert(board.letter_multipliers[rl_board_index(board, 2, 0)] == 1);
+	t_assert(board.word_multipliers[rl_board_index(board, 1, 0)] == 1);
+	t_assert(_test_board_score(board, 0, 0, true, "quiz") == 24);
+
+	// The standard layout repeats every 15 squares in each direction
+	rl_board_set_standard_premiums(board);
+	t_assert(board.word_multipliers[rl_board_index(board, 0, 0)] == 3);
+	t_assert(board.word_multipliers[rl_board_index(board, 7, 7)] == 2);
+	t_assert(board.letter_multipliers[rl_board_index(board, 5, 5)] == 3);
+	t_assert(board.letter_multipliers[rl_board_index(board, 3, 0)] == 2);
+	t_assert(board.letter_multipliers[rl_board_index(board, 1, 0)] == 1);
+	t_assert(board.word_multipliers[rl_board_index(board, 15, 15)] == 3);
+	t_assert(board.letter_multipliers[rl_board_index(board, 18, 15)] == 2);
+
+	rl_board_free(board);
+	return nullptr;
+}
+
+const char* test_board_score_move()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, "aa\nat\ncater\ncats\ntt\n") == 5);
+
+	rl_board board;
+	rl_board_init(board, 15, 15);
+	rl_board_set_standard_premiums(board);
+
+	// Through the center square (double word) and onto a double letter: (3 + 1 + 1 + 1 + 1*2) * 2
+	t_assert(_test_board_score(board, 7, 7, true, "cater") == 16);
+	rl_board_write(dawg, board, rl_board_index(board, 7, 7), true, reinterpret_cast<const uint8*>("cater"), 5);
+
+	// Squares beside the word know the value of the letters they'd join up with
+	t_assert(board.cross_sums_y[rl_board_index(board, 8, 8)] == 1);
+	t_assert(board.cross_sums_y[rl_board_index(board, 7, 6)] == 3);
+	t_assert(board.cross_sums_x[rl_board_index(board, 6, 7)] == 7);
+	t_assert(board.cross_sums_x[rl_board_index(board, 8, 8)] == -1);
+	t_assert(board.cross_sums_y[rl_board_index(board, 0, 0)] == -1);
+
+	// Letters already on the board count at face value, without their square's premium
+	t_assert(_test_board_score(board, 7, 7, false, "cats") == 6);
+
+	// Playing alongside a word scores each cross word too: "at" on a double letter and a plain square makes 2 + 1 for
+	// itself, plus (1 + 2) for "aa" and (1 + 1) for "tt"
+	t_assert(_test_board_score(board, 8, 8, true, "at") == 8);
+
+	rl_board_free(board);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+static bool _test_board_anchor_index_matches(const rl_board& board)
+{
+	// Checks the anchor index against the letters on the board, square by square
+	int32 num_anchors = 0;
+	for (int32 y = 0; y < board.size_y; y++)
+	{
+		for (int32 x = 0; x < board.size_x; x++)
+		{
+			const bool is_anchor = board.letters[rl_board_index(board, x, y)] == RL_ANCHOR;
+			const bool in_row = (board.anchor_rows[y * board.anchor_row_words + x / 64] & (1ULL << (x % 64))) != 0;
+			const bool in_column = (board.anchor_columns[x * board.anchor_column_words + y / 64] & (1ULL << (y % 64))) != 0;
+			if (in_row != is_anchor || in_column != is_anchor)
+			{
+				return false;
+			}
+			num_anchors += is_anchor ? 1 : 0;
+		}
+	}
+
+	// Each line's summary bit must be set exactly when the line has anchors
+	for (int32 y = 0; y < board.size_y; y++)
+	{
+		bool row_has_anchors = false;
+		for (int32 word_index = 0; word_index < board.anchor_row_words; word_index++)
+		{
+			row_has_anchors = row_has_anchors || board.anchor_rows[y * board.anchor_row_words + word_index] != 0;
+		}
+		if (((board.anchor_row_summary[y / 64] & (1ULL << (y % 64))) != 0) != row_has_anchors)
+		{
+			return false;
+		}
+	}
+	for (int32 x = 0; x < board.size_x; x++)
+	{
+		bool column_has_anchors = false;
+		for (int32 word_index = 0; word_index < board.anchor_column_words; word_index++)
+		{
+			column_has_anchors = column_has_anchors || board.anchor_columns[x * board.anchor_column_words + word_index] != 0;
+		}
+		if (((board.anchor_column_summary[x / 64] & (1ULL << (x % 64))) != 0) != column_has_anchors)
+		{
+			return false;
+		}
+	}
+	return num_anchors == board.num_anchors;
+}
+
+const char* test_board_anchor_index()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, "aa\nat\ncater\ncats\ntt\n") == 5);
+
+	// A new board has no anchors; rows wider than 64 squares take more than one word of bits
+	rl_board board;
+	rl_board_init(board, 70, 20);
+	t_assert(board.anchor_row_words == 2 && board.anchor_column_words == 1);
+	t_assert(board.num_anchors == 0);
+	t_assert(_test_board_anchor_index_matches(board));
+
+	// A word straddling the boundary between two words of a row's bitmap makes anchors of the squares above, below,
+	// before and after it
+	rl_board_write(dawg, board, rl_board_index(board, 62, 3), true, reinterpret_cast<const uint8*>("cater"), 5);
+	t_assert(board.num_anchors == 12);
+	t_assert(_test_board_anchor_index_matches(board));
+	t_assert((board.anchor_rows[3 * board.anchor_row_words + 1] & (1ULL << (67 - 64))) != 0);
+	t_assert(board.anchor_row_summary[0] == ((1ULL << 2) | (1ULL << 3) | (1ULL << 4)));
+
+	// Playing a letter onto an anchor takes it out of the index, and a line drops out of the summary once it has none
+	rl_board_write(dawg, board, rl_board_index(board, 62, 3), false, reinterpret_cast<const uint8*>("cats"), 4);
+	t_assert(board.letters[rl_board_index(board, 62, 4)] == 'a');
+	t_assert(_test_board_anchor_index_matches(board));
+	t_assert((board.anchor_column_summary[0] & (1ULL << 62)) != 0);
+	rl_board_free(board);
+
+	rl_board_init(board, 3, 3);
+	rl_board_write(dawg, board, rl_board_index(board, 1, 1), true, reinterpret_cast<const uint8*>("a"), 1);
+	t_assert(board.num_anchors == 4 && board.anchor_row_summary[0] == 7);
+	rl_board_write(dawg, board, rl_board_index(board, 0, 1), true, reinterpret_cast<const uint8*>("aat"), 3);
+	t_assert(board.num_anchors == 6 && board.anchor_row_summary[0] == ((1ULL << 0) | (1ULL << 2)));
+	t_assert(board.anchor_column_summary[0] == 7);
+	t_assert(_test_board_anchor_index_matches(board));
+
+	rl_board_free(board);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
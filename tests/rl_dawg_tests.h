@@ -1,5 +1,12 @@
 #pragma once
 
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
 #include <cstdio>
 #include <cstring>
 
@@ -28,7 +35,8 @@ const char* test_dawg_ctx_init()
 	t_assert(!ctx.nodearray.items[0].next_by_letter.items);
 
 	t_assert(ctx.minimized_lookup.capacity > 0);
-	t_assert(ctx.minimized_lookup.buckets);
+	t_assert(ctx.minimized_lookup.size == 0);
+	t_assert(ctx.minimized_lookup.items);
 
 	t_assert(ctx.edge_stack_size == 0);
 	t_assert(ctx.prev_word_len == 0);
@@ -42,6 +50,53 @@ const char* test_dawg_ctx_init()
 	return nullptr;
 }
 
+const char* test_dawg_ctx_init_arena()
+{
+	// An arena-backed context should be pre-sized according to the size of its input
+	rl_dawg_ctx ctx;
+	rl_dawg_ctx_init_arena(ctx, 16 * 100000);
+	t_assert(ctx.nodearray.capacity >= 100000);
+	t_assert(ctx.nodearray.size == 1);
+	t_assert(ctx.nodearray.edgepool);
+
+	// It should build exactly the same DAWG as a context that allocates each edgemap
+	// separately
+	rl_dawg_ctx plain;
+	rl_dawg_ctx_init(plain);
+	t_assert(!plain.nodearray.edgepool);
+
+	const char* words[] = { "cat", "cats", "facet", "facets", "fact", "facts" };
+	for (size_t i = 0; i < COUNT_OF(words); i++)
+	{
+		const int32 word_len = static_cast<int32>(strlen(words[i]));
+		t_assert(rl_dawg_ctx_add(ctx, t_word(words[i]), word_len));
+		t_assert(rl_dawg_ctx_add(plain, t_word(words[i]), word_len));
+	}
+	rl_dawg_ctx_finalize(ctx);
+	rl_dawg_ctx_finalize(plain);
+	t_assert(ctx.nodearray.size == 8);
+	t_assert(plain.nodearray.size == 8);
+	for (int32 node_index = 0; node_index < ctx.nodearray.size; node_index++)
+	{
+		t_assert(rl_node_equals(ctx.nodearray.items[node_index], plain.nodearray.items[node_index]));
+	}
+
+	// The edgepool should follow the nodearray when it's moved into a DAWG
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	rl_dawg_ctx_move_nodes(ctx, dawg);
+	t_assert(!ctx.nodearray.edgepool);
+	t_assert(dawg.nodearray.edgepool);
+	rl_dawg_freeze(dawg);
+	t_assert(!dawg.nodearray.edgepool);
+	t_assert(dawg.num_nodes == 8);
+
+	rl_dawg_free(dawg);
+	rl_dawg_ctx_free(plain);
+	rl_dawg_ctx_free(ctx);
+	return nullptr;
+}
+
 const char* test_dawg_ctx_add()
 {
 	// Initialize a dawg content, used internally by rl_dawg_build (must be freed)
@@ -278,6 +333,109 @@ const char* test_dawg_ctx_move_nodes()
 	return nullptr;
 }
 
+const char* test_dawg_freeze()
+{
+	// Build and minimize a small DAWG, then move its nodes into an rl_dawg
+	rl_dawg_ctx ctx;
+	rl_dawg_ctx_init(ctx);
+	bool ok;
+	ok = rl_dawg_ctx_add(ctx, t_word("cat"), 3); t_assert(ok);
+	ok = rl_dawg_ctx_add(ctx, t_word("cats"), 4); t_assert(ok);
+	ok = rl_dawg_ctx_add(ctx, t_word("facet"), 5); t_assert(ok);
+	ok = rl_dawg_ctx_add(ctx, t_word("facets"), 6); t_assert(ok);
+	ok = rl_dawg_ctx_add(ctx, t_word("fact"), 4); t_assert(ok);
+	ok = rl_dawg_ctx_add(ctx, t_word("facts"), 5); t_assert(ok);
+	rl_dawg_ctx_finalize(ctx);
+
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	rl_dawg_ctx_move_nodes(ctx, dawg);
+	rl_dawg_ctx_free(ctx);
+	t_assert(dawg.nodearray.size == 8);
+	t_assert(!dawg.data);
+
+	// Freezing the DAWG should pack all 8 nodes and their 9 edges into a single
+	// buffer, releasing the nodearray:
+	// [0] -c-> [1] -a-> [2] -t-> [3] -s-> [4]
+	//  |                  \e    /t
+	//  |                   \   /
+	//  f-> [5] -a-> [6] -c-> [7]
+	rl_dawg_freeze(dawg);
+	t_assert(dawg.data);
+	t_assert(!dawg.nodearray.items);
+	t_assert(dawg.nodearray.size == 0);
+	t_assert(dawg.num_nodes == 8);
+	t_assert(dawg.num_edges == 9);
+	t_assert(dawg.node_edges[0] == 0);
+	t_assert(dawg.node_edges[dawg.num_nodes] == 9);
+
+	// Edges leading out of the root should be sorted by letter, and each packed edge
+	// should carry the letter, the destination node index, and a terminal flag
+	const rl_edge* root_begin = rl_dawg_edges_begin(dawg, 0);
+	const rl_edge* root_end = rl_dawg_edges_end(dawg, 0);
+	t_assert(root_end - root_begin == 2);
+	t_assert(rl_edge_letter(root_begin[0]) == 'c');
+	t_assert(rl_edge_node_index(root_begin[0]) == 1);
+	t_assert(!rl_edge_is_word(root_begin[0]));
+	t_assert(rl_edge_letter(root_begin[1]) == 'f');
+	t_assert(rl_edge_node_index(root_begin[1]) == 5);
+
+	// 'cat', 'facet', and 'fact' should all converge on the same terminal node
+	const rl_edge cat = rl_dawg_find_edge(dawg, 2, 't');
+	t_assert(rl_edge_is_word(cat));
+	t_assert(rl_edge_node_index(cat) == 3);
+	const rl_edge fact = rl_dawg_find_edge(dawg, 7, 't');
+	t_assert(rl_edge_is_word(fact));
+	t_assert(rl_edge_node_index(fact) == 3);
+	const rl_edge cats = rl_dawg_find_edge(dawg, 3, 's');
+	t_assert(rl_edge_is_word(cats));
+	t_assert(rl_edge_node_index(cats) == 4);
+
+	// Lookups for letters that have no edge should fail, whether the missing letter
+	// sorts before, between, or after the existing edges
+	t_assert(rl_dawg_find_edge(dawg, 0, 'a') == RL_EDGE_NONE);
+	t_assert(rl_dawg_find_edge(dawg, 0, 'd') == RL_EDGE_NONE);
+	t_assert(rl_dawg_find_edge(dawg, 0, 'z') == RL_EDGE_NONE);
+	t_assert(rl_dawg_find_edge(dawg, 4, 'a') == RL_EDGE_NONE);
+
+	// Each node's mask should have one bit set per outgoing edge, and the rank of a
+	// letter's bit within that mask should give the position of its edge
+	t_assert(rl_dawg_node_mask(dawg, 0) == ((1u << ('c' - 'a')) | (1u << ('f' - 'a'))));
+	t_assert(rl_dawg_node_mask(dawg, 7) == ((1u << ('e' - 'a')) | (1u << ('t' - 'a'))));
+	t_assert(rl_dawg_node_mask(dawg, 4) == 0);
+	for (int32 node_index = 0; node_index < dawg.num_nodes; node_index++)
+	{
+		const uint32 mask = rl_dawg_node_mask(dawg, node_index);
+		t_assert(rl_popcount(mask) == rl_dawg_edges_end(dawg, node_index) - rl_dawg_edges_begin(dawg, node_index));
+		for (const rl_edge* edge = rl_dawg_edges_begin(dawg, node_index); edge != rl_dawg_edges_end(dawg, node_index); edge++)
+		{
+			const uint32 ordinal = *edge & RL_EDGE_LETTER_MASK;
+			t_assert(rl_dawg_node_edge(dawg, node_index, mask, ordinal) == *edge);
+			t_assert(rl_dawg_find_edge(dawg, node_index, rl_edge_letter(*edge)) == *edge);
+		}
+	}
+
+	// Each node should also be summarized by the words that can be completed from it:
+	// from the root, 'cat' is shortest and 'facets' longest; from 'fac', we can add
+	// 't' or 'ets'; from 'cat', just 's'; and from 'cats', nothing
+	const uint32 all_letters = (1u << ('a' - 'a')) | (1u << ('c' - 'a')) | (1u << ('e' - 'a')) | (1u << ('f' - 'a')) | (1u << ('s' - 'a')) | (1u << ('t' - 'a'));
+	t_assert(dawg.node_summaries[0].letters == all_letters);
+	t_assert(dawg.node_summaries[0].min_len == 3);
+	t_assert(dawg.node_summaries[0].max_len == 6);
+	t_assert(dawg.node_summaries[7].letters == ((1u << ('e' - 'a')) | (1u << ('s' - 'a')) | (1u << ('t' - 'a'))));
+	t_assert(dawg.node_summaries[7].min_len == 1);
+	t_assert(dawg.node_summaries[7].max_len == 3);
+	t_assert(dawg.node_summaries[3].letters == (1u << ('s' - 'a')));
+	t_assert(dawg.node_summaries[3].min_len == 1);
+	t_assert(dawg.node_summaries[3].max_len == 1);
+	t_assert(dawg.node_summaries[4].letters == 0);
+	t_assert(dawg.node_summaries[4].min_len == 0);
+	t_assert(dawg.node_summaries[4].max_len == 0);
+
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
 const char* test_dawg_build()
 {
 	rl_dawg dawg;
@@ -288,21 +446,23 @@ const char* test_dawg_build()
 	const char* words = "cat\ncats\nfacet\nfacets\nfact\nfacts\n";
 	const int32 num_words = rl_test_dawg_build(dawg, words);
 	t_assert(num_words == 6);
-	t_assert(dawg.nodearray.size == 8);
+
+	// rl_dawg_build should leave us with a frozen DAWG, with no nodearray remaining
+	t_assert(dawg.num_nodes == 8);
+	t_assert(!dawg.nodearray.items);
 
 	// Traverse the resulting DAWG
-	const rl_node& root = dawg.nodearray.items[0];
-	const rl_node& f = dawg.nodearray.items[rl_edgemap_find(root.next_by_letter, 'f')];
-	const rl_node& fa = dawg.nodearray.items[rl_edgemap_find(f.next_by_letter, 'a')];
-	const rl_node& fac = dawg.nodearray.items[rl_edgemap_find(fa.next_by_letter, 'c')];
-	const rl_node& fact = dawg.nodearray.items[rl_edgemap_find(fac.next_by_letter, 't')];
-	const rl_node& facts = dawg.nodearray.items[rl_edgemap_find(fact.next_by_letter, 's')];
-	t_assert(!f.is_word);
-	t_assert(!fa.is_word);
-	t_assert(!fac.is_word);
-	t_assert(fact.is_word);
-	t_assert(facts.is_word);
-	t_assert(facts.next_by_letter.size == 0);
+	const rl_edge f = rl_dawg_find_edge(dawg, 0, 'f');
+	const rl_edge fa = rl_dawg_find_edge(dawg, rl_edge_node_index(f), 'a');
+	const rl_edge fac = rl_dawg_find_edge(dawg, rl_edge_node_index(fa), 'c');
+	const rl_edge fact = rl_dawg_find_edge(dawg, rl_edge_node_index(fac), 't');
+	const rl_edge facts = rl_dawg_find_edge(dawg, rl_edge_node_index(fact), 's');
+	t_assert(f != RL_EDGE_NONE && !rl_edge_is_word(f));
+	t_assert(fa != RL_EDGE_NONE && !rl_edge_is_word(fa));
+	t_assert(fac != RL_EDGE_NONE && !rl_edge_is_word(fac));
+	t_assert(fact != RL_EDGE_NONE && rl_edge_is_word(fact));
+	t_assert(facts != RL_EDGE_NONE && rl_edge_is_word(facts));
+	t_assert(rl_dawg_edges_begin(dawg, rl_edge_node_index(facts)) == rl_dawg_edges_end(dawg, rl_edge_node_index(facts)));
 
 	// Verify the expected weights for each letter in the distribution
 	// (aaaaaacccccceeffffssstttttt)
@@ -326,3 +486,508 @@ const char* test_dawg_build()
 	rl_dawg_free(dawg);
 	return nullptr;
 }
+
+const char* test_dawg_build_fd()
+{
+	// Feed a word list through a pipe, so that the reader can't know its size in advance
+	// or seek within it, just as when reading from stdin
+	int fds[2];
+#ifdef _WIN32
+	t_assert(_pipe(fds, 4096, _O_BINARY) == 0);
+#else
+	t_assert(pipe(fds) == 0);
+#endif
+	const char* words = "cat cats\nfacet\tfacets\r\nfact\nFACT\nfacts";
+	const int32 words_len = static_cast<int32>(strlen(words));
+	t_assert(write(fds[1], words, words_len) == words_len);
+	close(fds[1]);
+
+	// The resulting DAWG should match the one built from the same words in a file,
+	// skipping the invalid word
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_dawg_build_fd(dawg, fds[0]) == 6);
+	close(fds[0]);
+	t_assert(dawg.num_words == 6);
+	t_assert(dawg.num_nodes == 8);
+
+	rl_dawg expected;
+	rl_dawg_init(expected);
+	t_assert(rl_test_dawg_build(expected, "cat\ncats\nfacet\nfacets\nfact\nfacts\n") == 6);
+	t_assert(rl_test_dawg_equivalent(dawg, 0, expected, 0));
+	t_assert(memcmp(dawg.distribution.weights, expected.distribution.weights, sizeof(dawg.distribution.weights)) == 0);
+
+	rl_dawg_free(expected);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_dawg_save_load()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	const char* words = "cat\ncats\nfacet\nfacets\nfact\nfacts\n";
+	t_assert(rl_test_dawg_build(dawg, words) == 6);
+	t_assert(dawg.num_words == 6);
+
+	// Write a binary image of the DAWG to a temp file
+	char path[512];
+	t_assert(rl_test_temp_path(path, sizeof(path)));
+	t_assert(rl_dawg_save(dawg, path));
+
+	// Loading that image should give us an identical DAWG, reading its nodes and edges
+	// directly from the mapped file rather than from a heap allocation
+	rl_dawg loaded;
+	rl_dawg_init(loaded);
+	t_assert(rl_dawg_load_mapped(loaded, path) == 6);
+	t_assert(loaded.mapping);
+	t_assert(loaded.mapping_size > 0);
+	t_assert(!loaded.nodearray.items);
+	t_assert(loaded.num_words == 6);
+	t_assert(loaded.num_nodes == dawg.num_nodes);
+	t_assert(loaded.num_edges == dawg.num_edges);
+	t_assert(memcmp(loaded.node_edges, dawg.node_edges, (dawg.num_nodes + 1) * sizeof(uint32)) == 0);
+	t_assert(memcmp(loaded.edges, dawg.edges, dawg.num_edges * sizeof(rl_edge)) == 0);
+	t_assert(memcmp(loaded.node_summaries, dawg.node_summaries, dawg.num_nodes * sizeof(rl_node_summary)) == 0);
+	t_assert(memcmp(loaded.edge_ranks, dawg.edge_ranks, dawg.num_edges * sizeof(uint32)) == 0);
+	t_assert(memcmp(&loaded.distribution, &dawg.distribution, sizeof(rl_distribution)) == 0);
+
+	// The loaded DAWG should be immediately usable for lookups
+	const rl_edge f = rl_dawg_find_edge(loaded, 0, 'f');
+	const rl_edge fa = rl_dawg_find_edge(loaded, rl_edge_node_index(f), 'a');
+	const rl_edge fac = rl_dawg_find_edge(loaded, rl_edge_node_index(fa), 'c');
+	const rl_edge fact = rl_dawg_find_edge(loaded, rl_edge_node_index(fac), 't');
+	t_assert(rl_edge_is_word(fact));
+	rl_dawg_free(loaded);
+
+	// Flip a single bit in the last edge of the image: the checksum should no longer
+	// match, and the load should be rejected
+	FILE* fp = fopen(path, "r+b");
+	t_assert(fp);
+	t_assert(fseek(fp, -1, SEEK_END) == 0);
+	const int last_byte = fgetc(fp);
+	t_assert(last_byte != EOF);
+	t_assert(fseek(fp, -1, SEEK_END) == 0);
+	fputc(last_byte ^ 0x01, fp);
+	fclose(fp);
+
+	rl_dawg corrupt;
+	rl_dawg_init(corrupt);
+	t_assert(rl_dawg_load_mapped(corrupt, path) == 0);
+	t_assert(!corrupt.data);
+	t_assert(!corrupt.mapping);
+	rl_dawg_free(corrupt);
+
+	// Nonexistent files should fail gracefully
+	remove(path);
+	rl_dawg missing;
+	rl_dawg_init(missing);
+	t_assert(rl_dawg_load_mapped(missing, path) == 0);
+	rl_dawg_free(missing);
+
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_dawg_build_parallel()
+{
+	// Words spread across several first letters, with suffixes ('-s', '-ing', '-er') shared between words that
+	// will end up in different shards
+	const char* words =
+		"bake\nbaker\nbakes\nbaking\nbat\nbats\ncat\ncats\nfacet\nfacets\nfact\nfacts\n"
+		"make\nmaker\nmakes\nmaking\nmat\nmats\nrake\nraker\nrakes\nraking\nrat\nrats\n"
+		"take\ntaker\ntakes\ntaking\nzebra\nzebras\n";
+
+	rl_dawg serial;
+	rl_dawg_init(serial);
+	const int32 num_serial_words = rl_test_dawg_build(serial, words);
+	t_assert(num_serial_words == 30);
+
+	// However many threads we split the work across, the merged DAWG should be identical to the one built serially
+	const int32 thread_counts[] = { 1, 2, 3, 8, 26, 64 };
+	for (size_t i = 0; i < COUNT_OF(thread_counts); i++)
+	{
+		rl_dawg parallel;
+		rl_dawg_init(parallel);
+		const int32 num_parallel_words = rl_test_dawg_build_with(parallel, words, rl_test_build_parallel, thread_counts[i]);
+		t_assert(num_parallel_words == num_serial_words);
+		t_assert(parallel.num_words == num_serial_words);
+		t_assert(parallel.num_nodes == serial.num_nodes);
+		t_assert(parallel.num_edges == serial.num_edges);
+		t_assert(rl_test_dawg_equivalent(parallel, 0, serial, 0));
+		t_assert(memcmp(&parallel.distribution, &serial.distribution, sizeof(rl_distribution)) == 0);
+		rl_dawg_free(parallel);
+	}
+	rl_dawg_free(serial);
+
+	// Words that are out of order are rejected just as they are by a serial build, even when they'd be the first
+	// word in their shard ("act" and "cab" both follow "cat"), while a word too long to accept doesn't hold back the
+	// words after it ("dog" follows a rejected word starting with 'z')
+	const char* unsorted_words = "bat\ncat\nact\ncab\nzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz\ndog\nzoo\n";
+	rl_dawg_init(serial);
+	t_assert(rl_test_dawg_build(serial, unsorted_words) == 4);
+	for (size_t i = 0; i < COUNT_OF(thread_counts); i++)
+	{
+		rl_dawg parallel;
+		rl_dawg_init(parallel);
+		t_assert(rl_test_dawg_build_with(parallel, unsorted_words, rl_test_build_parallel, thread_counts[i]) == 4);
+		t_assert(parallel.num_nodes == serial.num_nodes);
+		t_assert(rl_test_dawg_equivalent(parallel, 0, serial, 0));
+		t_assert(memcmp(&parallel.distribution, &serial.distribution, sizeof(rl_distribution)) == 0);
+		rl_dawg_free(parallel);
+	}
+
+	rl_dawg_free(serial);
+	return nullptr;
+}
+
+const char* test_dawg_build_unsorted()
+{
+	const char* sorted_words =
+		"bake\nbaker\nbakes\nbaking\nbat\nbats\ncat\ncats\nfacet\nfacets\nfact\nfacts\n"
+		"make\nmaker\nmakes\nmaking\nmat\nmats\nrake\nraker\nrakes\nraking\nrat\nrats\n"
+		"take\ntaker\ntakes\ntaking\nzebra\nzebras\n";
+
+	// The same words in scrambled order, with several repeated, plus a few invalid words
+	const char* unsorted_words =
+		"zebras\nrat\nbaking\nfacts\nmake\ncat\ntaker\nbats\nrakes\nfacet\nmats\nzebra\n"
+		"Cat\nbaker\ntake\nmaking\nfact\nraker\nbat\ncats\ntakes\nmaker\nrats\nbake\n"
+		"cat\nfacets\nrake\nmat\ntaking\nbakes\nmakes\nraking\nzebras\nzebras\nx-ray\nrat\n";
+
+	rl_dawg sorted;
+	rl_dawg_init(sorted);
+	t_assert(rl_test_dawg_build(sorted, sorted_words) == 30);
+
+	// Whether the words are sorted entirely in memory, or the memory budget is so small
+	// that they're sorted in many runs on disk and then merged, we should end up with
+	// the same DAWG as if the input had been sorted, with each duplicate counted once
+	const size_t memory_budgets[] = { 0, 1024, 64, 1 };
+	for (size_t i = 0; i < COUNT_OF(memory_budgets); i++)
+	{
+		rl_dawg unsorted;
+		rl_dawg_init(unsorted);
+		t_assert(rl_test_dawg_build_with(unsorted, unsorted_words, rl_dawg_build_unsorted, memory_budgets[i]) == 30);
+		t_assert(unsorted.num_words == 30);
+		t_assert(unsorted.num_nodes == sorted.num_nodes);
+		t_assert(unsorted.num_edges == sorted.num_edges);
+		t_assert(rl_test_dawg_equivalent(unsorted, 0, sorted, 0));
+		t_assert(memcmp(&unsorted.distribution, &sorted.distribution, sizeof(rl_distribution)) == 0);
+		rl_dawg_free(unsorted);
+	}
+
+	rl_dawg_free(sorted);
+	return nullptr;
+}
+
+const char* test_dawg_build_gaddag()
+{
+	// A GADDAG can be built from words in any order, with duplicates counted once
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, "cats\ncat\nact\nCat\ncat\n", rl_test_build_gaddag) == 3);
+	t_assert(gaddag.is_gaddag);
+	t_assert(gaddag.num_words == 3);
+
+	// Each word is split at every position, giving the letters before the split in
+	// reverse order, then the separator ('{') followed by the rest of the word
+	const char* entries[] = {
+		"a{ct", "ca{t", "tca",
+		"c{at", "ac{t", "tac",
+		"c{ats", "ac{ts", "tac{s", "stac",
+	};
+	for (size_t i = 0; i < COUNT_OF(entries); i++)
+	{
+		t_assert(rl_test_dawg_contains(gaddag, entries[i]));
+	}
+	t_assert(!rl_test_dawg_contains(gaddag, "cat"));
+	t_assert(!rl_test_dawg_contains(gaddag, "ta"));
+	t_assert(!rl_test_dawg_contains(gaddag, "c{a"));
+	t_assert(!rl_test_dawg_contains(gaddag, "ca{"));
+
+	// The letter distribution comes from the words themselves, not from the entries
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, "act\ncat\ncats\n") == 3);
+	t_assert(!dawg.is_gaddag);
+	t_assert(memcmp(&gaddag.distribution, &dawg.distribution, sizeof(rl_distribution)) == 0);
+
+	// Saving and loading a GADDAG should preserve its type
+	char path[512];
+	t_assert(rl_test_temp_path(path, sizeof(path)));
+	t_assert(rl_dawg_save(gaddag, path));
+	rl_dawg loaded;
+	rl_dawg_init(loaded);
+	t_assert(rl_dawg_load_mapped(loaded, path) == 3);
+	t_assert(loaded.is_gaddag);
+	t_assert(rl_test_dawg_equivalent(loaded, 0, gaddag, 0));
+	rl_dawg_free(loaded);
+	remove(path);
+
+	rl_dawg_free(dawg);
+	rl_dawg_free(gaddag);
+	return nullptr;
+}
+
+const char* test_dawg_word_ids()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, "cat\ncats\nfacet\nfacets\nfact\nfacts\n") == 6);
+
+	// Each word's ID should be its index in alphabetical order, and should map back to
+	// the same word
+	const char* words[] = { "cat", "cats", "facet", "facets", "fact", "facts" };
+	for (int32 i = 0; i < COUNT_OF(words); i++)
+	{
+		const int32 word_len = static_cast<int32>(strlen(words[i]));
+		t_assert(rl_dawg_word_id(dawg, t_word(words[i]), word_len) == i);
+
+		uint8 word[RL_MAX_WORD_LEN];
+		t_assert(rl_dawg_word_at(dawg, i, word) == word_len);
+		t_assert(memcmp(word, words[i], word_len) == 0);
+	}
+
+	// Prefixes, extensions and other strings that aren't words have no ID
+	t_assert(rl_dawg_word_id(dawg, t_word("ca"), 2) == -1);
+	t_assert(rl_dawg_word_id(dawg, t_word("catss"), 5) == -1);
+	t_assert(rl_dawg_word_id(dawg, t_word("dog"), 3) == -1);
+	t_assert(rl_dawg_word_id(dawg, t_word("Cat"), 3) == -1);
+	t_assert(rl_dawg_word_id(dawg, t_word(""), 0) == -1);
+
+	// Random values should be spread evenly across the full range of IDs
+	uint8 word[RL_MAX_WORD_LEN];
+	t_assert(rl_dawg_random_word(dawg, 0, word) == 3 && memcmp(word, "cat", 3) == 0);
+	t_assert(rl_dawg_random_word(dawg, 0x80000000u, word) == 6 && memcmp(word, "facets", 6) == 0);
+	t_assert(rl_dawg_random_word(dawg, 0xffffffffu, word) == 5 && memcmp(word, "facts", 5) == 0);
+	rl_dawg_free(dawg);
+
+	// In a larger DAWG, where paths overlap far more, every word from 'a' to 'cccc' over
+	// a 3-letter alphabet whose letters sum to an even number should still be numbered
+	// in order
+	static char contents[120 * 6 + 1];
+	size_t contents_len = 0;
+	int32 num_words = 0;
+	char prefix[5] = { 'a', 0, 0, 0, 0 };
+	int32 prefix_len = 1;
+	while (prefix_len > 0)
+	{
+		int32 letter_sum = 0;
+		for (int32 i = 0; i < prefix_len; i++)
+		{
+			letter_sum += prefix[i] - 'a';
+		}
+		if (letter_sum % 2 == 0)
+		{
+			memcpy(contents + contents_len, prefix, prefix_len);
+			contents[contents_len + prefix_len] = '\n';
+			contents_len += prefix_len + 1;
+			num_words++;
+		}
+
+		// Advance to the next string in lexicographical order
+		if (prefix_len < 4)
+		{
+			prefix[prefix_len++] = 'a';
+			continue;
+		}
+		while (prefix_len > 0 && prefix[prefix_len - 1] == 'c')
+		{
+			prefix[--prefix_len] = '\0';
+		}
+		if (prefix_len > 0)
+		{
+			prefix[prefix_len - 1]++;
+		}
+	}
+	contents[contents_len] = '\0';
+
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, contents) == num_words);
+	const char* expected = contents;
+	for (int32 word_id = 0; word_id < num_words; word_id++)
+	{
+		const int32 expected_len = static_cast<int32>(strchr(expected, '\n') - expected);
+		const int32 word_len = rl_dawg_word_at(dawg, word_id, word);
+		t_assert(word_len == expected_len);
+		t_assert(memcmp(word, expected, word_len) == 0);
+		t_assert(rl_dawg_word_id(dawg, word, word_len) == word_id);
+		expected += expected_len + 1;
+	}
+
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_dawg_reorder()
+{
+	const char* contents = "cat\ncats\nfacet\nfacets\nfact\nfacts\n";
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, contents) == 6);
+	rl_dawg expected;
+	rl_dawg_init(expected);
+	t_assert(rl_test_dawg_build(expected, contents) == 6);
+
+	// Breadth-first order puts the root's children, in order by letter, immediately after the root
+	rl_dawg_reorder(dawg, nullptr);
+	t_assert(dawg.num_nodes == expected.num_nodes);
+	t_assert(dawg.num_edges == expected.num_edges);
+	t_assert(rl_dawg_edges_end(dawg, 0) - rl_dawg_edges_begin(dawg, 0) == 2);
+	t_assert(rl_edge_letter(dawg.edges[0]) == 'c' && rl_edge_node_index(dawg.edges[0]) == 1);
+	t_assert(rl_edge_letter(dawg.edges[1]) == 'f' && rl_edge_node_index(dawg.edges[1]) == 2);
+	t_assert(rl_test_dawg_equivalent(dawg, 0, expected, 0));
+
+	// Given weights, the heaviest node comes first after the root, which never moves: here
+	// that's the node for 'fac', the only one with both 'e' and 't' edges
+	uint32 weights[64] = { 0 };
+	t_assert(dawg.num_nodes <= COUNT_OF(weights));
+	int32 heaviest_index = 0;
+	for (const char* c = "fac"; *c; c++)
+	{
+		heaviest_index = rl_edge_node_index(rl_dawg_find_edge(dawg, heaviest_index, *c));
+	}
+	t_assert(heaviest_index > 2);
+	weights[heaviest_index] = 100;
+	weights[0] = 1;
+	rl_dawg_reorder(dawg, weights);
+	t_assert(rl_dawg_node_mask(dawg, 1) == ((1u << ('e' - 'a')) | (1u << ('t' - 'a'))));
+	t_assert(rl_edge_letter(dawg.edges[0]) == 'c' && rl_edge_letter(dawg.edges[1]) == 'f');
+	t_assert(rl_test_dawg_equivalent(dawg, 0, expected, 0));
+
+	// Node summaries move along with their nodes, and every word keeps its ID
+	t_assert(memcmp(&dawg.node_summaries[0], &expected.node_summaries[0], sizeof(rl_node_summary)) == 0);
+	const char* words[] = { "cat", "cats", "facet", "facets", "fact", "facts" };
+	for (int32 i = 0; i < COUNT_OF(words); i++)
+	{
+		const int32 word_len = static_cast<int32>(strlen(words[i]));
+		t_assert(rl_dawg_word_id(dawg, t_word(words[i]), word_len) == i);
+
+		uint8 word[RL_MAX_WORD_LEN];
+		t_assert(rl_dawg_word_at(dawg, i, word) == word_len);
+		t_assert(memcmp(word, words[i], word_len) == 0);
+	}
+
+	rl_dawg_free(expected);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_dawg_pack()
+{
+	const char* contents = "cat\ncats\nfacet\nfacets\nfact\nfacts\n";
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, contents) == 6);
+
+	// A packed copy holds the same words in a fraction of the space, and is traversed
+	// through the same functions
+	rl_dawg packed;
+	rl_dawg_init(packed);
+	rl_dawg_pack(dawg, packed);
+	t_assert(packed.packed);
+	t_assert(packed.num_words == 6);
+	t_assert(rl_dawg_num_bytes(packed) * 2 < rl_dawg_num_bytes(dawg));
+	t_assert(rl_test_dawg_equivalent(packed, 0, dawg, 0));
+	t_assert(rl_test_dawg_contains(packed, "facets"));
+	t_assert(rl_test_dawg_contains(packed, "cat"));
+	t_assert(!rl_test_dawg_contains(packed, "fac"));
+	t_assert(!rl_test_dawg_contains(packed, "dog"));
+	t_assert(rl_dawg_find_edge(packed, 0, RL_GADDAG_SEPARATOR + 1) == RL_EDGE_NONE);
+	t_assert(memcmp(&packed.distribution, &dawg.distribution, sizeof(rl_distribution)) == 0);
+	rl_dawg_free(packed);
+	rl_dawg_free(dawg);
+
+	// In a larger DAWG, with few shared suffixes, some edges must span more than one byte
+	static char words[400 * 8 + 1];
+	uint32 state = 42;
+	for (int32 i = 0; i < 400; i++)
+	{
+		for (int32 j = 0; j < 7; j++)
+		{
+			state = state * 1103515245 + 12345;
+			words[i * 8 + j] = static_cast<char>('a' + (state >> 16) % 26);
+		}
+		words[i * 8 + 7] = '\n';
+	}
+	words[400 * 8] = '\0';
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build_with(dawg, words, rl_dawg_build_unsorted, 0) > 0);
+	rl_dawg_init(packed);
+	rl_dawg_pack(dawg, packed);
+	t_assert(packed.packed_size > 1024);
+	t_assert(rl_test_dawg_equivalent(packed, 0, dawg, 0));
+	for (int32 i = 0; i < 400; i++)
+	{
+		char word[8];
+		memcpy(word, words + i * 8, 7);
+		word[7] = '\0';
+		t_assert(rl_test_dawg_contains(packed, word));
+	}
+	rl_dawg_free(packed);
+	rl_dawg_free(dawg);
+
+	// The same goes for a GADDAG, separator edges and all
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, contents, rl_test_build_gaddag) == 6);
+	rl_dawg_init(packed);
+	rl_dawg_pack(gaddag, packed);
+	t_assert(packed.is_gaddag);
+	t_assert(rl_test_dawg_equivalent(packed, 0, gaddag, 0));
+	t_assert(rl_test_dawg_contains(packed, "tcaf{s"));
+	rl_dawg_free(packed);
+	rl_dawg_free(gaddag);
+	return nullptr;
+}
+
+const char* test_dawg_contains_batch()
+{
+	const char* contents = "cat\ncats\nfacet\nfacets\nfact\nfacts\n";
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, contents) == 6);
+	rl_dawg packed;
+	rl_dawg_init(packed);
+	rl_dawg_pack(dawg, packed);
+
+	// Words, prefixes, extensions, misspellings and empty words, in more queries than
+	// there are lanes to look them up in, and not a multiple of 8
+	const char* queries[] = {
+		"cat", "ca", "", "facets", "dog", "facts", "fac", "catsup", "cats", "fact", "facet", "c", "Cat", "fats",
+		"facetss", "", "cat", "xyz", "acts", "facets", "cat{", "f", "facts", "ca"
+	};
+	const int32 num_queries = static_cast<int32>(sizeof(queries) / sizeof(queries[0]));
+	const uint8* words[sizeof(queries) / sizeof(queries[0])];
+	int32 lens[sizeof(queries) / sizeof(queries[0])];
+	for (int32 i = 0; i < num_queries; i++)
+	{
+		words[i] = reinterpret_cast<const uint8*>(queries[i]);
+		lens[i] = static_cast<int32>(strlen(queries[i]));
+	}
+
+	// The batch agrees with looking up each word on its own, for any number of queries,
+	// and leaves no stray bits set past the last one
+	const rl_dawg* dawgs[] = { &dawg, &packed };
+	for (int32 dawg_index = 0; dawg_index < 2; dawg_index++)
+	{
+		const rl_dawg& d = *dawgs[dawg_index];
+		t_assert(rl_dawg_contains(d, words[0], lens[0]));
+		t_assert(!rl_dawg_contains(d, words[1], lens[1]));
+		t_assert(!rl_dawg_contains(d, words[2], lens[2]));
+		for (int32 n = 0; n <= num_queries; n++)
+		{
+			uint8 out_bits[4];
+			memset(out_bits, 0xff, sizeof(out_bits));
+			rl_dawg_contains_batch(d, words, lens, n, out_bits);
+			for (int32 i = 0; i < (n + 7) / 8 * 8; i++)
+			{
+				const bool expected = i < n && rl_dawg_contains(d, words[i], lens[i]);
+				t_assert(((out_bits[i >> 3] >> (i & 7)) & 1) == (expected ? 1 : 0));
+			}
+		}
+	}
+
+	rl_dawg_free(packed);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
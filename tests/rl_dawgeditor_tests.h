@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+
+#include "testing.h"
+#include "rl_testing.h"
+#include "rl_dawgeditor.h"
+
+#include "rl_types.h"
+#include "rl_dawg.h"
+
+#define t_word(s) reinterpret_cast<const uint8*>(s)
+
+const char* test_dawgeditor_add()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, "cat\ncats\nfact\nfacts\n") == 4);
+
+	// Thawing the DAWG gives us an editor that knows every word it contains
+	rl_dawgeditor editor;
+	rl_dawgeditor_init(editor, dawg);
+	t_assert(editor.num_words == 4);
+	t_assert(rl_dawgeditor_contains(editor, t_word("facts"), 5));
+	t_assert(!rl_dawgeditor_contains(editor, t_word("fac"), 3));
+
+	// Words can be added in any order; duplicates and invalid words are rejected
+	t_assert(rl_dawgeditor_add(editor, t_word("facets"), 6));
+	t_assert(rl_dawgeditor_add(editor, t_word("facet"), 5));
+	t_assert(!rl_dawgeditor_add(editor, t_word("facet"), 5));
+	t_assert(!rl_dawgeditor_add(editor, t_word("Facet"), 5));
+	t_assert(!rl_dawgeditor_add(editor, t_word(""), 0));
+	t_assert(editor.num_words == 6);
+	t_assert(rl_dawgeditor_contains(editor, t_word("facet"), 5));
+	t_assert(rl_dawgeditor_contains(editor, t_word("cats"), 4));
+
+	// The DAWG isn't modified until we commit: then it should be identical to a DAWG
+	// built from scratch from the full list of words, including its minimal node count
+	t_assert(dawg.num_words == 4);
+	t_assert(rl_dawgeditor_commit(editor, dawg) == 6);
+	t_assert(dawg.num_words == 6);
+
+	rl_dawg expected;
+	rl_dawg_init(expected);
+	t_assert(rl_test_dawg_build(expected, "cat\ncats\nfacet\nfacets\nfact\nfacts\n") == 6);
+	t_assert(dawg.num_nodes == expected.num_nodes);
+	t_assert(dawg.num_edges == expected.num_edges);
+	t_assert(rl_test_dawg_equivalent(dawg, 0, expected, 0));
+	t_assert(memcmp(&dawg.distribution, &expected.distribution, sizeof(rl_distribution)) == 0);
+
+	rl_dawg_free(expected);
+	rl_dawgeditor_free(editor);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_dawgeditor_remove()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, "cat\ncats\nfacet\nfacets\nfact\nfacts\n") == 6);
+
+	// Removing a word that shares its suffix with other words must not remove those
+	// words too: 'cats' and 'facts' share the same final nodes
+	rl_dawgeditor editor;
+	rl_dawgeditor_init(editor, dawg);
+	t_assert(rl_dawgeditor_remove(editor, t_word("cats"), 4));
+	t_assert(!rl_dawgeditor_remove(editor, t_word("cats"), 4));
+	t_assert(!rl_dawgeditor_remove(editor, t_word("fac"), 3));
+	t_assert(!rl_dawgeditor_remove(editor, t_word("dog"), 3));
+	t_assert(rl_dawgeditor_remove(editor, t_word("facet"), 5));
+	t_assert(editor.num_words == 4);
+	t_assert(rl_dawgeditor_contains(editor, t_word("facts"), 5));
+	t_assert(rl_dawgeditor_contains(editor, t_word("facets"), 6));
+	t_assert(!rl_dawgeditor_contains(editor, t_word("cats"), 4));
+
+	t_assert(rl_dawgeditor_commit(editor, dawg) == 4);
+	rl_dawg expected;
+	rl_dawg_init(expected);
+	t_assert(rl_test_dawg_build(expected, "cat\nfacets\nfact\nfacts\n") == 4);
+	t_assert(dawg.num_nodes == expected.num_nodes);
+	t_assert(rl_test_dawg_equivalent(dawg, 0, expected, 0));
+	t_assert(memcmp(&dawg.distribution, &expected.distribution, sizeof(rl_distribution)) == 0);
+	rl_dawg_free(expected);
+
+	// Removing every word should leave just the root
+	t_assert(rl_dawgeditor_remove(editor, t_word("cat"), 3));
+	t_assert(rl_dawgeditor_remove(editor, t_word("facets"), 6));
+	t_assert(rl_dawgeditor_remove(editor, t_word("fact"), 4));
+	t_assert(rl_dawgeditor_remove(editor, t_word("facts"), 5));
+	t_assert(rl_dawgeditor_commit(editor, dawg) == 0);
+	t_assert(dawg.num_nodes == 1);
+	t_assert(dawg.num_edges == 0);
+
+	rl_dawgeditor_free(editor);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+static void _test_dawgeditor_append_words(char* out, size_t& out_len, const bool* present, const char** words, int32 num_words)
+{
+	for (int32 i = 0; i < num_words; i++)
+	{
+		if (present[i])
+		{
+			const size_t len = strlen(words[i]);
+			memcpy(out + out_len, words[i], len);
+			out[out_len + len] = '\n';
+			out_len += len + 1;
+		}
+	}
+	out[out_len] = '\0';
+}
+
+const char* test_dawgeditor_random()
+{
+	// Enumerate every word of up to 4 letters over a 3-letter alphabet, in lexicographical
+	// order (a, aa, aaa, aaaa, aaab, ...)
+	static char storage[120][5];
+	const char* words[120];
+	int32 num_words = 0;
+	char prefix[5] = { 0 };
+	int32 prefix_len = 1;
+	prefix[0] = 'a';
+	while (prefix_len > 0)
+	{
+		memcpy(storage[num_words], prefix, sizeof(prefix));
+		words[num_words] = storage[num_words];
+		num_words++;
+
+		// Advance to the next word in lexicographical order
+		if (prefix_len < 4)
+		{
+			prefix[prefix_len++] = 'a';
+			continue;
+		}
+		while (prefix_len > 0 && prefix[prefix_len - 1] == 'c')
+		{
+			prefix[--prefix_len] = '\0';
+		}
+		if (prefix_len > 0)
+		{
+			prefix[prefix_len - 1]++;
+		}
+	}
+	t_assert(num_words == 120);
+
+	// Start from a DAWG containing every other word, then make pseudo-random edits,
+	// checking after each batch that the result is identical to a DAWG built from scratch
+	bool present[120];
+	static char contents[120 * 6 + 1];
+	size_t contents_len = 0;
+	for (int32 i = 0; i < num_words; i++)
+	{
+		present[i] = i % 2 == 0;
+	}
+	_test_dawgeditor_append_words(contents, contents_len, present, words, num_words);
+
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, contents) == 60);
+	rl_dawgeditor editor;
+	rl_dawgeditor_init(editor, dawg);
+
+	uint32 state = 42;
+	for (int32 batch = 0; batch < 20; batch++)
+	{
+		for (int32 edit = 0; edit < 25; edit++)
+		{
+			state = state * 1103515245 + 12345;
+			const int32 i = (state >> 16) % num_words;
+			const int32 word_len = static_cast<int32>(strlen(words[i]));
+			if (present[i])
+			{
+				t_assert(rl_dawgeditor_remove(editor, t_word(words[i]), word_len));
+			}
+			else
+			{
+				t_assert(rl_dawgeditor_add(editor, t_word(words[i]), word_len));
+			}
+			present[i] = !present[i];
+		}
+
+		contents_len = 0;
+		_test_dawgeditor_append_words(contents, contents_len, present, words, num_words);
+		rl_dawg expected;
+		rl_dawg_init(expected);
+		const int32 num_expected_words = rl_test_dawg_build(expected, contents);
+
+		t_assert(rl_dawgeditor_commit(editor, dawg) == num_expected_words);
+		t_assert(dawg.num_nodes == expected.num_nodes);
+		t_assert(dawg.num_edges == expected.num_edges);
+		t_assert(rl_test_dawg_equivalent(dawg, 0, expected, 0));
+		t_assert(memcmp(&dawg.distribution, &expected.distribution, sizeof(rl_distribution)) == 0);
+		rl_dawg_free(expected);
+	}
+
+	rl_dawgeditor_free(editor);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
@@ -72,3 +72,35 @@ const char* test_edgemap_replace()
 	rl_edgemap_free(edgemap);
 	return nullptr;
 }
+
+const char* test_edgemap_remove()
+{
+	rl_edgemap edgemap;
+	rl_edgemap_init(edgemap);
+
+	// Items inserted out of order should still be kept sorted by letter
+	rl_edgemap_insert(edgemap, 'm', 1);
+	rl_edgemap_insert(edgemap, 'z', 2);
+	rl_edgemap_insert(edgemap, 'a', 3);
+	rl_edgemap_insert(edgemap, 'q', 4);
+	t_assert(edgemap.size == 4);
+	t_assert(edgemap.items[0].letter == 'a');
+	t_assert(edgemap.items[1].letter == 'm');
+	t_assert(edgemap.items[2].letter == 'q');
+	t_assert(edgemap.items[3].letter == 'z');
+
+	// Removing an item should close the gap, leaving the remaining items in order
+	rl_edgemap_remove(edgemap, 'm');
+	t_assert(edgemap.size == 3);
+	t_assert(rl_edgemap_find(edgemap, 'm') == -1);
+	t_assert(rl_edgemap_find(edgemap, 'a') == 3);
+	t_assert(rl_edgemap_find(edgemap, 'q') == 4);
+	t_assert(rl_edgemap_find(edgemap, 'z') == 2);
+	rl_edgemap_remove(edgemap, 'z');
+	rl_edgemap_remove(edgemap, 'a');
+	t_assert(edgemap.size == 1);
+	t_assert(edgemap.items[0].letter == 'q');
+
+	rl_edgemap_free(edgemap);
+	return nullptr;
+}
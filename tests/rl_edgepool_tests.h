@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "testing.h"
+#include "rl_edgepool.h"
+
+#include "rl_types.h"
+#include "rl_edgemap.h"
+
+const char* test_edgepool_init()
+{
+	// Initializing a pool should allocate a single slab up front, with no free blocks
+	rl_edgepool edgepool;
+	rl_edgepool_init(edgepool, 0);
+
+	t_assert(edgepool.slabs);
+	t_assert(!edgepool.slabs->prev);
+	t_assert(edgepool.bump < edgepool.bump_end);
+	for (int32 size_class = 0; size_class < RL_EDGEPOOL_NUM_CLASSES; size_class++)
+	{
+		t_assert(!edgepool.free_lists[size_class]);
+	}
+
+	rl_edgepool_free(edgepool);
+	t_assert(!edgepool.slabs);
+	return nullptr;
+}
+
+const char* test_edgepool_alloc()
+{
+	rl_edgepool edgepool;
+	rl_edgepool_init(edgepool, 0);
+
+	// Consecutive allocations should be bump-allocated back-to-back from the same slab
+	rl_edgemap_item* a = rl_edgepool_alloc(edgepool, 4);
+	rl_edgemap_item* b = rl_edgepool_alloc(edgepool, 8);
+	rl_edgemap_item* c = rl_edgepool_alloc(edgepool, 4);
+	t_assert(b == a + 4);
+	t_assert(c == b + 8);
+
+	// Released blocks should be recycled for the next allocation of the same size class
+	// only, most recently released first
+	rl_edgepool_release(edgepool, a, 4);
+	rl_edgepool_release(edgepool, c, 4);
+	t_assert(rl_edgepool_alloc(edgepool, 8) != a);
+	t_assert(rl_edgepool_alloc(edgepool, 4) == c);
+	t_assert(rl_edgepool_alloc(edgepool, 4) == a);
+
+	// Exhausting the first slab should chain on a new, larger slab
+	rl_edgepool_slab* first_slab = edgepool.slabs;
+	for (int32 i = 0; i < 100000; i++)
+	{
+		rl_edgemap_item* items = rl_edgepool_alloc(edgepool, 28);
+		items[27].node_index = i;
+	}
+	t_assert(edgepool.slabs != first_slab);
+	t_assert(edgepool.slabs->prev);
+
+	rl_edgepool_free(edgepool);
+	return nullptr;
+}
+
+const char* test_edgepool_edgemap()
+{
+	rl_edgepool edgepool;
+	rl_edgepool_init(edgepool, 0);
+
+	// An edgemap can be populated from the pool, growing through size classes just like a heap-allocated edgemap
+	rl_edgemap edgemap;
+	rl_edgemap_init(edgemap);
+	for (uint8 letter = 'a'; letter <= 'z'; letter++)
+	{
+		rl_edgemap_insert_pooled(edgemap, edgepool, letter, letter - 'a' + 1);
+	}
+	t_assert(edgemap.size == 26);
+	t_assert(edgemap.capacity == 28);
+	for (uint8 letter = 'a'; letter <= 'z'; letter++)
+	{
+		t_assert(rl_edgemap_find(edgemap, letter) == letter - 'a' + 1);
+	}
+
+	// Each size class it outgrew should have been released to the pool along the way
+	for (int32 size_class = 0; size_class < 6; size_class++)
+	{
+		t_assert(edgepool.free_lists[size_class]);
+	}
+
+	// Releasing the edgemap returns its storage and leaves it empty
+	rl_edgemap_item* items = edgemap.items;
+	rl_edgemap_release(edgemap, edgepool);
+	t_assert(edgemap.size == 0);
+	t_assert(edgemap.capacity == 0);
+	t_assert(!edgemap.items);
+	t_assert(rl_edgepool_alloc(edgepool, 28) == items);
+
+	rl_edgepool_free(edgepool);
+	return nullptr;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+
+#include <thread>
+
+#include "testing.h"
+#include "rl_testing.h"
+#include "rl_lexicon.h"
+
+#include "rl_types.h"
+#include "rl_dawg.h"
+
+const char* test_lexicon_acquire_release()
+{
+	char path[512];
+	t_assert(rl_test_write_wordlist(path, sizeof(path), "cat\ncats\nfact\nfacts\n"));
+	t_assert(rl_lexicon_num_loaded() == 0);
+
+	// Acquiring the same word list twice loads it once, and hands out the same lexicon
+	const rl_lexicon* a = rl_lexicon_acquire(path, 0);
+	t_assert(a);
+	t_assert(a->dawg.num_words == 4);
+	t_assert(rl_test_dawg_contains(a->dawg, "facts"));
+	const rl_lexicon* b = rl_lexicon_acquire(path, 0);
+	t_assert(b == a);
+	t_assert(rl_lexicon_retain(a) == a);
+	t_assert(rl_lexicon_num_loaded() == 1);
+
+	// Different flags give a different lexicon for the same path
+	const rl_lexicon* gaddag = rl_lexicon_acquire(path, RL_LEXICON_GADDAG | RL_LEXICON_PACKED);
+	t_assert(gaddag && gaddag != a);
+	t_assert(gaddag->dawg.is_gaddag && gaddag->dawg.packed);
+	t_assert(rl_test_dawg_contains(gaddag->dawg, "tac{s"));
+	t_assert(rl_lexicon_num_loaded() == 2);
+	rl_lexicon_release(gaddag);
+	t_assert(rl_lexicon_num_loaded() == 1);
+
+	// The lexicon stays loaded until its last reference is released
+	rl_lexicon_release(a);
+	rl_lexicon_release(b);
+	t_assert(rl_lexicon_num_loaded() == 1);
+	t_assert(rl_test_dawg_contains(a->dawg, "cat"));
+	rl_lexicon_release(a);
+	t_assert(rl_lexicon_num_loaded() == 0);
+
+	// A word list that can't be loaded yields no lexicon, and leaves nothing behind
+	remove(path);
+	t_assert(!rl_lexicon_acquire(path, RL_LEXICON_MAPPED));
+	t_assert(rl_lexicon_num_loaded() == 0);
+	return nullptr;
+}
+
+const char* test_lexicon_threads()
+{
+	char path[512];
+	t_assert(rl_test_write_wordlist(path, sizeof(path), "act\nacts\ncat\ncats\nscat\ntact\ntacts\n"));
+
+	// Threads racing to acquire the same lexicon should all end up sharing one copy,
+	// each able to read it while the others do the same
+	const rl_lexicon* lexicons[8];
+	bool found[8];
+	std::thread threads[8];
+	for (int32 i = 0; i < 8; i++)
+	{
+		threads[i] = std::thread([&, i]() {
+			lexicons[i] = rl_lexicon_acquire(path, 0);
+			found[i] = lexicons[i] && rl_test_dawg_contains(lexicons[i]->dawg, "tacts") && !rl_test_dawg_contains(lexicons[i]->dawg, "tac");
+		});
+	}
+	for (int32 i = 0; i < 8; i++)
+	{
+		threads[i].join();
+	}
+	t_assert(rl_lexicon_num_loaded() == 1);
+	for (int32 i = 0; i < 8; i++)
+	{
+		t_assert(lexicons[i] == lexicons[0]);
+		t_assert(found[i]);
+	}
+
+	// Releasing from many threads at once unloads it exactly once
+	for (int32 i = 0; i < 8; i++)
+	{
+		threads[i] = std::thread([&, i]() { rl_lexicon_release(lexicons[i]); });
+	}
+	for (int32 i = 0; i < 8; i++)
+	{
+		threads[i].join();
+	}
+	t_assert(rl_lexicon_num_loaded() == 0);
+
+	remove(path);
+	return nullptr;
+}
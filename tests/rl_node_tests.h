@@ -102,3 +102,29 @@ const char* test_node_signature()
 
 	return nullptr;
 }
+
+const char* test_node_equals()
+{
+	rl_node lhs; rl_node_init(lhs, false);
+	rl_node rhs; rl_node_init(rhs, false);
+
+	// Two empty, non-terminal nodes are identical
+	t_assert(rl_node_equals(lhs, rhs));
+
+	// Nodes with the same edges are identical
+	rl_edgemap_insert(lhs.next_by_letter, 'a', 12);
+	t_assert(!rl_node_equals(lhs, rhs));
+	rl_edgemap_insert(rhs.next_by_letter, 'a', 12);
+	t_assert(rl_node_equals(lhs, rhs));
+
+	// Differing destination indices or is_word flags make nodes distinct
+	rl_edgemap_replace(rhs.next_by_letter, 'a', 13);
+	t_assert(!rl_node_equals(lhs, rhs));
+	rl_edgemap_replace(rhs.next_by_letter, 'a', 12);
+	rhs.is_word = true;
+	t_assert(!rl_node_equals(lhs, rhs));
+
+	rl_node_free(lhs);
+	rl_node_free(rhs);
+	return nullptr;
+}
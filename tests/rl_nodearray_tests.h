@@ -93,3 +93,32 @@ const char* test_nodearray_pop()
 	rl_nodearray_free(nodearray);
 	return nullptr;
 }
+
+const char* test_nodearray_pooled()
+{
+	// A pooled nodearray owns an edgepool from which all edgemap storage is drawn
+	rl_nodearray nodearray;
+	rl_nodearray_init_pooled(nodearray, 2, 0);
+	t_assert(nodearray.edgepool);
+
+	const int32 index_a = rl_nodearray_push(nodearray, false);
+	const int32 index_b = rl_nodearray_push(nodearray, true);
+	rl_nodearray_insert_edge(nodearray, index_a, 'x', index_b);
+	t_assert(rl_edgemap_find(nodearray.items[index_a].next_by_letter, 'x') == index_b);
+
+	// Popping a node should return its edgemap storage to the pool, so that the next
+	// node to need an edgemap of the same size reuses it
+	rl_nodearray_insert_edge(nodearray, index_b, 'y', 100);
+	const rl_edgemap_item* popped_items = nodearray.items[index_b].next_by_letter.items;
+	rl_nodearray_pop(nodearray, index_b);
+	t_assert(nodearray.size == 1);
+
+	const int32 index_c = rl_nodearray_push(nodearray, false);
+	t_assert(!nodearray.items[index_c].is_word);
+	t_assert(!nodearray.items[index_c].next_by_letter.items);
+	rl_nodearray_insert_edge(nodearray, index_c, 'z', 200);
+	t_assert(nodearray.items[index_c].next_by_letter.items == popped_items);
+
+	rl_nodearray_free(nodearray);
+	return nullptr;
+}
@@ -7,53 +7,67 @@
 #include "rl_nodelookup.h"
 
 #include "rl_types.h"
+#include "rl_node.h"
+#include "rl_nodearray.h"
+#include "rl_edgemap.h"
 
 const char* test_nodelookup_init()
 {
-	// Initialize a nodelookup with 4 buckets
+	// Initialize a nodelookup with 4 slots
 	rl_nodelookup nodelookup;
 	rl_nodelookup_init(nodelookup, 4);
 
-	// This should allocate space for the buckets array, but the head of each linked list
-	// should be null initially
+	// This should allocate space for the slots array, with every slot initially empty
 	t_assert(nodelookup.capacity == 4);
-	t_assert(nodelookup.buckets[0] == nullptr);
-	t_assert(nodelookup.buckets[1] == nullptr);
-	t_assert(nodelookup.buckets[2] == nullptr);
-	t_assert(nodelookup.buckets[3] == nullptr);
+	t_assert(nodelookup.size == 0);
+	t_assert(nodelookup.items);
+	for (int32 slot = 0; slot < nodelookup.capacity; slot++)
+	{
+		t_assert(nodelookup.items[slot].node_index == -1);
+	}
+	rl_nodelookup_free(nodelookup);
 
+	// Capacity should always be rounded up to a power of two
+	rl_nodelookup_init(nodelookup, 5);
+	t_assert(nodelookup.capacity == 8);
 	rl_nodelookup_free(nodelookup);
+
 	return nullptr;
 }
 
 const char* test_nodelookup_insert()
 {
-	// Initialize a nodelookup with 4 buckets
+	// Initialize a nodelookup with 4 slots
 	rl_nodelookup nodelookup;
 	rl_nodelookup_init(nodelookup, 4);
 
-	// Insert three items: 400:0xaaaa and 800:0xcccc should get slotted into bucket 0;
-	// 401:0xbbbb should be at the head of bucket 1
+	// Insert two items: 400:0xaaaa should land in slot 0, and 800:0xcccc hashes to
+	// the same slot, so it should be placed in the next free slot
 	rl_nodelookup_insert(nodelookup, 400, 0xaaaa);
-	rl_nodelookup_insert(nodelookup, 401, 0xbbbb);
 	rl_nodelookup_insert(nodelookup, 800, 0xcccc);
-
-	// The linked list in our first bucket should be 400:0xaaaa -> 800:0xcccc -> [/]
-	t_assert(nodelookup.buckets[0]->signature == 400);
-	t_assert(nodelookup.buckets[0]->node_index == 0xaaaa);
-	t_assert(nodelookup.buckets[0]->next);
-	t_assert(nodelookup.buckets[0]->next->signature == 800);
-	t_assert(nodelookup.buckets[0]->next->node_index == 0xcccc);
-	t_assert(!nodelookup.buckets[0]->next->next);
-
-	// Our second bucket should have a single-item linked list, 401:0xbbbb -> [/]
-	t_assert(nodelookup.buckets[1]->signature == 401);
-	t_assert(nodelookup.buckets[1]->node_index == 0xbbbb);
-	t_assert(!nodelookup.buckets[1]->next);
-
-	// The remaining two buckets should still be empty
-	t_assert(nodelookup.buckets[2] == nullptr);
-	t_assert(nodelookup.buckets[3] == nullptr);
+	t_assert(nodelookup.size == 2);
+	t_assert(nodelookup.capacity == 4);
+	t_assert(nodelookup.items[0].signature == 400);
+	t_assert(nodelookup.items[0].node_index == 0xaaaa);
+	t_assert(nodelookup.items[1].signature == 800);
+	t_assert(nodelookup.items[1].node_index == 0xcccc);
+	t_assert(nodelookup.items[2].node_index == -1);
+	t_assert(nodelookup.items[3].node_index == -1);
+
+	// A third item would push the table past 70% load, so it should double in capacity,
+	// keeping all existing items
+	rl_nodelookup_insert(nodelookup, 401, 0xbbbb);
+	t_assert(nodelookup.size == 3);
+	t_assert(nodelookup.capacity == 8);
+	int32 num_occupied = 0;
+	for (int32 slot = 0; slot < nodelookup.capacity; slot++)
+	{
+		if (nodelookup.items[slot].node_index >= 0)
+		{
+			num_occupied++;
+		}
+	}
+	t_assert(num_occupied == 3);
 
 	rl_nodelookup_free(nodelookup);
 	return nullptr;
@@ -61,19 +75,98 @@ const char* test_nodelookup_insert()
 
 const char* test_nodelookup_find()
 {
+	// Set up a nodearray with three distinct nodes
+	rl_nodearray nodearray;
+	rl_nodearray_init(nodearray, 4);
+	const int32 index_a = rl_nodearray_push(nodearray, false);
+	const int32 index_b = rl_nodearray_push(nodearray, true);
+	const int32 index_c = rl_nodearray_push(nodearray, false);
+	rl_edgemap_insert(nodearray.items[index_a].next_by_letter, 'a', 10);
+	rl_edgemap_insert(nodearray.items[index_c].next_by_letter, 'z', 20);
+
 	rl_nodelookup nodelookup;
 	rl_nodelookup_init(nodelookup, 4);
 
-	rl_nodelookup_insert(nodelookup, 400, 0xaaaa);
-	rl_nodelookup_insert(nodelookup, 401, 0xbbbb);
-	t_assert(rl_nodelookup_find(nodelookup, 400) == 0xaaaa);
-	t_assert(rl_nodelookup_find(nodelookup, 401) == 0xbbbb);
-	t_assert(rl_nodelookup_find(nodelookup, 800) == -1);
+	// Nodes should be found by signature when they've been registered
+	const uint64 sig_a = rl_node_signature(nodearray.items[index_a]);
+	const uint64 sig_b = rl_node_signature(nodearray.items[index_b]);
+	t_assert(rl_nodelookup_find(nodelookup, nodearray, nodearray.items[index_a], sig_a) == -1);
+	rl_nodelookup_insert(nodelookup, sig_a, index_a);
+	rl_nodelookup_insert(nodelookup, sig_b, index_b);
+	t_assert(rl_nodelookup_find(nodelookup, nodearray, nodearray.items[index_a], sig_a) == index_a);
+	t_assert(rl_nodelookup_find(nodelookup, nodearray, nodearray.items[index_b], sig_b) == index_b);
+
+	// A separate node with the same structure as a registered node should resolve to
+	// the registered node
+	rl_node copy_of_a;
+	rl_node_init(copy_of_a, false);
+	rl_edgemap_insert(copy_of_a.next_by_letter, 'a', 10);
+	t_assert(rl_nodelookup_find(nodelookup, nodearray, copy_of_a, rl_node_signature(copy_of_a)) == index_a);
+	rl_node_free(copy_of_a);
+
+	// If two structurally different nodes share a signature, the collision must not
+	// be mistaken for a match, and both nodes should be independently registrable
+	t_assert(rl_nodelookup_find(nodelookup, nodearray, nodearray.items[index_c], sig_a) == -1);
+	rl_nodelookup_insert(nodelookup, sig_a, index_c);
+	t_assert(rl_nodelookup_find(nodelookup, nodearray, nodearray.items[index_c], sig_a) == index_c);
+	t_assert(rl_nodelookup_find(nodelookup, nodearray, nodearray.items[index_a], sig_a) == index_a);
 
-	rl_nodelookup_insert(nodelookup, 800, 0xcccc);
-	t_assert(rl_nodelookup_find(nodelookup, 800) == 0xcccc);
-	t_assert(rl_nodelookup_find(nodelookup, 999) == -1);
+	rl_nodelookup_free(nodelookup);
+	rl_nodearray_free(nodearray);
+	return nullptr;
+}
+
+const char* test_nodelookup_remove()
+{
+	// Register a handful of nodes that all share a single signature, so that they land
+	// in one contiguous cluster of slots
+	rl_nodearray nodearray;
+	rl_nodearray_init(nodearray, 8);
+	int32 indices[6];
+	for (int32 i = 0; i < 6; i++)
+	{
+		indices[i] = rl_nodearray_push(nodearray, false);
+		rl_edgemap_insert(nodearray.items[indices[i]].next_by_letter, 'a', 100 + i);
+	}
+
+	rl_nodelookup nodelookup;
+	rl_nodelookup_init(nodelookup, 16);
+	const uint64 signature = 12345;
+	for (int32 i = 0; i < 6; i++)
+	{
+		rl_nodelookup_insert(nodelookup, signature, indices[i]);
+	}
+	t_assert(nodelookup.size == 6);
+
+	// Removing a node from the middle of the cluster shouldn't prevent the nodes after
+	// it from being found
+	t_assert(rl_nodelookup_remove(nodelookup, signature, indices[2]));
+	t_assert(nodelookup.size == 5);
+	t_assert(rl_nodelookup_find(nodelookup, nodearray, nodearray.items[indices[2]], signature) == -1);
+	for (int32 i = 0; i < 6; i++)
+	{
+		if (i != 2)
+		{
+			t_assert(rl_nodelookup_find(nodelookup, nodearray, nodearray.items[indices[i]], signature) == indices[i]);
+		}
+	}
+
+	// A node can't be removed twice, and removing the rest leaves the table empty
+	t_assert(!rl_nodelookup_remove(nodelookup, signature, indices[2]));
+	for (int32 i = 0; i < 6; i++)
+	{
+		if (i != 2)
+		{
+			t_assert(rl_nodelookup_remove(nodelookup, signature, indices[i]));
+		}
+	}
+	t_assert(nodelookup.size == 0);
+	for (int32 slot = 0; slot < nodelookup.capacity; slot++)
+	{
+		t_assert(nodelookup.items[slot].node_index == -1);
+	}
 
 	rl_nodelookup_free(nodelookup);
+	rl_nodearray_free(nodearray);
 	return nullptr;
 }
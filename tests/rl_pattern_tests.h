@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstring>
+
+#include "testing.h"
+#include "rl_testing.h"
+#include "rl_pattern.h"
+
+#include "rl_types.h"
+#include "rl_dawg.h"
+#include "rl_rack.h"
+#include "rl_search.h"
+
+static const char* _test_pattern_words =
+	"act\nacts\nbat\nbats\ncat\ncats\ncoat\ncot\ncots\ncut\ncuttlefish\nfact\nfacts\nqat\nquart\n"
+	"quartz\nquiz\nscat\ntact\ntacts\ntat\n";
+
+// Collects every word reported by rl_pattern_match as a newline-separated string
+struct _test_pattern_results
+{
+	char text[512];
+	int32 text_len;
+	int32 max_words;
+	int32 num_words;
+};
+
+static bool _test_pattern_collect(const uint8* word, int32 word_len, void* user_data)
+{
+	_test_pattern_results& results = *reinterpret_cast<_test_pattern_results*>(user_data);
+	if (results.text_len + word_len + 1 < static_cast<int32>(sizeof(results.text)))
+	{
+		memcpy(results.text + results.text_len, word, word_len);
+		results.text_len += word_len;
+		results.text[results.text_len++] = '\n';
+		results.text[results.text_len] = '\0';
+	}
+	return ++results.num_words < results.max_words;
+}
+
+static int32 _test_pattern_match(const rl_dawg& dawg, const char* s, const char* rack_letters, _test_pattern_results& results, int32 max_words = 1000)
+{
+	results.text[0] = '\0';
+	results.text_len = 0;
+	results.max_words = max_words;
+	results.num_words = 0;
+
+	rl_pattern pattern;
+	if (!rl_pattern_compile(pattern, s))
+	{
+		return -1;
+	}
+	rl_rack rack;
+	rl_test_rack_init(rack, rack_letters ? rack_letters : "");
+	return rl_pattern_match(dawg, pattern, rack_letters ? &rack : nullptr, _test_pattern_collect, &results);
+}
+
+static bool _test_pattern_same_words(const _test_pattern_results& lhs, const _test_pattern_results& rhs)
+{
+	// True if both hold the same words, in any order
+	if (lhs.num_words != rhs.num_words || lhs.text_len != rhs.text_len)
+	{
+		return false;
+	}
+	char haystack[sizeof(rhs.text) + 1];
+	haystack[0] = '\n';
+	memcpy(haystack + 1, rhs.text, rhs.text_len + 1);
+	for (const char* word = lhs.text; *word != '\0'; word = strchr(word, '\n') + 1)
+	{
+		char needle[RL_MAX_WORD_LEN + 3];
+		const int32 word_len = static_cast<int32>(strchr(word, '\n') - word);
+		needle[0] = '\n';
+		memcpy(needle + 1, word, word_len + 1);
+		needle[word_len + 2] = '\0';
+		if (!strstr(haystack, needle))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static int32 _test_pattern_count_words(const char* s, const char* rack_letters)
+{
+	// Counts matching words by testing every word in the list in turn, as a reference for rl_pattern_match
+	rl_pattern pattern;
+	rl_pattern_compile(pattern, s);
+	int32 num_matches = 0;
+	for (const char* word = _test_pattern_words; *word != '\0'; word = strchr(word, '\n') + 1)
+	{
+		const int32 word_len = static_cast<int32>(strchr(word, '\n') - word);
+		if (!rl_pattern_test(pattern, reinterpret_cast<const uint8*>(word), word_len))
+		{
+			continue;
+		}
+		int32 counts[26];
+		memset(counts, 0, sizeof(counts));
+		for (int32 i = 0; rack_letters && rack_letters[i] != '\0'; i++)
+		{
+			counts[rack_letters[i] - 'a']++;
+		}
+		bool playable = true;
+		for (int32 ordinal = 0; ordinal < 26; ordinal++)
+		{
+			counts[ordinal] += pattern.fixed_counts[ordinal];
+		}
+		for (int32 i = 0; i < word_len && rack_letters; i++)
+		{
+			playable = playable && --counts[word[i] - 'a'] >= 0;
+		}
+		num_matches += playable ? 1 : 0;
+	}
+	return num_matches;
+}
+
+static bool _test_pattern_tests(const char* s, const char* word)
+{
+	rl_pattern pattern;
+	return rl_pattern_compile(pattern, s) && rl_pattern_test(pattern, reinterpret_cast<const uint8*>(word), static_cast<int32>(strlen(word)));
+}
+
+const char* test_pattern_compile()
+{
+	rl_pattern pattern;
+	t_assert(rl_pattern_compile(pattern, "c?t*"));
+	t_assert(pattern.num_elements == 4);
+	t_assert(pattern.gaps == (1u << 3));
+	t_assert(pattern.min_remaining[0] == 3);
+	t_assert(pattern.fixed_counts['c' - 'a'] == 1 && pattern.fixed_counts['t' - 'a'] == 1);
+
+	// Consecutive gaps collapse into one, and sets may be listed, ranged or negated
+	t_assert(rl_pattern_compile(pattern, "a**[b-dx][^a-y]"));
+	t_assert(pattern.num_elements == 4);
+	t_assert(pattern.element_letters[2] == ((1u << 1) | (1u << 2) | (1u << 3) | (1u << 23)));
+	t_assert(pattern.element_letters[3] == (1u << 25));
+
+	// Malformed patterns, and patterns longer than any word could be, are rejected
+	t_assert(!rl_pattern_compile(pattern, "c?T"));
+	t_assert(!rl_pattern_compile(pattern, "[abc"));
+	t_assert(!rl_pattern_compile(pattern, "[]"));
+	t_assert(!rl_pattern_compile(pattern, "[^a-z]"));
+	t_assert(!rl_pattern_compile(pattern, "[z-a]"));
+	t_assert(!rl_pattern_compile(pattern, "?????????????????????????????????"));
+	t_assert(pattern.num_elements == 0);
+	t_assert(rl_pattern_compile(pattern, "????????????????????????????????"));
+
+	// Gaps match any run of letters, including none at all
+	t_assert(_test_pattern_tests("c?t*", "cat"));
+	t_assert(_test_pattern_tests("c?t*", "cuttlefish"));
+	t_assert(!_test_pattern_tests("c?t*", "act"));
+	t_assert(_test_pattern_tests("*a*a*", "banana"));
+	t_assert(!_test_pattern_tests("*a*a*", "bat"));
+	t_assert(_test_pattern_tests("[bc]at", "bat"));
+	t_assert(!_test_pattern_tests("[^bc]at", "bat"));
+	t_assert(_test_pattern_tests("*", ""));
+	t_assert(!_test_pattern_tests("?", ""));
+	return nullptr;
+}
+
+const char* test_pattern_match()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_pattern_words) > 0);
+
+	// Each matching word is reported once, in alphabetical order
+	_test_pattern_results results;
+	t_assert(_test_pattern_match(dawg, "c?t*", nullptr, results) == 6);
+	t_assert(strcmp(results.text, "cat\ncats\ncot\ncots\ncut\ncuttlefish\n") == 0);
+	t_assert(_test_pattern_match(dawg, "*t*t*", nullptr, results) == 4);
+	t_assert(strcmp(results.text, "cuttlefish\ntact\ntacts\ntat\n") == 0);
+	t_assert(_test_pattern_match(dawg, "?u*", nullptr, results) == 5);
+	t_assert(strcmp(results.text, "cut\ncuttlefish\nquart\nquartz\nquiz\n") == 0);
+	t_assert(_test_pattern_match(dawg, "[^c]?t", nullptr, results) == 4);
+	t_assert(strcmp(results.text, "act\nbat\nqat\ntat\n") == 0);
+	t_assert(_test_pattern_match(dawg, "?????", nullptr, results) == 3);
+	t_assert(strcmp(results.text, "facts\nquart\ntacts\n") == 0);
+	t_assert(_test_pattern_match(dawg, "*z", nullptr, results) == 2);
+	t_assert(_test_pattern_match(dawg, "dog*", nullptr, results) == 0);
+	t_assert(_test_pattern_match(dawg, "", nullptr, results) == 0);
+
+	// With a rack, every letter not given by the pattern must come from the rack
+	t_assert(_test_pattern_match(dawg, "c?t*", "aos", results) == 4);
+	t_assert(strcmp(results.text, "cat\ncats\ncot\ncots\n") == 0);
+	t_assert(_test_pattern_match(dawg, "*", "acst", results) == 5);
+	t_assert(strcmp(results.text, "act\nacts\ncat\ncats\nscat\n") == 0);
+	t_assert(_test_pattern_match(dawg, "*t*", "act", results) == 4);
+	t_assert(strcmp(results.text, "act\ncat\ntact\ntat\n") == 0);
+	t_assert(_test_pattern_match(dawg, "q*", "uiz", results) == 1);
+	t_assert(strcmp(results.text, "quiz\n") == 0);
+
+	// The query stops as soon as the callback asks it to
+	t_assert(_test_pattern_match(dawg, "*", nullptr, results, 3) == 3);
+	t_assert(strcmp(results.text, "act\nacts\nbat\n") == 0);
+
+	// More queries agree with testing each word in the list, and give the same results
+	// through a packed DAWG, and through a GADDAG (apart from the order they're reported in)
+	rl_dawg packed;
+	rl_dawg_init(packed);
+	rl_dawg_pack(dawg, packed);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_pattern_words, rl_test_build_gaddag) > 0);
+	const char* patterns[] = { "c?t*", "*t*t*", "?u*", "[^c]?t", "?????", "*", "*a*", "[a-c]*s", "q*z", "*[aeiou][aeiou]*" };
+	const char* racks[] = { nullptr, "", "aos", "acst", "qrtuz", "abcfst" };
+	for (int32 pattern_index = 0; pattern_index < COUNT_OF(patterns); pattern_index++)
+	{
+		for (int32 rack_index = 0; rack_index < COUNT_OF(racks); rack_index++)
+		{
+			const int32 num_matches = _test_pattern_match(dawg, patterns[pattern_index], racks[rack_index], results);
+			t_assert(num_matches == _test_pattern_count_words(patterns[pattern_index], racks[rack_index]));
+			_test_pattern_results packed_results;
+			t_assert(_test_pattern_match(packed, patterns[pattern_index], racks[rack_index], packed_results) == num_matches);
+			t_assert(strcmp(packed_results.text, results.text) == 0);
+			_test_pattern_results gaddag_results;
+			t_assert(_test_pattern_match(gaddag, patterns[pattern_index], racks[rack_index], gaddag_results) == num_matches);
+			t_assert(_test_pattern_same_words(gaddag_results, results));
+		}
+	}
+
+	// A GADDAG matches a pattern that's only constrained at its end backward, from the end
+	t_assert(_test_pattern_match(gaddag, "c?t*", nullptr, results) == 6);
+	t_assert(strcmp(results.text, "cat\ncats\ncot\ncots\ncut\ncuttlefish\n") == 0);
+	t_assert(_test_pattern_match(gaddag, "*z", nullptr, results) == 2);
+	t_assert(strcmp(results.text, "quiz\nquartz\n") == 0);
+
+	// Node summaries let a query skip branches that can't match, without changing the result
+	rl_pattern pattern;
+	t_assert(rl_pattern_compile(pattern, "?q?????"));
+	rl_search_stats stats;
+	rl_search_stats_init(stats);
+	t_assert(rl_pattern_match(dawg, pattern, nullptr, _test_pattern_collect, &results, &stats) == 0);
+	t_assert(stats.num_nodes_visited == 1);
+	t_assert(stats.num_nodes_pruned > 0);
+
+	rl_dawg_free(gaddag);
+	rl_dawg_free(packed);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
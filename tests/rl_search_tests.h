@@ -0,0 +1,686 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+
+#include "testing.h"
+#include "rl_testing.h"
+#include "rl_search.h"
+
+#include "rl_types.h"
+#include "rl_util.h"
+#include "rl_dawg.h"
+#include "rl_rack.h"
+#include "rl_board.h"
+#include "rl_move.h"
+
+static const char* _test_search_words =
+	"act\nacts\nare\nart\narts\nas\nat\nate\nbat\nbats\nbet\ncar\ncare\ncared\ncars\n"
+	"cart\ncarts\ncast\ncat\ncater\ncats\ndare\ndart\near\neat\neats\nera\nrat\nrate\n"
+	"rats\nrest\nscar\nsea\nseat\nset\nstar\nstare\ntar\ntare\ntea\nteas\ntrace\n";
+
+static bool _test_search_moves_equal(const rl_move& lhs, const rl_move& rhs)
+{
+	return lhs.index == rhs.index && lhs.offset == rhs.offset && lhs.word_len == rhs.word_len && memcmp(lhs.word, rhs.word, lhs.word_len) == 0;
+}
+
+static void _test_search_write(const rl_dawg& dawg, rl_board& board, int32 x, int32 y, bool across, const char* word)
+{
+	rl_board_write(dawg, board, rl_board_index(board, x, y), across, reinterpret_cast<const uint8*>(word), static_cast<int32>(strlen(word)));
+}
+
+const char* test_search_board_gaddag()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_search_words, rl_test_build_gaddag) == 42);
+
+	// Lay out the same words on two boards, one built with each lexicon: the cross-check
+	// bits computed for every square should be identical
+	rl_board dawg_board;
+	rl_board gaddag_board;
+	rl_board_init(dawg_board, 11, 11);
+	rl_board_init(gaddag_board, 11, 11);
+	_test_search_write(dawg, dawg_board, 2, 5, true, "cater");
+	_test_search_write(gaddag, gaddag_board, 2, 5, true, "cater");
+	_test_search_write(dawg, dawg_board, 6, 5, false, "rest");
+	_test_search_write(gaddag, gaddag_board, 6, 5, false, "rest");
+	_test_search_write(dawg, dawg_board, 4, 2, false, "seat");
+	_test_search_write(gaddag, gaddag_board, 4, 2, false, "seat");
+	const int32 num_squares = dawg_board.size_x * dawg_board.size_y;
+	t_assert(memcmp(dawg_board.letters, gaddag_board.letters, num_squares) == 0);
+	t_assert(memcmp(dawg_board.checkbits_x, gaddag_board.checkbits_x, num_squares * sizeof(uint32)) == 0);
+	t_assert(memcmp(dawg_board.checkbits_y, gaddag_board.checkbits_y, num_squares * sizeof(uint32)) == 0);
+
+	// Searching the board should find the same number of legal moves with either lexicon,
+	// and should settle on the same best move, even where several moves of the same
+	// length could be played from one anchor (e.g. 'acts' and 'cats' with "aaabcs")
+	const char* racks[] = { "a", "st", "aerst", "abct", "aadett", "aaarrs", "aaabcs", "abcdert", "aacerstt" };
+	for (size_t i = 0; i < COUNT_OF(racks); i++)
+	{
+		rl_rack rack;
+		rl_test_rack_init(rack, racks[i]);
+		rl_move dawg_move;
+		rl_move gaddag_move;
+		const int32 num_dawg_moves = rl_search_board(dawg, dawg_board, rack, dawg_move);
+		const int32 num_gaddag_moves = rl_search_board(gaddag, gaddag_board, rack, gaddag_move);
+		t_assert(num_dawg_moves > 0);
+		t_assert(num_gaddag_moves == num_dawg_moves);
+		t_assert(_test_search_moves_equal(gaddag_move, dawg_move));
+	}
+
+	rl_board_free(gaddag_board);
+	rl_board_free(dawg_board);
+	rl_dawg_free(gaddag);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_search_segment_gaddag()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_search_words, rl_test_build_gaddag) == 42);
+
+	rl_board board;
+	rl_board_init(board, 11, 11);
+	_test_search_write(dawg, board, 2, 5, true, "cater");
+	rl_rack rack;
+	rl_test_rack_init(rack, "aacerstt");
+
+	// Segments leading into, hooking onto, and away from existing letters, with and
+	// without a pattern: each search picks random favorite letters, so we seed both
+	// searches identically
+	struct segment { int32 x; int32 y; int32 length; bool across; const char* pattern; };
+	const segment segments[] = {
+		{ 3, 3, 3, false, nullptr },
+		{ 3, 3, 3, false, "t??" },
+		{ 4, 6, 2, false, nullptr },
+		{ 6, 2, 4, false, nullptr },
+		{ 6, 2, 4, false, "?c??" },
+		{ 3, 6, 2, false, nullptr },
+		{ 0, 0, 4, true, nullptr },
+		{ 0, 0, 3, true, "?e?" },
+	};
+	size_t num_segments_with_moves = 0;
+	for (size_t i = 0; i < COUNT_OF(segments); i++)
+	{
+		const segment& seg = segments[i];
+		const int32 start_index = rl_board_index(board, seg.x, seg.y);
+		const uint8* pattern = reinterpret_cast<const uint8*>(seg.pattern);
+		rl_move dawg_move;
+		rl_move gaddag_move;
+		srand(static_cast<unsigned>(i));
+		const int32 num_dawg_moves = rl_search_segment(dawg, board, rack, start_index, pattern, seg.length, seg.across, dawg_move);
+		srand(static_cast<unsigned>(i));
+		const int32 num_gaddag_moves = rl_search_segment(gaddag, board, rack, start_index, pattern, seg.length, seg.across, gaddag_move);
+		t_assert(num_gaddag_moves == num_dawg_moves);
+		if (num_dawg_moves > 0)
+		{
+			t_assert(_test_search_moves_equal(gaddag_move, dawg_move));
+			num_segments_with_moves++;
+		}
+	}
+	t_assert(num_segments_with_moves == COUNT_OF(segments));
+
+	rl_board_free(board);
+	rl_dawg_free(gaddag);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+static int32 _test_search_count_words(int32 word_len, const char* rack_letters)
+{
+	// Count the words in the test list with the given length that can be spelled from the given rack, by brute force
+	int32 num_words = 0;
+	const char* word = _test_search_words;
+	while (*word)
+	{
+		const char* end = strchr(word, '\n');
+		if (end - word == word_len)
+		{
+			int32 counts[26] = { 0 };
+			for (const char* c = rack_letters; *c; c++)
+			{
+				counts[*c - 'a']++;
+			}
+			bool can_spell = true;
+			for (const char* c = word; c != end; c++)
+			{
+				can_spell = can_spell && --counts[*c - 'a'] >= 0;
+			}
+			num_words += can_spell ? 1 : 0;
+		}
+		word = end + 1;
+	}
+	return num_words;
+}
+
+const char* test_search_segment_pruning()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_board board;
+	rl_board_init(board, 11, 11);
+	_test_search_write(dawg, board, 2, 5, true, "cater");
+
+	// Searching an empty segment of a given length should find exactly the words of that
+	// length that we can spell from our rack, however many branches of the DAWG the search
+	// can skip on the strength of its node summaries
+	const char* racks[] = { "aacerstt", "aerst", "abct", "ast", "e" };
+	for (size_t i = 0; i < COUNT_OF(racks); i++)
+	{
+		for (int32 length = 2; length <= 6; length++)
+		{
+			rl_rack rack;
+			rl_test_rack_init(rack, racks[i]);
+			rl_move move;
+			rl_search_stats stats;
+			rl_search_stats_init(stats);
+			const int32 num_moves = rl_search_segment(dawg, board, rack, rl_board_index(board, 0, 0), nullptr, length, true, move, &stats);
+			t_assert(num_moves == _test_search_count_words(length, racks[i]));
+			t_assert(stats.num_nodes_visited + stats.num_nodes_pruned > 0);
+		}
+	}
+
+	// The same goes for a segment that runs into the letters already on the board: two
+	// squares leading down into the 'r' of 'cater' can only hold 'car', 'ear', or 'tar'
+	rl_rack rack;
+	rl_test_rack_init(rack, "aacerstt");
+	rl_move move;
+	t_assert(rl_search_segment(dawg, board, rack, rl_board_index(board, 6, 3), nullptr, 2, false, move) == 3);
+	rl_test_rack_init(rack, "ae");
+	t_assert(rl_search_segment(dawg, board, rack, rl_board_index(board, 6, 3), nullptr, 2, false, move) == 1);
+	t_assert(memcmp(move.word, "ear", 3) == 0);
+
+	rl_board_free(board);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_search_board_packed()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_search_words, rl_test_build_gaddag) == 42);
+	rl_dawg packed_dawg;
+	rl_dawg_init(packed_dawg);
+	rl_dawg_pack(dawg, packed_dawg);
+	rl_dawg packed_gaddag;
+	rl_dawg_init(packed_gaddag);
+	rl_dawg_pack(gaddag, packed_gaddag);
+
+	// Boards laid out with a packed lexicon should compute the same cross-check bits, and
+	// searching them should find the same moves, as with the lexicon it was packed from
+	const rl_dawg* lexicons[] = { &dawg, &packed_dawg, &gaddag, &packed_gaddag };
+	rl_board boards[COUNT_OF(lexicons)];
+	for (size_t i = 0; i < COUNT_OF(lexicons); i++)
+	{
+		rl_board_init(boards[i], 11, 11);
+		_test_search_write(*lexicons[i], boards[i], 2, 5, true, "cater");
+		_test_search_write(*lexicons[i], boards[i], 6, 5, false, "rest");
+		_test_search_write(*lexicons[i], boards[i], 4, 2, false, "seat");
+	}
+	const int32 num_squares = boards[0].size_x * boards[0].size_y;
+	for (size_t i = 1; i < COUNT_OF(lexicons); i++)
+	{
+		t_assert(memcmp(boards[i].checkbits_x, boards[0].checkbits_x, num_squares * sizeof(uint32)) == 0);
+		t_assert(memcmp(boards[i].checkbits_y, boards[0].checkbits_y, num_squares * sizeof(uint32)) == 0);
+	}
+
+	const char* racks[] = { "a", "st", "aerst", "abct", "aadett", "aaabcs", "abcdert", "aacerstt" };
+	for (size_t i = 0; i < COUNT_OF(racks); i++)
+	{
+		rl_rack rack;
+		rl_test_rack_init(rack, racks[i]);
+		rl_move expected_move;
+		const int32 num_expected_moves = rl_search_board(dawg, boards[0], rack, expected_move);
+		t_assert(num_expected_moves > 0);
+		for (size_t j = 1; j < COUNT_OF(lexicons); j++)
+		{
+			rl_move move;
+			t_assert(rl_search_board(*lexicons[j], boards[j], rack, move) == num_expected_moves);
+			t_assert(_test_search_moves_equal(move, expected_move));
+		}
+
+		// Segment searches find the same moves too, though without node summaries, nothing
+		// can be pruned
+		rl_move segment_move;
+		rl_move packed_segment_move;
+		rl_search_stats stats;
+		rl_search_stats_init(stats);
+		srand(static_cast<unsigned>(i));
+		const int32 num_segment_moves = rl_search_segment(dawg, boards[0], rack, rl_board_index(boards[0], 0, 0), nullptr, 4, true, segment_move);
+		srand(static_cast<unsigned>(i));
+		t_assert(rl_search_segment(packed_dawg, boards[1], rack, rl_board_index(boards[1], 0, 0), nullptr, 4, true, packed_segment_move, &stats) == num_segment_moves);
+		t_assert(stats.num_nodes_pruned == 0);
+		t_assert(num_segment_moves == 0 || _test_search_moves_equal(packed_segment_move, segment_move));
+	}
+
+	for (size_t i = 0; i < COUNT_OF(lexicons); i++)
+	{
+		rl_board_free(boards[i]);
+	}
+	rl_dawg_free(packed_gaddag);
+	rl_dawg_free(packed_dawg);
+	rl_dawg_free(gaddag);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+static bool _test_search_moves_contain(const rl_move* moves, int32 num_moves, const rl_move& move)
+{
+	for (int32 i = 0; i < num_moves; i++)
+	{
+		if (_test_search_moves_equal(moves[i], move))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool _test_search_visit_until(const rl_move_candidate&, void* user_data)
+{
+	// Stops the search once the given number of moves have been visited
+	int32& num_visits_left = *reinterpret_cast<int32*>(user_data);
+	return --num_visits_left > 0;
+}
+
+const char* test_search_board_visit()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_search_words, rl_test_build_gaddag) == 42);
+
+	rl_board board;
+	rl_board_init(board, 11, 11);
+	_test_search_write(dawg, board, 2, 5, true, "cater");
+	_test_search_write(dawg, board, 6, 5, false, "rest");
+	_test_search_write(dawg, board, 4, 2, false, "seat");
+	rl_rack rack;
+	rl_test_rack_init(rack, "aacerstt");
+
+	// Every legal move the search counts is copied out, including the one it would pick
+	static rl_move moves[1024];
+	rl_move best_move;
+	const int32 num_legal_moves = rl_search_board(dawg, board, rack, best_move);
+	t_assert(num_legal_moves > 0 && num_legal_moves <= COUNT_OF(moves));
+	t_assert(rl_search_board_moves(dawg, board, rack, moves, COUNT_OF(moves)) == num_legal_moves);
+	t_assert(_test_search_moves_contain(moves, num_legal_moves, best_move));
+	for (int32 i = 0; i < num_legal_moves; i++)
+	{
+		// Each move uses at least one tile from the rack, and covers the rest of its word with letters on the board
+		int32 num_on_board = 0;
+		for (int32 letter_index = 0; letter_index < moves[i].word_len; letter_index++)
+		{
+			num_on_board += board.letters[moves[i].index + letter_index * moves[i].offset] == moves[i].word[letter_index] ? 1 : 0;
+		}
+		t_assert(moves[i].letters_used.sum > 0);
+		t_assert(moves[i].letters_used.sum + num_on_board == moves[i].word_len);
+		t_assert(moves[i].word_len <= best_move.word_len);
+	}
+
+	// A GADDAG finds the same moves, in a different order
+	static rl_move gaddag_moves[1024];
+	t_assert(rl_search_board_moves(gaddag, board, rack, gaddag_moves, COUNT_OF(gaddag_moves)) == num_legal_moves);
+	for (int32 i = 0; i < num_legal_moves; i++)
+	{
+		t_assert(_test_search_moves_contain(moves, num_legal_moves, gaddag_moves[i]));
+	}
+
+	// A buffer that's too small holds the first moves found, and the count says how big it needed to be
+	rl_move few_moves[3];
+	t_assert(rl_search_board_moves(dawg, board, rack, few_moves, COUNT_OF(few_moves)) == num_legal_moves);
+	for (int32 i = 0; i < COUNT_OF(few_moves); i++)
+	{
+		t_assert(_test_search_moves_equal(few_moves[i], moves[i]));
+	}
+	t_assert(rl_search_board_moves(dawg, board, rack, nullptr, 0) == num_legal_moves);
+
+	// The search stops as soon as the callback asks it to
+	for (int32 i = 0; i < 2; i++)
+	{
+		int32 num_visits_left = 5;
+		t_assert(rl_search_board_visit(i == 0 ? dawg : gaddag, board, rack, _test_search_visit_until, &num_visits_left) == 5);
+	}
+
+	// Segment searches can be enumerated in the same way
+	const int32 start_index = rl_board_index(board, 0, 0);
+	rl_move segment_move;
+	const int32 num_segment_moves = rl_search_segment(dawg, board, rack, start_index, nullptr, 4, true, segment_move);
+	t_assert(num_segment_moves > 0);
+	t_assert(rl_search_segment_moves(dawg, board, rack, start_index, nullptr, 4, true, moves, COUNT_OF(moves)) == num_segment_moves);
+	t_assert(_test_search_moves_contain(moves, num_segment_moves, segment_move));
+	t_assert(rl_search_segment_moves(gaddag, board, rack, start_index, nullptr, 4, true, gaddag_moves, COUNT_OF(gaddag_moves)) == num_segment_moves);
+	t_assert(_test_search_moves_contain(gaddag_moves, num_segment_moves, segment_move));
+
+	rl_board_free(board);
+	rl_dawg_free(gaddag);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+static int32 _test_search_rank_vowels(const rl_move_candidate& candidate, void* user_data)
+{
+	// Ranks moves by how many of the given letters their words use
+	const char* letters = reinterpret_cast<const char*>(user_data);
+	int32 score = 0;
+	for (int32 i = 0; i < candidate.word_len; i++)
+	{
+		score += strchr(letters, candidate.word[i]) ? 1 : 0;
+	}
+	return score;
+}
+
+const char* test_search_board_topk()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_search_words, rl_test_build_gaddag) == 42);
+
+	rl_board board;
+	rl_board_init(board, 11, 11);
+	_test_search_write(dawg, board, 2, 5, true, "cater");
+	_test_search_write(dawg, board, 6, 5, false, "rest");
+	_test_search_write(dawg, board, 4, 2, false, "seat");
+	rl_rack rack;
+	rl_test_rack_init(rack, "aacerstt");
+
+	static rl_move moves[1024];
+	const int32 num_legal_moves = rl_search_board_moves(dawg, board, rack, moves, COUNT_OF(moves));
+	t_assert(num_legal_moves > 25 && num_legal_moves <= COUNT_OF(moves));
+
+	// The top k moves should be the first k of every legal move, stably sorted by rank
+	static rl_move topk_moves[1024];
+	static rl_move gaddag_topk_moves[1024];
+	static int32 expected_order[1024];
+	const rl_rank_fn rank_fns[] = { nullptr, rl_rank_word_len, _test_search_rank_vowels };
+	const int32 ks[] = { 1, 2, 5, 20, num_legal_moves - 1, num_legal_moves, num_legal_moves + 5 };
+	char vowels[] = "aeiou";
+	for (size_t i = 0; i < COUNT_OF(rank_fns); i++)
+	{
+		const rl_rank_fn rank_fn = rank_fns[i] ? rank_fns[i] : rl_rank_word_len;
+		int32 scores[COUNT_OF(moves)];
+		for (int32 move_index = 0; move_index < num_legal_moves; move_index++)
+		{
+			const rl_move_candidate candidate = { moves[move_index].index, moves[move_index].offset, moves[move_index].word, moves[move_index].word_len };
+			scores[move_index] = rank_fn(candidate, vowels);
+			int32 insert_index = move_index;
+			while (insert_index > 0 && scores[expected_order[insert_index - 1]] < scores[move_index])
+			{
+				expected_order[insert_index] = expected_order[insert_index - 1];
+				insert_index--;
+			}
+			expected_order[insert_index] = move_index;
+		}
+
+		for (size_t j = 0; j < COUNT_OF(ks); j++)
+		{
+			const int32 num_topk_moves = rl_search_board_topk(dawg, board, rack, ks[j], rank_fns[i], topk_moves, vowels);
+			t_assert(num_topk_moves == MIN(ks[j], num_legal_moves));
+			for (int32 move_index = 0; move_index < num_topk_moves; move_index++)
+			{
+				const rl_move& expected_move = moves[expected_order[move_index]];
+				t_assert(_test_search_moves_equal(topk_moves[move_index], expected_move));
+				t_assert(memcmp(&topk_moves[move_index].letters_used, &expected_move.letters_used, sizeof(rl_rack)) == 0);
+			}
+
+			// A GADDAG finds moves in a different order, so ties may be broken differently, but the ranks should agree
+			t_assert(rl_search_board_topk(gaddag, board, rack, ks[j], rank_fns[i], gaddag_topk_moves, vowels) == num_topk_moves);
+			for (int32 move_index = 0; move_index < num_topk_moves; move_index++)
+			{
+				const rl_move& move = gaddag_topk_moves[move_index];
+				const rl_move_candidate candidate = { move.index, move.offset, move.word, move.word_len };
+				t_assert(rank_fn(candidate, vowels) == scores[expected_order[move_index]]);
+			}
+		}
+	}
+
+	// Ranked by length, the best move is the one rl_search_board settles on
+	rl_move best_move;
+	rl_search_board(dawg, board, rack, best_move);
+	t_assert(rl_search_board_topk(dawg, board, rack, 1, nullptr, topk_moves) == 1);
+	t_assert(_test_search_moves_equal(topk_moves[0], best_move));
+	t_assert(rl_search_board_topk(dawg, board, rack, 0, nullptr, topk_moves) == 0);
+
+	rl_board_free(board);
+	rl_dawg_free(gaddag);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_search_board_best_score()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_search_words, rl_test_build_gaddag) == 42);
+
+	rl_board board;
+	rl_board_init(board, 11, 11);
+	rl_board_set_standard_premiums(board);
+	_test_search_write(dawg, board, 2, 5, true, "cater");
+	_test_search_write(dawg, board, 6, 5, false, "rest");
+	_test_search_write(dawg, board, 4, 2, false, "seat");
+
+	// The best-score search should find the same move as scoring every legal move, while skipping much of the search
+	static rl_move moves[1024];
+	const char* racks[] = { "a", "st", "aerst", "abct", "aadett", "aaarrs", "aaabcs", "abcdert", "aacerstt" };
+	uint64 num_nodes_bounded = 0;
+	for (size_t i = 0; i < COUNT_OF(racks); i++)
+	{
+		rl_rack rack;
+		rl_test_rack_init(rack, racks[i]);
+		rl_search_stats exhaustive_stats;
+		rl_search_stats_init(exhaustive_stats);
+		const int32 num_legal_moves = rl_search_board_moves(dawg, board, rack, moves, COUNT_OF(moves), &exhaustive_stats);
+		t_assert(num_legal_moves > 0 && num_legal_moves <= COUNT_OF(moves));
+		int32 expected_score = -1;
+		int32 expected_index = -1;
+		for (int32 move_index = 0; move_index < num_legal_moves; move_index++)
+		{
+			const int32 score = rl_board_score_move(board, moves[move_index].index, moves[move_index].offset, moves[move_index].word, moves[move_index].word_len);
+			if (score > expected_score)
+			{
+				expected_score = score;
+				expected_index = move_index;
+			}
+		}
+
+		rl_move move;
+		rl_search_stats stats;
+		rl_search_stats_init(stats);
+		t_assert(rl_search_board_best_score(dawg, board, rack, move, &stats) == expected_score);
+		t_assert(_test_search_moves_equal(move, moves[expected_index]));
+		t_assert(memcmp(&move.letters_used, &moves[expected_index].letters_used, sizeof(rl_rack)) == 0);
+		t_assert(stats.num_nodes_visited <= exhaustive_stats.num_nodes_visited);
+		t_assert(exhaustive_stats.num_nodes_bounded == 0);
+		num_nodes_bounded += stats.num_nodes_bounded;
+
+		// A GADDAG finds a move with the same score, though not necessarily the same one
+		rl_move gaddag_move;
+		t_assert(rl_search_board_best_score(gaddag, board, rack, gaddag_move) == expected_score);
+		t_assert(rl_board_score_move(board, gaddag_move.index, gaddag_move.offset, gaddag_move.word, gaddag_move.word_len) == expected_score);
+	}
+	t_assert(num_nodes_bounded > 0);
+
+	// With no legal moves, there's no score
+	rl_rack rack;
+	rl_test_rack_init(rack, "");
+	rl_move move;
+	t_assert(rl_search_board_best_score(dawg, board, rack, move) == -1);
+
+	rl_board_free(board);
+	rl_dawg_free(gaddag);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_search_board_parallel()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_search_words, rl_test_build_gaddag) == 42);
+
+	const rl_dawg* lexicons[] = { &dawg, &gaddag };
+	rl_board boards[COUNT_OF(lexicons)];
+	for (size_t i = 0; i < COUNT_OF(lexicons); i++)
+	{
+		rl_board_init(boards[i], 11, 11);
+		_test_search_write(*lexicons[i], boards[i], 2, 5, true, "cater");
+		_test_search_write(*lexicons[i], boards[i], 6, 5, false, "rest");
+		_test_search_write(*lexicons[i], boards[i], 4, 2, false, "seat");
+	}
+
+	// However many threads search the board, and however its anchors are divided between
+	// them, the result should be exactly that of a serial search
+	const char* racks[] = { "", "a", "st", "aerst", "abct", "aadett", "aaarrs", "aaabcs", "abcdert", "aacerstt" };
+	const int32 thread_counts[] = { 0, 1, 2, 3, 8, 1000 };
+	for (size_t i = 0; i < COUNT_OF(lexicons); i++)
+	{
+		for (size_t j = 0; j < COUNT_OF(racks); j++)
+		{
+			rl_rack rack;
+			rl_test_rack_init(rack, racks[j]);
+			rl_move expected_move;
+			rl_search_stats expected_stats;
+			rl_search_stats_init(expected_stats);
+			const int32 num_expected_moves = rl_search_board(*lexicons[i], boards[i], rack, expected_move, &expected_stats);
+			for (size_t k = 0; k < COUNT_OF(thread_counts); k++)
+			{
+				rl_move move;
+				rl_search_stats stats;
+				rl_search_stats_init(stats);
+				t_assert(rl_search_board_parallel(*lexicons[i], boards[i], rack, move, thread_counts[k], &stats) == num_expected_moves);
+				t_assert(num_expected_moves == 0 ? move.word_len == 0 : _test_search_moves_equal(move, expected_move));
+				t_assert(stats.num_nodes_visited == expected_stats.num_nodes_visited);
+				t_assert(stats.num_nodes_pruned == expected_stats.num_nodes_pruned);
+			}
+		}
+	}
+
+	// An empty board has no anchors, and so no moves
+	rl_board empty_board;
+	rl_board_init(empty_board, 5, 5);
+	rl_rack rack;
+	rl_test_rack_init(rack, "aerst");
+	rl_move move;
+	t_assert(rl_search_board_parallel(dawg, empty_board, rack, move, 4) == 0);
+	t_assert(move.word_len == 0);
+
+	rl_board_free(empty_board);
+	for (size_t i = 0; i < COUNT_OF(lexicons); i++)
+	{
+		rl_board_free(boards[i]);
+	}
+	rl_dawg_free(gaddag);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
+
+const char* test_search_board_cached()
+{
+	rl_dawg dawg;
+	rl_dawg_init(dawg);
+	t_assert(rl_test_dawg_build(dawg, _test_search_words) == 42);
+	rl_dawg gaddag;
+	rl_dawg_init(gaddag);
+	t_assert(rl_test_dawg_build_with(gaddag, _test_search_words, rl_test_build_gaddag) == 42);
+
+	const rl_dawg* lexicons[] = { &dawg, &gaddag };
+	for (size_t i = 0; i < COUNT_OF(lexicons); i++)
+	{
+		rl_board board;
+		rl_board_init(board, 11, 11);
+		_test_search_write(*lexicons[i], board, 2, 5, true, "cater");
+		_test_search_write(*lexicons[i], board, 2, 2, true, "cat");
+
+		rl_search_cache cache;
+		rl_search_cache_init(cache);
+		rl_rack rack;
+		rl_test_rack_init(rack, "aerst");
+		rl_move expected_move;
+		rl_move move;
+
+		// The first search has nothing cached, so it searches every row and column
+		int32 num_expected_moves = rl_search_board(*lexicons[i], board, rack, expected_move);
+		t_assert(rl_search_board_cached(*lexicons[i], board, rack, move, cache) == num_expected_moves);
+		t_assert(_test_search_moves_equal(move, expected_move));
+		t_assert(cache.num_lines_searched == 22);
+
+		// With nothing changed, every line comes from the cache
+		t_assert(rl_search_board_cached(*lexicons[i], board, rack, move, cache) == num_expected_moves);
+		t_assert(_test_search_moves_equal(move, expected_move));
+		t_assert(cache.num_lines_searched == 0);
+
+		// Playing "rest" down from the 'r' changes column 6, the two columns beside it, and the rows of the anchors
+		// above, beside and below the new letters
+		_test_search_write(*lexicons[i], board, 6, 5, false, "rest");
+		num_expected_moves = rl_search_board(*lexicons[i], board, rack, expected_move);
+		t_assert(rl_search_board_cached(*lexicons[i], board, rack, move, cache) == num_expected_moves);
+		t_assert(_test_search_moves_equal(move, expected_move));
+		t_assert(cache.num_lines_searched == 8);
+
+		// Blocking two squares from each other changes just their row and their columns
+		rl_board_block_next(board, rl_board_index(board, 7, 6), true);
+		num_expected_moves = rl_search_board(*lexicons[i], board, rack, expected_move);
+		t_assert(rl_search_board_cached(*lexicons[i], board, rack, move, cache) == num_expected_moves);
+		t_assert(_test_search_moves_equal(move, expected_move));
+		t_assert(cache.num_lines_searched == 3);
+
+		// Every search agrees with an uncached one as more moves are played, and a different rack starts over
+		const char* racks[] = { "aerst", "aerst", "abct", "abct", "", "aacerstt" };
+		for (size_t j = 0; j < COUNT_OF(racks); j++)
+		{
+			rl_test_rack_init(rack, racks[j]);
+			num_expected_moves = rl_search_board(*lexicons[i], board, rack, expected_move);
+			t_assert(rl_search_board_cached(*lexicons[i], board, rack, move, cache) == num_expected_moves);
+			t_assert(num_expected_moves == 0 ? move.word_len == 0 : _test_search_moves_equal(move, expected_move));
+			t_assert(cache.num_lines_searched < 22 || j == 0 || strcmp(racks[j], racks[j - 1]) != 0);
+			if (num_expected_moves > 0)
+			{
+				rl_board_write(*lexicons[i], board, move.index, move.offset == 1, move.word, move.word_len);
+			}
+		}
+
+		// A board freed and initialized again in the same place starts its versions over, but is still a different
+		// board: nothing cached for the old one may be reused
+		rl_board_free(board);
+		rl_board_init(board, 11, 11);
+		_test_search_write(*lexicons[i], board, 4, 3, false, "rest");
+		num_expected_moves = rl_search_board(*lexicons[i], board, rack, expected_move);
+		t_assert(rl_search_board_cached(*lexicons[i], board, rack, move, cache) == num_expected_moves);
+		t_assert(_test_search_moves_equal(move, expected_move));
+		t_assert(cache.num_lines_searched == 22);
+
+		rl_search_cache_free(cache);
+		t_assert(!cache.lines);
+		rl_board_free(board);
+	}
+
+	rl_dawg_free(gaddag);
+	rl_dawg_free(dawg);
+	return nullptr;
+}
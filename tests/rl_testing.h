@@ -59,6 +59,121 @@ int32 rl_test_dawg_build(rl_dawg& dawg, const char* wordlist_file_contents)
 	return rl_dawg_build(dawg, wordlist_path);
 }
 
+bool rl_test_temp_path(char* out_path, size_t out_path_size)
+{
+#ifdef _WIN32
+	// Get a throwaway path for a new file within the temp directory
+	TCHAR tempdir_path[MAX_PATH];
+	if (!GetTempPath(MAX_PATH, tempdir_path) || out_path_size < MAX_PATH)
+	{
+		return false;
+	}
+	return GetTempFileName(tempdir_path, TEXT("rltest"), 0, out_path) != 0;
+#else
+	// Create an empty temp file (mkstemp will mutate the path) so the path is ours to overwrite
+	const char path_template[] = "/tmp/rl_test_file.XXXXXX";
+	if (out_path_size < sizeof(path_template))
+	{
+		return false;
+	}
+	memcpy(out_path, path_template, sizeof(path_template));
+	int fd = mkstemp(out_path);
+	if (fd == -1)
+	{
+		return false;
+	}
+	close(fd);
+	return true;
+#endif
+}
+
+bool rl_test_write_wordlist(char* out_path, size_t out_path_size, const char* wordlist_file_contents)
+{
+	// Write the word list to a new temp file, whose path is returned so the caller can remove it
+	if (!rl_test_temp_path(out_path, out_path_size))
+	{
+		return false;
+	}
+	FILE* fp = fopen(out_path, "w");
+	if (!fp)
+	{
+		return false;
+	}
+	fputs(wordlist_file_contents, fp);
+	fclose(fp);
+	return true;
+}
+
+// Builds a frozen DAWG from the word list at the given path, with a setting whose meaning depends on the builder
+typedef int32 (*rl_test_build_fn)(rl_dawg& dawg, const char* wordlist_path, size_t setting);
+
+int32 rl_test_build_parallel(rl_dawg& dawg, const char* wordlist_path, size_t num_threads)
+{
+	return rl_dawg_build_parallel(dawg, wordlist_path, static_cast<int32>(num_threads));
+}
+
+int32 rl_test_build_gaddag(rl_dawg& dawg, const char* wordlist_path, size_t)
+{
+	return rl_dawg_build_gaddag(dawg, wordlist_path);
+}
+
+int32 rl_test_dawg_build_with(rl_dawg& dawg, const char* wordlist_file_contents, rl_test_build_fn build_fn, size_t setting = 0)
+{
+	// Write the word list to a temp file, build from it with the given builder (e.g. rl_dawg_build_unsorted, with its
+	// memory budget as the setting), then clean up
+	char wordlist_path[512];
+	if (!rl_test_write_wordlist(wordlist_path, sizeof(wordlist_path), wordlist_file_contents))
+	{
+		return -1;
+	}
+	const int32 num_words = build_fn(dawg, wordlist_path, setting);
+	remove(wordlist_path);
+	return num_words;
+}
+
+bool rl_test_dawg_contains(const rl_dawg& dawg, const char* word)
+{
+	// Follow the edges spelling out the word from the root: in a GADDAG, '{' is the separator
+	rl_edge edge = RL_EDGE_NONE;
+	int32 node_index = 0;
+	for (size_t i = 0, n = strlen(word); i < n; i++)
+	{
+		edge = rl_dawg_find_edge(dawg, node_index, static_cast<uint8>(word[i]));
+		if (edge == RL_EDGE_NONE)
+		{
+			return false;
+		}
+		node_index = rl_edge_node_index(edge);
+	}
+	return edge != RL_EDGE_NONE && rl_edge_is_word(edge);
+}
+
+bool rl_test_dawg_equivalent(const rl_dawg& lhs, int32 lhs_node_index, const rl_dawg& rhs, int32 rhs_node_index)
+{
+	// Two nodes are equivalent if they have the same set of outgoing edges, by letter and terminal flag, and each
+	// pair of destination nodes is (recursively) equivalent, regardless of how those nodes are numbered or stored
+	const uint32 mask = rl_dawg_node_mask(lhs, lhs_node_index);
+	if (rl_dawg_node_mask(rhs, rhs_node_index) != mask)
+	{
+		return false;
+	}
+	for (uint32 letters = mask; letters != 0; letters &= letters - 1)
+	{
+		const uint32 ordinal = static_cast<uint32>(rl_ctz(letters));
+		const rl_edge lhs_edge = rl_dawg_node_edge(lhs, lhs_node_index, mask, ordinal);
+		const rl_edge rhs_edge = rl_dawg_node_edge(rhs, rhs_node_index, mask, ordinal);
+		if (rl_edge_letter(lhs_edge) != rl_edge_letter(rhs_edge) || rl_edge_is_word(lhs_edge) != rl_edge_is_word(rhs_edge))
+		{
+			return false;
+		}
+		if (!rl_test_dawg_equivalent(lhs, rl_edge_node_index(lhs_edge), rhs, rl_edge_node_index(rhs_edge)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 void rl_test_rack_init(rl_rack& rack, const char* letters)
 {
 	rl_rack_init(rack);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+
+#include "testing.h"
+#include "rl_wordlist.h"
+
+#include "rl_types.h"
+#include "rl_util.h"
+
+const char* test_wordlist_append()
+{
+	rl_wordlist wordlist;
+	rl_wordlist_init(wordlist, 0);
+	t_assert(wordlist.num_entries == 0);
+	t_assert(wordlist.buf_size == 0);
+
+	// Words are packed end-to-end in the buffer, growing it as needed
+	for (int32 i = 0; i < 2000; i++)
+	{
+		rl_wordlist_append(wordlist, reinterpret_cast<const uint8*>("abcdefgh"), 1 + i % 8);
+	}
+	t_assert(wordlist.num_entries == 2000);
+	t_assert(wordlist.buf_size == 250 * (1 + 2 + 3 + 4 + 5 + 6 + 7 + 8));
+	t_assert(wordlist.entries[9].offset == 1 + 2 + 3 + 4 + 5 + 6 + 7 + 8 + 1);
+	t_assert(wordlist.entries[9].len == 2);
+	t_assert(memcmp(rl_wordlist_word(wordlist, 9), "ab", 2) == 0);
+
+	// Clearing the list keeps its storage
+	rl_wordlist_clear(wordlist);
+	t_assert(wordlist.num_entries == 0);
+	t_assert(wordlist.buf_size == 0);
+	t_assert(wordlist.buf);
+
+	rl_wordlist_free(wordlist);
+	return nullptr;
+}
+
+const char* test_wordlist_sort()
+{
+	// Fill a wordlist with pseudo-random words drawn from a small alphabet, so that
+	// there are plenty of shared prefixes, prefixes of other words, and duplicates
+	rl_wordlist wordlist;
+	rl_wordlist_init(wordlist, 0);
+	uint32 state = 12345;
+	uint8 word[8];
+	const int32 num_words = 20000;
+	for (int32 i = 0; i < num_words; i++)
+	{
+		state = state * 1103515245 + 12345;
+		const int32 len = 1 + (state >> 16) % COUNT_OF(word);
+		for (int32 j = 0; j < len; j++)
+		{
+			state = state * 1103515245 + 12345;
+			word[j] = static_cast<uint8>('a' + (state >> 16) % 3);
+		}
+		rl_wordlist_append(wordlist, word, len);
+	}
+	rl_wordlist_sort(wordlist);
+
+	// Every word should now be strictly greater than the one before it, which also
+	// means that no duplicates remain
+	t_assert(wordlist.num_entries > 1000 && wordlist.num_entries < num_words);
+	for (int32 i = 1; i < wordlist.num_entries; i++)
+	{
+		const rl_wordlist_entry& prev = wordlist.entries[i - 1];
+		const rl_wordlist_entry& entry = wordlist.entries[i];
+		const int32 min_len = prev.len < entry.len ? prev.len : entry.len;
+		const int cmp = memcmp(rl_wordlist_word(wordlist, i - 1), rl_wordlist_word(wordlist, i), min_len);
+		t_assert(cmp < 0 || (cmp == 0 && prev.len < entry.len));
+	}
+
+	// With this alphabet, every possible one-letter and two-letter word should be present
+	t_assert(wordlist.entries[0].len == 1 && rl_wordlist_word(wordlist, 0)[0] == 'a');
+	t_assert(wordlist.entries[1].len == 2 && memcmp(rl_wordlist_word(wordlist, 1), "aa", 2) == 0);
+
+	rl_wordlist_free(wordlist);
+	return nullptr;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "testing.h"
+#include "rl_wordreader.h"
+
+#include "rl_types.h"
+#include "rl_util.h"
+#include "rl_testing.h"
+
+const char* test_wordreader_next()
+{
+	// Write a short word list with a mix of whitespace, and with words long enough to
+	// span several 64-byte chunks
+	char path[512];
+	t_assert(rl_test_temp_path(path, sizeof(path)));
+	FILE* fp = fopen(path, "wb");
+	t_assert(fp);
+	fputs("  cat\r\ndogs\t\tBird\v\fx-ray \n", fp);
+	fputs("abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz\n", fp);
+	fputs("abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz\xe9", fp);
+	fclose(fp);
+
+	rl_wordreader reader;
+	t_assert(rl_wordreader_open(reader, path));
+
+	// Each word should be returned in order, flagged as invalid if it contains anything
+	// other than 'a' through 'z'
+	const char* expected_words[] = { "cat", "dogs", "Bird", "x-ray" };
+	const bool expected_valid[] = { true, true, false, false };
+	const uint8* word;
+	int32 word_len;
+	bool word_is_valid;
+	for (int32 i = 0; i < COUNT_OF(expected_words); i++)
+	{
+		t_assert(rl_wordreader_next(reader, word, word_len, word_is_valid));
+		t_assert(word_len == static_cast<int32>(strlen(expected_words[i])));
+		t_assert(memcmp(word, expected_words[i], word_len) == 0);
+		t_assert(word_is_valid == expected_valid[i]);
+	}
+
+	// A long word is returned whole, and a non-ASCII byte at the very end of the input
+	// still invalidates the word that contains it
+	t_assert(rl_wordreader_next(reader, word, word_len, word_is_valid));
+	t_assert(word_len == 78);
+	t_assert(word_is_valid);
+	t_assert(rl_wordreader_next(reader, word, word_len, word_is_valid));
+	t_assert(word_len == 79);
+	t_assert(!word_is_valid);
+
+	// Once the input is exhausted, the reader should stay exhausted
+	t_assert(!rl_wordreader_next(reader, word, word_len, word_is_valid));
+	t_assert(!rl_wordreader_next(reader, word, word_len, word_is_valid));
+
+	rl_wordreader_free(reader);
+	remove(path);
+	return nullptr;
+}
+
+const char* test_wordreader_blocks()
+{
+	// Write a word list that's several times larger than the reader's block size, with
+	// word lengths chosen so that words regularly straddle the boundaries between blocks
+	char path[512];
+	t_assert(rl_test_temp_path(path, sizeof(path)));
+	FILE* fp = fopen(path, "wb");
+	t_assert(fp);
+	const int32 num_words = (RL_WORDREADER_BLOCK_SIZE / 8) * 3;
+	char temp[16];
+	for (int32 i = 0; i < num_words; i++)
+	{
+		const int32 len = 1 + i % 13;
+		for (int32 j = 0; j < len; j++)
+		{
+			temp[j] = static_cast<char>('a' + (i + j) % 26);
+		}
+		temp[len] = i % 7 == 0 ? ' ' : '\n';
+		fwrite(temp, 1, len + 1, fp);
+	}
+	fclose(fp);
+
+	// Every word should come back intact, in order
+	rl_wordreader reader;
+	t_assert(rl_wordreader_open(reader, path));
+	const uint8* word;
+	int32 word_len;
+	bool word_is_valid;
+	int32 num_words_read = 0;
+	while (rl_wordreader_next(reader, word, word_len, word_is_valid))
+	{
+		t_assert(word_is_valid);
+		t_assert(word_len == 1 + num_words_read % 13);
+		t_assert(word[0] == 'a' + num_words_read % 26);
+		t_assert(word[word_len - 1] == 'a' + (num_words_read + word_len - 1) % 26);
+		num_words_read++;
+	}
+	t_assert(num_words_read == num_words);
+
+	rl_wordreader_free(reader);
+	remove(path);
+	return nullptr;
+}
+
+const char* test_wordreader_read_error()
+{
+#ifndef _WIN32
+	// A directory can be opened for reading, but any read from it fails: the reader should
+	// flag the error rather than treating it as the end of an empty word list
+	rl_wordreader reader;
+	t_assert(rl_wordreader_open(reader, "."));
+	const uint8* word;
+	int32 word_len;
+	bool word_is_valid;
+	t_assert(!rl_wordreader_next(reader, word, word_len, word_is_valid));
+	t_assert(reader.eof);
+	t_assert(reader.error);
+	rl_wordreader_free(reader);
+#endif
+	return nullptr;
+}